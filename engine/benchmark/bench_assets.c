@@ -0,0 +1,160 @@
+#include <engine_config.h>
+#include <engine_assets.h>
+#include <engine_logger.h>
+#include <platform_time.h>
+#include <util_crc32.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Asset registry benchmark, measures lookups and acquire/release pairs on a synthetic
+// archive. Only the public asset API is used so the same file builds against older
+// registry layouts for comparison. Not part of the engine build, on Linux run (one line):
+//
+//   gcc benchmark/bench_assets.c $(find source -name "*.c" ! -name main.c)
+//       -std=c23 -O2 -D_DEFAULT_SOURCE -Iinclude -I$LUA_SDK/src
+//       -L$LUA_SDK/src -llua -lm -ldl -lpthread -o bench_assets.elf
+//   ./bench_assets.elf [Entries] [Threads]
+//
+// The archive is written to a temporary directory, which becomes the working directory.
+
+#define BENCH_ENTRIES   40000       // Default Archive Entries
+#define BENCH_THREADS   4           // Default Acquire/Release Threads
+#define BENCH_LOOKUPS   4           // Passes over every Name
+#define BENCH_PAIRS     4000000     // Acquire/Release Pairs per Thread
+#define BENCH_NAME      64          // Name Buffer Size
+#define BENCH_ARCHIVE   "assets.yuri" // Default Archive of every Registry Version
+
+typedef struct {
+    asset_t* asset;                 // Asset hammered by the Thread
+    double seconds;                 // Time Spent
+} bench_thread_t;
+
+static void bench_name(char* name, unsigned int index) {
+    snprintf(name, BENCH_NAME, "/bench/group_%03u/asset_%06u", index % 97, index);
+}
+
+static void bench_u32(FILE* f, unsigned int v) {
+    unsigned char b[4] = { v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF };
+    fwrite(b, 1, 4, f);
+}
+
+// Every entry is an embedded 4 byte payload holding its index
+static bool_t bench_archive(const char* path, unsigned int entries) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        return FALSE;
+    }
+    bench_u32(f, MAGIC_YURI);
+    bench_u32(f, entries);
+    char name[BENCH_NAME];
+    for (unsigned int i = 0; i < entries; i++) {
+        unsigned char payload[4] = { i & 0xFF, (i >> 8) & 0xFF, (i >> 16) & 0xFF, (i >> 24) & 0xFF };
+        bench_name(name, i);
+        unsigned short length = (unsigned short)strlen(name);
+        fputc(ASSET_TYPE_EMBEDDED, f);
+        fputc(0, f);
+        bench_u32(f, sizeof(payload));
+        bench_u32(f, crc32(payload, sizeof(payload)));
+        fputc(length & 0xFF, f);
+        fputc(length >> 8, f);
+        fwrite(name, 1, length, f);
+    }
+    for (unsigned int i = 0; i < entries; i++) {
+        bench_u32(f, i);
+    }
+    return fclose(f) == 0;
+}
+
+static void* bench_thread(void* data) {
+    bench_thread_t* t = data;
+    double start = time_monotonic();
+    for (unsigned int i = 0; i < BENCH_PAIRS; i++) {
+        assets_acquire(t->asset);
+        assets_release(t->asset);
+    }
+    t->seconds = time_monotonic() - start;
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    unsigned int entries = argc > 1 ? (unsigned int)atoi(argv[1]) : BENCH_ENTRIES;
+    unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : BENCH_THREADS;
+    if (entries < threads || threads == 0) {
+        fprintf(stderr, "Usage: %s [Entries] [Threads]\n", argv[0]);
+        return 1;
+    }
+    char directory[] = "/tmp/bench_assets_XXXXXX";
+    if (mkdtemp(directory) == NULL || chdir(directory) != 0 || !bench_archive(BENCH_ARCHIVE, entries)) {
+        fprintf(stderr, "Cannot write Archive\n");
+        return 1;
+    }
+    engine_config_t config = engine_config_init();
+    if (!engine_logger_init(&config) || !engine_assets_init(&config)) {
+        return 1;
+    }
+    char name[BENCH_NAME];
+
+    // Lookup
+    asset_t** assets = malloc(entries * sizeof(asset_t*));
+    if (assets == NULL) {
+        return 1;
+    }
+    double start = time_monotonic();
+    for (unsigned int pass = 0; pass < BENCH_LOOKUPS; pass++) {
+        for (unsigned int i = 0; i < entries; i++) {
+            bench_name(name, i);
+            assets[i] = assets_unsafe_find(ASSET_TYPE_EMBEDDED, name);
+        }
+    }
+    double lookup = time_monotonic() - start;
+    for (unsigned int i = 0; i < entries; i++) {
+        if (assets[i] == NULL) {
+            fprintf(stderr, "Missing Asset %u\n", i);
+            return 1;
+        }
+    }
+    printf("Lookup            : %8.1f ns per Find (%u Entries)\n", lookup * 1e9 / ((double)entries * BENCH_LOOKUPS), entries);
+
+    // Acquire & Release
+    // Neighbouring assets stay acquired so the pairs below only touch reference counts
+    for (unsigned int i = 0; i < threads; i++) {
+        assets_acquire(assets[i]);
+    }
+    time_sleep(1.0);
+    bench_thread_t single = { assets[0], 0 };
+    bench_thread(&single);
+    printf("Acquire & Release : %8.1f ns per Pair (1 Thread)\n", single.seconds * 1e9 / BENCH_PAIRS);
+
+    bench_thread_t* work = calloc(threads, sizeof(bench_thread_t));
+    pthread_t* handles = calloc(threads, sizeof(pthread_t));
+    if (work == NULL || handles == NULL) {
+        return 1;
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        work[i].asset = assets[i];
+        pthread_create(&handles[i], NULL, bench_thread, &work[i]);
+    }
+    double slowest = 0;
+    for (unsigned int i = 0; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+        if (work[i].seconds > slowest) slowest = work[i].seconds;
+    }
+    printf("Acquire & Release : %8.1f ns per Pair (%u Threads on neighbouring Assets)\n", slowest * 1e9 / BENCH_PAIRS, threads);
+
+    for (unsigned int i = 0; i < threads; i++) {
+        assets_release(assets[i]);
+    }
+    free(handles);
+    free(work);
+    free(assets);
+    engine_assets_exit();
+    engine_logger_exit();
+    remove(BENCH_ARCHIVE);
+    if (chdir("/") == 0) {
+        rmdir(directory);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -55,7 +55,8 @@ gcc "${INPUT_FILES[@]}" \
     -Wall -Wextra -Werror -pedantic -std=c23 \
     -Wundef -Wdouble-promotion -Wnull-dereference \
     -Wswitch-enum -Wmissing-prototypes -Wmissing-declarations \
-    -Iinclude -I$VULKAN_SDK/Include \
+    -D_DEFAULT_SOURCE -Iinclude -I$LUA_SDK/src -I$VULKAN_SDK/Include \
+    -L$LUA_SDK/src -llua -lm -ldl -lpthread \
     -m64 $EXECUTABLE_LEVEL -o $EXECUTABLE_OUTPUT || {
         echo "Compilation Error ($?)" >&2;
         exit $?;
@@ -46,7 +46,7 @@ $inputFiles = Get-ChildItem -Recurse -Include *.c -Path "source" | ForEach-Objec
     -Wundef -Wdouble-promotion -Wnull-dereference `
     -Wswitch-enum -Wmissing-prototypes -Wmissing-declarations `
     -Iinclude -I$env:LUA_SDK\src -I$env:VULKAN_SDK\Include `
-    -lgdi32 -lxinput -lole32 -loleaut32 `
+    -L$env:LUA_SDK\src -llua -lgdi32 -lxinput -lole32 -loleaut32 `
     -m64 -mwindows $opt_level `
     -o $path_game
 
@@ -0,0 +1,192 @@
+#include <engine_config.h>
+#include <stddef.h>
+#pragma once
+
+// Block compressed images keep GPU texture blocks behind a small header. They stay
+// compressed in memory, the software renderer expands the blocks it samples from.
+// Color channels are always premultiplied by alpha.
+//
+//   uint32  Magic 'BCNX'
+//   uint8   Block Format (1 = BC1, 3 = BC3, 7 = BC7)
+//   uint8   Colorspace (0 = sRGB, 1 = Linear)
+//   uint16  Reserved (0)
+//   uint32  Width
+//   uint32  Height
+//   Blocks, left to right and top to bottom (8 Bytes each for BC1, 16 otherwise)
+//
+// Only BC7 mode 6 is decoded, which is the only mode the packager writes.
+
+static const unsigned int MAGIC_BCNX = ('B') | ('C' << 8) | ('N' << 16) | ('X' << 24);
+
+#define BC_HEADER_SIZE       16
+#define BC_COLORSPACE        5       // Header Offset of the Colorspace (0 = sRGB, 1 = Linear)
+#define BC_MAX_DIMENSION     16384
+
+typedef enum {
+    BC_FORMAT_BC1 = 1u,             // RGB + 1-Bit Alpha, 8 Bytes per Block
+    BC_FORMAT_BC3 = 3u,             // RGB + Interpolated Alpha, 16 Bytes per Block
+    BC_FORMAT_BC7 = 7u,             // RGBA (Mode 6), 16 Bytes per Block
+} bc_format_t;
+
+typedef enum {
+    BC_OK = 0,
+    BC_MEMORY_ERROR = 1,
+    BC_INVALID_ARGUMENTS = 2,
+    BC_UNEXPECTED_EOF = 3,
+    BC_INVALID_HEADER = 501,
+    BC_UNSUPPORTED_MODE = 502,
+} bc_error_t;
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static inline unsigned int bc_block_size(unsigned int format) {
+    return format == BC_FORMAT_BC1 ? 8 : 16;
+}
+
+static inline size_t bc_length(unsigned int format, unsigned int width, unsigned int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * bc_block_size(format);
+}
+
+static inline unsigned long long bc_read_u64(const unsigned char* b) {
+    unsigned long long v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | b[i];
+    }
+    return v;
+}
+
+static inline unsigned int bc_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+// Read 'count' bits starting at bit 'offset' of a 128-Bit block
+static inline unsigned int bc_bits(const unsigned long long* block, unsigned int offset, unsigned int count) {
+    unsigned long long v = offset >= 64 ? block[1] >> (offset - 64) : block[0] >> offset;
+    if (offset < 64 && offset + count > 64) {
+        v |= block[1] << (64 - offset);
+    }
+    return (unsigned int)(v & ((1ull << count) - 1));
+}
+
+static inline unsigned int bc_pixel(int r, int g, int b, int a) {
+    return ((unsigned int)a << 24) | ((unsigned int)r << 16) | ((unsigned int)g << 8) | (unsigned int)b;
+}
+
+// Decode a block to 16 pixels (0xAARRGGBB), returns 0 for BC7 modes other than 6
+static inline int bc_decode_block(const unsigned char* block, unsigned int format, unsigned int* out) {
+    switch (format) {
+    case BC_FORMAT_BC1:
+    case BC_FORMAT_BC3: {
+        const unsigned char* color = format == BC_FORMAT_BC3 ? block + 8 : block;
+        unsigned int c0 = color[0] | (color[1] << 8);
+        unsigned int c1 = color[2] | (color[3] << 8);
+        unsigned int indices = bc_read_u32(color + 4);
+        bool_t four = format == BC_FORMAT_BC3 || c0 > c1;
+
+        // Color Palette (565 Endpoints)
+        int palette[4][4];
+        for (int e = 0; e < 2; e++) {
+            unsigned int v = e ? c1 : c0;
+            int r = (v >> 11) & 0x1F, g = (v >> 5) & 0x3F, b = v & 0x1F;
+            palette[e][0] = (r << 3) | (r >> 2);
+            palette[e][1] = (g << 2) | (g >> 4);
+            palette[e][2] = (b << 3) | (b >> 2);
+            palette[e][3] = 255;
+        }
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = four ? (2 * palette[0][c] + palette[1][c]) / 3 : (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = four ? (palette[0][c] + 2 * palette[1][c]) / 3 : 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = four ? 255 : 0;
+
+        // Alpha Palette (BC3)
+        int alpha[8] = { 0 };
+        unsigned long long alpha_indices = 0;
+        if (format == BC_FORMAT_BC3) {
+            int a0 = block[0], a1 = block[1];
+            alpha[0] = a0;
+            alpha[1] = a1;
+            int steps = a0 > a1 ? 7 : 5;
+            for (int i = 1; i < steps; i++) {
+                alpha[i + 1] = ((steps - i) * a0 + i * a1) / steps;
+            }
+            if (steps == 5) {
+                alpha[6] = 0;
+                alpha[7] = 255;
+            }
+            alpha_indices = bc_read_u64(block) >> 16;
+        }
+        for (int i = 0; i < 16; i++) {
+            const int* p = palette[(indices >> (i * 2)) & 3];
+            int a = format == BC_FORMAT_BC3 ? alpha[(alpha_indices >> (i * 3)) & 7] : p[3];
+            out[i] = bc_pixel(p[0], p[1], p[2], a);
+        }
+        return 1;
+    }
+    case BC_FORMAT_BC7: {
+        unsigned long long bits[2] = { bc_read_u64(block), bc_read_u64(block + 8) };
+        if ((bits[0] & 0x7F) != 0x40) {
+            return 0;
+        }
+        int e[2][4];
+        for (int c = 0; c < 4; c++) {
+            e[0][c] = (int)(bc_bits(bits, 7 + c * 14, 7) << 1 | bc_bits(bits, 63, 1));
+            e[1][c] = (int)(bc_bits(bits, 14 + c * 14, 7) << 1 | bc_bits(bits, 64, 1));
+        }
+        for (int i = 0; i < 16; i++) {
+            unsigned int index = i == 0 ? bc_bits(bits, 65, 3) : bc_bits(bits, 64 + i * 4, 4);
+            int w = BC7_WEIGHTS[index];
+            int p[4];
+            for (int c = 0; c < 4; c++) {
+                p[c] = ((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6;
+            }
+            out[i] = bc_pixel(p[0], p[1], p[2], p[3]);
+        }
+        return 1;
+    }
+    default: {
+        return 0;
+    }
+    }
+}
+
+// Validate the header of a block compressed stream, the blocks follow it
+static inline bc_error_t bc_read_header(
+    const unsigned char* input_buffer,  // Encoded Buffer
+    const unsigned int input_length,    // Encoded Buffer Length
+    unsigned int* image_format,         // Block Format (bc_format_t)
+    unsigned int* image_width,          // Image Width
+    unsigned int* image_height          // Image Height
+) {
+    if (!input_buffer || !image_format || !image_width || !image_height) {
+        return BC_INVALID_ARGUMENTS;
+    }
+    if (input_length < BC_HEADER_SIZE) {
+        return BC_UNEXPECTED_EOF;
+    }
+    unsigned int format = input_buffer[4];
+    unsigned int width = bc_read_u32(input_buffer + 8);
+    unsigned int height = bc_read_u32(input_buffer + 12);
+    if (bc_read_u32(input_buffer) != MAGIC_BCNX || (format != BC_FORMAT_BC1 && format != BC_FORMAT_BC3 && format != BC_FORMAT_BC7) ||
+        width == 0 || width > BC_MAX_DIMENSION || height == 0 || height > BC_MAX_DIMENSION) {
+        return BC_INVALID_HEADER;
+    }
+    if (BC_HEADER_SIZE + bc_length(format, width, height) > input_length) {
+        return BC_UNEXPECTED_EOF;
+    }
+
+    // Every BC7 Block has to be in Mode 6
+    if (format == BC_FORMAT_BC7) {
+        const unsigned char* blocks = input_buffer + BC_HEADER_SIZE;
+        for (size_t i = 0; i < bc_length(format, width, height); i += 16) {
+            if ((blocks[i] & 0x7F) != 0x40) {
+                return BC_UNSUPPORTED_MODE;
+            }
+        }
+    }
+    *image_format = format;
+    *image_width = width;
+    *image_height = height;
+    return BC_OK;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#pragma once
+
+// Meshes are flat vertex and index arrays behind a header, already ordered for the
+// vertex cache and quantized by the packager. Loading one only validates it and
+// points into the payload, nothing is decoded.
+//
+//   uint32  Magic 'MESH'
+//   uint32  Vertex Count
+//   uint32  Index Count (All Levels, Multiple of 3)
+//   uint8   Index Size (2 or 4 Bytes)
+//   uint8   Attributes (0x01 = Texture Coordinates, 0x02 = Normals)
+//   uint8   Vertex Size (16 Bytes)
+//   uint8   Level Count (N), Level 0 is the Source
+//   float   Position Minimum (XYZ), Position Scale (XYZ)
+//   float   Texture Coordinate Minimum (UV), Texture Coordinate Scale (UV)
+//   N * { uint32 First Index, uint32 Index Count, uint32 Vertex Count, float Error }
+//   Vertices { uint16 Position XYZ, uint16 Reserved, int8 Normal XYZ, int8 Reserved, uint16 UV }
+//   Indices of Level 0 up to Level N-1
+//
+// A position is 'minimum + value * scale', texture coordinates likewise. Normals are
+// 'value / 127'. Every level of detail draws from the first 'Vertex Count' vertices,
+// its error is the distance (in model units) it may move the surface by.
+
+static const unsigned int MAGIC_MESH = ('M') | ('E' << 8) | ('S' << 16) | ('H' << 24);
+
+#define MESH_HEADER_SIZE     56
+#define MESH_VERTEX_SIZE     16
+#define MESH_LOD_SIZE        16
+#define MESH_LOD_LIMIT       8
+#define MESH_TABLE_SIZE(n)   (MESH_HEADER_SIZE + (n) * MESH_LOD_SIZE)
+#define MESH_ATTRIBUTE_UV     0x01
+#define MESH_ATTRIBUTE_NORMAL 0x02
+
+typedef enum {
+    MESH_OK = 0,
+    MESH_MEMORY_ERROR = 1,
+    MESH_INVALID_ARGUMENTS = 2,
+    MESH_UNEXPECTED_EOF = 3,
+    MESH_INVALID_HEADER = 701,
+    MESH_INVALID_INDEX = 702,
+} mesh_error_t;
+
+typedef struct {
+    unsigned short position[3];     // Quantized Position
+    unsigned short reserved;        // Padding (0)
+    signed char normal[3];          // Normal (SNORM8)
+    signed char reserved_normal;    // Padding (0)
+    unsigned short uv[2];           // Quantized Texture Coordinate
+} mesh_vertex_t;
+
+typedef struct {
+    const void* indices;            // Indices (Points into the Payload, 'index_size' Bytes each)
+    unsigned int index_count;       // Index Count
+    unsigned int vertex_count;      // Vertices used (always the first ones)
+    float error;                    // Largest Distance to the Source Surface
+} mesh_lod_t;
+
+typedef struct {
+    const mesh_vertex_t* vertices;  // Vertices (Points into the Payload)
+    const void* indices;            // Indices of Level 0 (Points into the Payload, 'index_size' Bytes each)
+    unsigned int vertex_count;      // Vertex Count
+    unsigned int index_count;       // Index Count of Level 0
+    unsigned char index_size;       // Index Size (2 or 4 Bytes)
+    unsigned char attributes;       // Attributes (MESH_ATTRIBUTE_*)
+    unsigned char lod_count;        // Levels of Detail (at least 1)
+    float position_min[3];          // Position Minimum
+    float position_scale[3];        // Position Step
+    float uv_min[2];                // Texture Coordinate Minimum
+    float uv_scale[2];              // Texture Coordinate Step
+    mesh_lod_t lods[MESH_LOD_LIMIT]; // Levels of Detail (Finest first)
+} mesh_t;
+
+static inline unsigned int mesh_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+static inline float mesh_read_f32(const unsigned char* b) {
+    unsigned int bits = mesh_read_u32(b);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// Validate a mesh payload and point 'mesh' into it, the payload has to stay alive
+// (and 4 Byte aligned) for as long as the mesh is used.
+static inline mesh_error_t mesh_read(
+    const unsigned char* input_buffer,  // Mesh Payload
+    const unsigned int input_length,    // Mesh Payload Length
+    mesh_t* mesh                        // Output Mesh
+) {
+    if (!input_buffer || !mesh || ((uintptr_t)input_buffer & 3) != 0) {
+        return MESH_INVALID_ARGUMENTS;
+    }
+    if (input_length < MESH_HEADER_SIZE) {
+        return MESH_UNEXPECTED_EOF;
+    }
+    unsigned int vertex_count = mesh_read_u32(input_buffer + 4);
+    unsigned int index_count = mesh_read_u32(input_buffer + 8);
+    unsigned int index_size = input_buffer[12];
+    unsigned int vertex_size = input_buffer[14];
+    unsigned int lod_count = input_buffer[15];
+    if (mesh_read_u32(input_buffer) != MAGIC_MESH || vertex_size != MESH_VERTEX_SIZE ||
+        (index_size != 2 && index_size != 4) || index_count % 3 != 0 ||
+        (index_size == 2 && vertex_count > 65536) || lod_count == 0 || lod_count > MESH_LOD_LIMIT) {
+        return MESH_INVALID_HEADER;
+    }
+    size_t vertex_bytes = (size_t)vertex_count * MESH_VERTEX_SIZE;
+    size_t index_bytes = (size_t)index_count * index_size;
+    if (MESH_TABLE_SIZE(lod_count) + vertex_bytes + index_bytes > input_length) {
+        return MESH_UNEXPECTED_EOF;
+    }
+
+    // Out of Range Indices would read past the Vertices (or the Prefix of the Level) on the GPU
+    const unsigned char* indices = input_buffer + MESH_TABLE_SIZE(lod_count) + vertex_bytes;
+    for (unsigned int l = 0; l < lod_count; l++) {
+        const unsigned char* entry = input_buffer + MESH_TABLE_SIZE(l);
+        unsigned int first = mesh_read_u32(entry);
+        unsigned int count = mesh_read_u32(entry + 4);
+        unsigned int limit = mesh_read_u32(entry + 8);
+        if (count % 3 != 0 || first > index_count || count > index_count - first || limit > vertex_count) {
+            return MESH_INVALID_HEADER;
+        }
+        if (index_size == 2) {
+            const unsigned short* list = (const unsigned short*)indices + first;
+            for (unsigned int i = 0; i < count; i++) {
+                if (list[i] >= limit) return MESH_INVALID_INDEX;
+            }
+        }
+        else {
+            const unsigned int* list = (const unsigned int*)indices + first;
+            for (unsigned int i = 0; i < count; i++) {
+                if (list[i] >= limit) return MESH_INVALID_INDEX;
+            }
+        }
+        mesh->lods[l].indices = indices + (size_t)first * index_size;
+        mesh->lods[l].index_count = count;
+        mesh->lods[l].vertex_count = limit;
+        mesh->lods[l].error = mesh_read_f32(entry + 12);
+    }
+
+    mesh->vertices = (const mesh_vertex_t*)(input_buffer + MESH_TABLE_SIZE(lod_count));
+    mesh->indices = mesh->lods[0].indices;
+    mesh->vertex_count = vertex_count;
+    mesh->index_count = mesh->lods[0].index_count;
+    mesh->index_size = (unsigned char)index_size;
+    mesh->attributes = input_buffer[13];
+    mesh->lod_count = (unsigned char)lod_count;
+    for (unsigned int c = 0; c < 3; c++) {
+        mesh->position_min[c] = mesh_read_f32(input_buffer + 16 + c * 4);
+        mesh->position_scale[c] = mesh_read_f32(input_buffer + 28 + c * 4);
+    }
+    for (unsigned int c = 0; c < 2; c++) {
+        mesh->uv_min[c] = mesh_read_f32(input_buffer + 40 + c * 4);
+        mesh->uv_scale[c] = mesh_read_f32(input_buffer + 48 + c * 4);
+    }
+    return MESH_OK;
+}
+
+// Level of Detail by index, clamped to the coarsest one
+static inline const mesh_lod_t* mesh_lod(const mesh_t* mesh, unsigned int level) {
+    return &mesh->lods[level < mesh->lod_count ? level : mesh->lod_count - 1u];
+}
+
+// Coarsest Level of Detail whose error stays within 'error_limit' (model units), a
+// caller turns its screen space tolerance into that distance at the mesh's depth
+static inline unsigned int mesh_select(const mesh_t* mesh, float error_limit) {
+    unsigned int level = 0;
+    while (level + 1u < mesh->lod_count && mesh->lods[level + 1u].error <= error_limit) {
+        level++;
+    }
+    return level;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+// Mipmapped images store every level as an image stream (QOI or block compressed) of its
+// own behind a level table.
+// Levels are written coarsest first, so the start of the payload up to the end of any
+// level holds that level and every coarser one, each decodable on its own.
+//
+//   uint32  Magic 'MIPS'
+//   uint32  Level Count (N), Level 0 is the full resolution
+//   N * { uint32 End Offset of the Level, uint32 CRC32 of the Level }
+//   Image Streams of Level N-1 down to Level 0
+
+static const unsigned int MAGIC_MIPS = ('M') | ('I' << 8) | ('P' << 16) | ('S' << 24);
+
+#define MIP_LEVEL_LIMIT      16
+#define MIP_HEADER_SIZE      8
+#define MIP_LEVEL_SIZE       8
+#define MIP_TABLE_SIZE(n)    (MIP_HEADER_SIZE + (n) * MIP_LEVEL_SIZE)
+
+typedef enum {
+    MIP_OK = 0,
+    MIP_MEMORY_ERROR = 1,
+    MIP_INVALID_ARGUMENTS = 2,
+    MIP_UNEXPECTED_EOF = 3,
+    MIP_INVALID_HEADER = 301,
+} mip_error_t;
+
+static inline unsigned int mip_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+// Read the level table from the start of a payload, only 'input_length' bytes of
+// the 'payload_length' byte payload need to be present.
+static inline mip_error_t mip_read_table(
+    const unsigned char* input_buffer,  // Start of the Payload
+    const unsigned int input_length,    // Bytes available
+    const unsigned int payload_length,  // Bytes of the whole Payload
+    unsigned int* table_levels,         // Level Count
+    unsigned int* table_ends,           // End Offset per Level (MIP_LEVEL_LIMIT entries)
+    unsigned int* table_hashes          // Checksum per Level (MIP_LEVEL_LIMIT entries)
+) {
+    if (!input_buffer || !table_levels || !table_ends || !table_hashes) {
+        return MIP_INVALID_ARGUMENTS;
+    }
+    if (input_length < MIP_HEADER_SIZE) {
+        return MIP_UNEXPECTED_EOF;
+    }
+    unsigned int levels = mip_read_u32(input_buffer + 4);
+    if (mip_read_u32(input_buffer) != MAGIC_MIPS || levels == 0 || levels > MIP_LEVEL_LIMIT) {
+        return MIP_INVALID_HEADER;
+    }
+    if (input_length < MIP_TABLE_SIZE(levels)) {
+        return MIP_UNEXPECTED_EOF;
+    }
+
+    // Levels follow each other from the coarsest one
+    unsigned int start = MIP_TABLE_SIZE(levels);
+    for (unsigned int i = levels; i-- > 0;) {
+        table_ends[i] = mip_read_u32(input_buffer + MIP_TABLE_SIZE(i));
+        table_hashes[i] = mip_read_u32(input_buffer + MIP_TABLE_SIZE(i) + 4);
+        if (table_ends[i] <= start || table_ends[i] > payload_length) {
+            return MIP_INVALID_HEADER;
+        }
+        start = table_ends[i];
+    }
+    *table_levels = levels;
+    return MIP_OK;
+}
+
+// Offset of a level within the payload, it ends at 'table_ends[level]'
+static inline unsigned int mip_level_start(const unsigned int* table_ends, unsigned int levels, unsigned int level) {
+    return level + 1 < levels ? table_ends[level + 1] : MIP_TABLE_SIZE(levels);
+}
\ No newline at end of file
@@ -17,6 +17,7 @@ typedef enum {
 #define QOI_MAX_DIMENSION    16384
 #define QOI_HEADER_SIZE      14
 #define QOI_FOOTER_SIZE      8
+#define QOI_COLORSPACE       13      // Header Offset of the Colorspace (0 = sRGB, 1 = Linear)
 #define QOI_MINIMUM_SIZE     QOI_HEADER_SIZE + QOI_FOOTER_SIZE
 #define QOI_OP_MASK          0xC0
 #define QOI_OP_RGB           0xFE
@@ -49,10 +50,10 @@ static inline qoi_error_t qoi_encode(
     unsigned int input_offset = 0;
 
     // Initialize Encoder
-    // We naively assume that everything will into this buffer, if it doesn't then we'll just simply die! :3
+    // Sized for the worst case, every pixel taking an RGBA opcode (5 Bytes)
     // This function *really* shouldn't be called during gameplay...
     unsigned int output_offset = 0;
-    unsigned char* output_buffer = malloc(QOI_MINIMUM_SIZE + (input_width * input_height * 2));
+    unsigned char* output_buffer = malloc(QOI_MINIMUM_SIZE + ((size_t)input_width * input_height * 5));
     if (!output_buffer) {
         return QOI_MEMORY_ERROR;
     }
@@ -162,6 +163,11 @@ static inline qoi_error_t qoi_encode(
             pre = cur;
         }
     }
+    if (run) {
+        // Image ended mid-run, flush current run...
+        unsigned char run_byte = QOI_OP_RUN | (run - 1);
+        output_buffer[output_offset++] = run_byte;
+    }
 
     // Write Footer
     output_buffer[output_offset++] = 0x00;
@@ -184,6 +190,8 @@ static inline qoi_error_t qoi_encode(
     return QOI_OK;
 }
 
+// Pixels are written with their channels in stream order from the lowest byte up, the
+// usual stream decodes to 0xAABBGGRR while one storing B, G, R, A yields 0xAARRGGBB.
 static inline qoi_error_t qoi_decode(
     const unsigned char* input_buffer,  // Encoded Buffer
     const unsigned int input_length,    // Encoded Buffer Length
@@ -257,10 +265,10 @@ static inline qoi_error_t qoi_decode(
             }
             else if ((op & QOI_OP_MASK) == QOI_OP_INDEX) {
                 unsigned int px = table[op];
-                r = (px >> 24) & 0xFF;
-                g = (px >> 16) & 0xFF;
-                b = (px >> 8) & 0xFF;
-                a = (px) & 0xFF;
+                r = (px) & 0xFF;
+                g = (px >> 8) & 0xFF;
+                b = (px >> 16) & 0xFF;
+                a = (px >> 24) & 0xFF;
             }
             else if ((op & QOI_OP_MASK) == QOI_OP_DIFF) {
                 r += ((op >> 4) & 0x03) - 2;
@@ -281,10 +289,10 @@ static inline qoi_error_t qoi_decode(
 
             // Update Table
             unsigned char idx = (r * 3 + g * 5 + b * 7 + a * 11) & (64 - 1);
-            table[idx] = (r << 24) | (g << 16) | (b << 8) | a;
+            table[idx] = ((unsigned int)a << 24) | ((unsigned int)b << 16) | ((unsigned int)g << 8) | r;
         }
 
-        output_buffer[output_offset++] = (r << 24) | (g << 16) | (b << 8) | a;
+        output_buffer[output_offset++] = ((unsigned int)a << 24) | ((unsigned int)b << 16) | ((unsigned int)g << 8) | r;
         pixel_pos++;
     }
     if ((pixel_pos < pixel_len) || (input_offset + QOI_FOOTER_SIZE > input_length)) {
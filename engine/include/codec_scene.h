@@ -0,0 +1,226 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#pragma once
+
+// Scenes are flat entity, component and property records compiled by the packager
+// from XML. Loading one only validates it and points into the payload, nothing is
+// parsed. References to other assets were resolved to their index in the archive.
+//
+//   uint32  Magic 'SCNE'
+//   uint32  Entity Count
+//   uint32  Component Count
+//   uint32  Reference Count
+//   uint32  Property Bytes
+//   uint32  String Bytes
+//   References { uint32 Asset Index, uint32 Asset Type }
+//   Entities { uint32 Name, uint32 Parent, uint32 First Component, uint32 Component Count }
+//   Components { uint32 Type, uint32 Property Offset, uint32 Property Bytes, uint32 Property Count }
+//   Properties { uint32 Name, uint8 Kind, uint8 Value Count, uint16 Reserved, uint32 Values[] }
+//   Strings (NUL Terminated, Offset 0 is the empty String)
+//
+// Names and types are offsets into the strings. Parents come before their children,
+// the components of an entity follow each other.
+
+static const unsigned int MAGIC_SCNE = ('S') | ('C' << 8) | ('N' << 16) | ('E' << 24);
+
+#define SCENE_HEADER_SIZE    24
+#define SCENE_PROPERTY_SIZE  8
+#define SCENE_NONE           0xFFFFFFFF  // Parent of Entities at the Top of the Scene
+
+typedef enum {
+    SCENE_OK = 0,
+    SCENE_MEMORY_ERROR = 1,
+    SCENE_INVALID_ARGUMENTS = 2,
+    SCENE_UNEXPECTED_EOF = 3,
+    SCENE_INVALID_HEADER = 801,
+    SCENE_INVALID_RECORD = 802,
+} scene_error_t;
+
+typedef enum {
+    SCENE_PROPERTY_FLOAT = 1u,      // 1 to 4 Floats
+    SCENE_PROPERTY_BOOL = 2u,       // 0 or 1
+    SCENE_PROPERTY_STRING = 3u,     // String Offset
+    SCENE_PROPERTY_REFERENCE = 4u,  // Reference Index
+} __attribute__((__packed__)) scene_property_kind_t;
+
+typedef struct {
+    unsigned int asset;             // Index of the Asset in the Archive
+    unsigned int type;              // Asset Type
+} scene_reference_t;
+
+typedef struct {
+    unsigned int name;              // Name (String Offset)
+    unsigned int parent;            // Parent Entity (SCENE_NONE at the Top)
+    unsigned int first_component;   // First Component
+    unsigned int component_count;   // Component Count
+} scene_entity_t;
+
+typedef struct {
+    unsigned int type;              // Type (String Offset)
+    unsigned int offset;            // First Property (Byte Offset)
+    unsigned int size;              // Property Bytes
+    unsigned int property_count;    // Property Count
+} scene_component_t;
+
+typedef struct {
+    unsigned int name;              // Name (String Offset)
+    unsigned char kind;             // Value Kind (scene_property_kind_t)
+    unsigned char count;            // Value Count
+    unsigned short reserved;        // Padding (0)
+    unsigned int values[];          // Values (Floats, Booleans, String Offsets or Reference Indices)
+} scene_property_t;
+
+typedef struct {
+    const scene_reference_t* references;    // References (Points into the Payload)
+    const scene_entity_t* entities;         // Entities (Points into the Payload)
+    const scene_component_t* components;    // Components (Points into the Payload)
+    const unsigned char* properties;        // Property Records (Points into the Payload)
+    const char* strings;                    // Strings (Points into the Payload)
+    unsigned int reference_count;           // Reference Count
+    unsigned int entity_count;              // Entity Count
+    unsigned int component_count;           // Component Count
+    unsigned int property_size;             // Property Bytes
+    unsigned int string_size;               // String Bytes
+} scene_t;
+
+static inline unsigned int scene_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+// Validate a scene payload and point 'scene' into it, the payload has to stay alive
+// (and 4 Byte aligned) for as long as the scene is used.
+static inline scene_error_t scene_read(
+    const unsigned char* input_buffer,  // Scene Payload
+    const unsigned int input_length,    // Scene Payload Length
+    scene_t* scene                      // Output Scene
+) {
+    if (!input_buffer || !scene || ((uintptr_t)input_buffer & 3) != 0) {
+        return SCENE_INVALID_ARGUMENTS;
+    }
+    if (input_length < SCENE_HEADER_SIZE) {
+        return SCENE_UNEXPECTED_EOF;
+    }
+    unsigned int entity_count = scene_read_u32(input_buffer + 4);
+    unsigned int component_count = scene_read_u32(input_buffer + 8);
+    unsigned int reference_count = scene_read_u32(input_buffer + 12);
+    unsigned int property_size = scene_read_u32(input_buffer + 16);
+    unsigned int string_size = scene_read_u32(input_buffer + 20);
+    if (scene_read_u32(input_buffer) != MAGIC_SCNE || property_size % 4 != 0 || string_size % 4 != 0 || string_size == 0) {
+        return SCENE_INVALID_HEADER;
+    }
+    unsigned long long length = SCENE_HEADER_SIZE + (unsigned long long)reference_count * sizeof(scene_reference_t) +
+        (unsigned long long)entity_count * sizeof(scene_entity_t) + (unsigned long long)component_count * sizeof(scene_component_t) +
+        property_size + string_size;
+    if (length > input_length) {
+        return SCENE_UNEXPECTED_EOF;
+    }
+    const scene_reference_t* references = (const scene_reference_t*)(input_buffer + SCENE_HEADER_SIZE);
+    const scene_entity_t* entities = (const scene_entity_t*)(references + reference_count);
+    const scene_component_t* components = (const scene_component_t*)(entities + entity_count);
+    const unsigned char* properties = (const unsigned char*)(components + component_count);
+    const char* strings = (const char*)(properties + property_size);
+
+    // Every Offset has to land within its Table, so readers need no checks of their own
+    if (strings[0] != '\0' || strings[string_size - 1] != '\0') {
+        return SCENE_INVALID_RECORD;
+    }
+    unsigned int first = 0;
+    for (unsigned int e = 0; e < entity_count; e++) {
+        const scene_entity_t* entity = &entities[e];
+        if (entity->name >= string_size || (entity->parent != SCENE_NONE && entity->parent >= e) ||
+            entity->first_component != first || entity->component_count > component_count - first) {
+            return SCENE_INVALID_RECORD;
+        }
+        first += entity->component_count;
+    }
+    if (first != component_count) {
+        return SCENE_INVALID_RECORD;
+    }
+    for (unsigned int c = 0; c < component_count; c++) {
+        const scene_component_t* component = &components[c];
+        if (component->type >= string_size || component->offset % 4 != 0 ||
+            component->offset > property_size || component->size > property_size - component->offset) {
+            return SCENE_INVALID_RECORD;
+        }
+        unsigned int offset = component->offset, end = component->offset + component->size;
+        for (unsigned int p = 0; p < component->property_count; p++) {
+            if (end - offset < SCENE_PROPERTY_SIZE) {
+                return SCENE_INVALID_RECORD;
+            }
+            const scene_property_t* property = (const scene_property_t*)(properties + offset);
+            unsigned int count = property->count;
+            if (property->name >= string_size || count == 0 || (end - offset - SCENE_PROPERTY_SIZE) / 4 < count) {
+                return SCENE_INVALID_RECORD;
+            }
+            switch (property->kind) {
+            case SCENE_PROPERTY_FLOAT:      if (count > 4) return SCENE_INVALID_RECORD; break;
+            case SCENE_PROPERTY_BOOL:       if (count != 1 || property->values[0] > 1) return SCENE_INVALID_RECORD; break;
+            case SCENE_PROPERTY_STRING:     if (count != 1 || property->values[0] >= string_size) return SCENE_INVALID_RECORD; break;
+            case SCENE_PROPERTY_REFERENCE:  if (count != 1 || property->values[0] >= reference_count) return SCENE_INVALID_RECORD; break;
+            default:                        return SCENE_INVALID_RECORD;
+            }
+            offset += SCENE_PROPERTY_SIZE + count * 4;
+        }
+        if (offset != end) {
+            return SCENE_INVALID_RECORD;
+        }
+    }
+
+    scene->references = references;
+    scene->entities = entities;
+    scene->components = components;
+    scene->properties = properties;
+    scene->strings = strings;
+    scene->reference_count = reference_count;
+    scene->entity_count = entity_count;
+    scene->component_count = component_count;
+    scene->property_size = property_size;
+    scene->string_size = string_size;
+    return SCENE_OK;
+}
+
+static inline const char* scene_string(const scene_t* scene, unsigned int offset) {
+    return scene->strings + offset;
+}
+
+// Component of an entity by type, NULL if it has none
+static inline const scene_component_t* scene_component(const scene_t* scene, const scene_entity_t* entity, const char* type) {
+    for (unsigned int c = 0; c < entity->component_count; c++) {
+        const scene_component_t* component = &scene->components[entity->first_component + c];
+        if (strcmp(scene->strings + component->type, type) == 0) {
+            return component;
+        }
+    }
+    return NULL;
+}
+
+// Walk the properties of a component, start with 'previous' set to NULL
+static inline const scene_property_t* scene_property_next(const scene_t* scene, const scene_component_t* component, const scene_property_t* previous) {
+    unsigned int offset = previous == NULL ? component->offset :
+        (unsigned int)((const unsigned char*)previous - scene->properties) + SCENE_PROPERTY_SIZE + previous->count * 4u;
+    if (offset >= component->offset + component->size) {
+        return NULL;
+    }
+    return (const scene_property_t*)(scene->properties + offset);
+}
+
+// Property of a component by name, NULL if it wasn't set
+static inline const scene_property_t* scene_property(const scene_t* scene, const scene_component_t* component, const char* name) {
+    for (const scene_property_t* p = scene_property_next(scene, component, NULL); p != NULL; p = scene_property_next(scene, component, p)) {
+        if (strcmp(scene->strings + p->name, name) == 0) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// Value of a float property, 'fallback' if the property is missing or too short
+static inline float scene_float(const scene_property_t* property, unsigned int index, float fallback) {
+    if (property == NULL || property->kind != SCENE_PROPERTY_FLOAT || index >= property->count) {
+        return fallback;
+    }
+    float v;
+    memcpy(&v, &property->values[index], sizeof(v));
+    return v;
+}
\ No newline at end of file
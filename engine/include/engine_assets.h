@@ -1,4 +1,6 @@
 #include <engine_config.h>
+#include <codec_mesh.h>
+#include <codec_scene.h>
 #include <stdatomic.h>
 #include <pthread.h>
 #include <stdio.h>
@@ -12,10 +14,31 @@ static const unsigned int MAGIC_YURI = ('Y') | ('U' << 8) | ('R' << 16) | ('I' <
 #define YURI_SIZE_ENTRY  \
     (sizeof(unsigned char) * 2) + (sizeof(unsigned int) * 2) + sizeof(unsigned short)
 
-#define ASSET_ARCHIVE_LIMIT                  32
-#define ASSET_REGISTRY_CLEANUP_INTERVAL      30
-#define ASSET_REGISTRY_MEMORY_PROBE_INTERVAL 3
-#define ASSET_REGISTRY_MEMORY_PRESSURE_LIMIT 80
+#define ASSET_REGISTRY_COLLECT_SLICE         0.0005  // Collection Time per Tick (Seconds)
+#define ASSET_REGISTRY_COLLECT_URGENT        0.002   // Collection Time per Tick under Critical Memory Pressure (Seconds)
+#define ASSET_REGISTRY_COLLECT_CANDIDATES    64      // Eviction Candidates per Pass
+#define ASSET_REGISTRY_COLLECT_TARGET        90      // Evict down to X% of the Budget
+#define ASSET_REGISTRY_MEMORY_PROBE_INTERVAL 3       // Memory Usage Probe Interval (Seconds)
+#define ASSET_REGISTRY_STATS_INTERVAL        10      // Memory Usage Log Interval (Seconds)
+#define ASSET_RELOAD_DELAY                   0.2     // Wait for Archive Writes to settle (Seconds)
+#define ASSET_RETRY_POLL                     0.05    // Reader Wake Interval while Retries are pending (Seconds)
+#define ASSET_RELOAD_RESERVE                 256     // Registry Space for Assets added while Running
+#define ASSET_TRACE_LOOKAHEAD                2.0     // Prefetch Traced Assets X Seconds before their First Use
+#define ASSET_TRACE_GROWTH                   256     // Trace Entries allocated at once
+#define ASSET_READ_BATCH                     64      // Assets claimed by the Reader at once
+#define ASSET_READ_DEPTH                     64      // Archive Reads queued ahead of the Workers
+#define ASSET_READ_GAP                       65536   // Read across Gaps of up to X Bytes between Payloads
+#define ASSET_READ_LIMIT                     8388608 // Largest Read of neighbouring Payloads (Bytes)
+#define ASSET_MIP_LIMIT                      16      // Mip Levels of an Image (Also: No Level requested)
+#define ASSET_MIP_PROBE                      16384   // Bytes read of a Mipmapped Image whose Level Table is unknown
+#define ASSET_SPRITE_SIZE                    26      // Sprite Entry Size without the Page Name
+#define ASSET_STATS_TOTAL                    0       // Statistics Slot for all Types combined
+#define ASSET_STATS_LIMIT                    10      // Statistics Slots (Highest Type + 1)
+
+#define ASSET_FLAG_MIPMAPPED                 0x40    // Image stores a Mip Chain
+#define ASSET_FLAG_BGRA                      0x20    // Image Channels stored as B, G, R, A
+#define ASSET_FLAG_PREMULTIPLIED             0x10    // Image Colors premultiplied by Alpha
+#define ASSET_FLAG_BYTECODE                  0x08    // Script stores Lua Bytecode
 
 typedef enum {
     ASSET_TYPE_EMBEDDED = 1u,
@@ -26,6 +49,7 @@ typedef enum {
     ASSET_TYPE_MODEL = 6u,
     ASSET_TYPE_SCENE = 7u,
     ASSET_TYPE_SCRIPT = 8u,
+    ASSET_TYPE_SPRITE = 9u,
 } __attribute__((__packed__)) asset_type_t;
 
 typedef enum {
@@ -33,7 +57,11 @@ typedef enum {
     ASSET_STATE_WAIT = 2u,          // Asset is awaiting a worker thread to process it
     ASSET_STATE_BUSY = 3u,          // Asset is being processed by a worker thread
     ASSET_STATE_UPLOAD = 4u,        // Asset is sitting in memory waiting for GPU upload
-    ASSET_STATE_DONE = 5u           // Asset is ready and meta field is set
+    ASSET_STATE_DONE = 5u,          // Asset is ready and meta field is set
+    ASSET_STATE_EVICT = 6u,         // Asset is being evicted by the collector
+    ASSET_STATE_STALE = 7u,         // Asset is ready but outdated, awaiting a worker to reload it
+    ASSET_STATE_RELOAD = 8u,        // Asset is ready while a worker decodes its newer version
+    ASSET_STATE_PREFETCH = 9u,      // Asset is awaiting a worker thread once no other work is left
 } __attribute__((__packed__)) asset_state_t;
 
 typedef struct {
@@ -47,11 +75,50 @@ typedef struct {
 } asset_metadata_shader_t;
 
 typedef struct {
-    unsigned int* pixels;           // Image RGBA Pixels
-    unsigned int width;             // Image Width
-    unsigned int height;            // Image Height
+    unsigned int* pixels;           // Mip Pixels (0xAARRGGBB, Premultiplied)
+    unsigned char* blocks;          // Mip Blocks, set instead of 'pixels' for Block Compressed Levels
+    unsigned char format;           // Block Format (bc_format_t, 0 = Pixels)
+    unsigned int width;             // Mip Width
+    unsigned int height;            // Mip Height
+} asset_mip_t;
+
+typedef struct {
+    unsigned int* pixels;           // Image Pixels (0xAARRGGBB, Premultiplied, Finest Loaded Level)
+    unsigned char* blocks;          // Image Blocks, set instead of 'pixels' when Block Compressed
+    unsigned char format;           // Block Format (bc_format_t, 0 = Pixels)
+    unsigned int width;             // Image Width (Finest Loaded Level)
+    unsigned int height;            // Image Height (Finest Loaded Level)
+    bool_t linear;                  // Pixels hold Linear Values rather than sRGB
+    unsigned int level;             // Finest Loaded Level, coarser ones are loaded too
+    unsigned int level_count;       // Levels in the Archive (1 without Mipmaps)
+    asset_mip_t* mips;              // Levels, unloaded ones are empty (NULL without Mipmaps)
 } asset_metadata_image_t;
 
+typedef struct {
+    struct asset_s* page;           // Atlas Page (Image) holding the Sprite
+    unsigned int x;                 // Position on the Page
+    unsigned int y;                 // Position on the Page
+    unsigned int width;             // Sprite Width
+    unsigned int height;            // Sprite Height
+    float u0;                       // Page Texture Coordinate (Left)
+    float v0;                       // Page Texture Coordinate (Top)
+    float u1;                       // Page Texture Coordinate (Right)
+    float v1;                       // Page Texture Coordinate (Bottom)
+} asset_metadata_sprite_t;
+
+typedef struct {
+    unsigned char* data;            // Mesh Payload
+    unsigned int size;              // Mesh Payload Size
+    mesh_t mesh;                    // Vertices & Indices within the Payload
+} asset_metadata_model_t;
+
+typedef struct {
+    unsigned char* data;            // Scene Payload
+    unsigned int size;              // Scene Payload Size
+    scene_t scene;                  // Records within the Payload
+    struct asset_s** assets;        // Referenced Assets by Reference Index (not acquired)
+} asset_metadata_scene_t;
+
 typedef struct {
     unsigned int samples;           // Samples per Channel
     unsigned int channels;          // Channels
@@ -64,27 +131,116 @@ typedef union {
     asset_metadata_shader_t shader;
     asset_metadata_image_t image;
     asset_metadata_audio_t audio;
+    asset_metadata_model_t model;
+    asset_metadata_sprite_t sprite;
+    asset_metadata_scene_t scene;
 } asset_metadata_u;
 
-typedef struct {
-    atomic_char state;              // Asset State
-    atomic_char type;               // Asset Type
-    atomic_uint used;               // Asset Used 
+typedef struct asset_s {
+    unsigned char type;             // Asset Type
     unsigned char flag;             // Asset Flags
     unsigned int hash;              // Asset Hash
     unsigned int name_length;       // Asset Name Length (Faster Lookups)
     unsigned int archive_id;        // Archive ID
     unsigned int archive_offset;    // Archive Read Offset
     unsigned int archive_length;    // Archive Read Length
+    unsigned int resident;          // Decoded Size (Bytes)
+    unsigned int mip_count;         // Mip Levels (Registry Mutex, 0 = Level Table not read yet)
+    unsigned int* mip_ends;         // Mip Level End Offsets (Registry Mutex)
     char* name;                     // Asset Name
-    asset_metadata_u meta;          // Type Metadata
+    atomic_uchar meta_front;        // Metadata Slot in Use
+    asset_metadata_u meta[2];       // Type Metadata (Front & Back, see assets_meta())
 } asset_t;
 
+// Metadata of the current version of an asset. A reload decodes into the back slot
+// and swaps it in, so the returned pointer is valid until the end of the frame.
+static inline asset_metadata_u* assets_meta(asset_t* a) {
+    return &a->meta[atomic_load(&a->meta_front) & 1];
+}
+
+// Pixels of a sprite within its atlas page, rows are 'stride' pixels apart. Valid
+// as long as assets_state() reports the sprite as ASSET_STATE_DONE.
+static inline const unsigned int* assets_sprite_pixels(asset_t* a, unsigned int* stride) {
+    asset_metadata_sprite_t* sprite = &assets_meta(a)->sprite;
+    asset_metadata_image_t* page = &assets_meta(sprite->page)->image;
+    *stride = page->width;
+    return page->pixels + (size_t)sprite->y * page->width + sprite->x;
+}
+
+// References are written by every thread using the asset, each gets a cache line
+// of its own so neighbouring assets don't bounce the same line between cores.
+typedef struct {
+    atomic_uint used;               // Asset Used
+    atomic_uint last_used;          // Registry Clock when last Released
+    atomic_uint stale;              // Archive Entry changed since the Asset was read
+    atomic_uint traced;             // Asset was recorded into the Access Trace
+    atomic_uint mip_request;        // Finest Mip Level requested (ASSET_MIP_LIMIT = Coarsest)
+    atomic_uint mip_loaded;         // Finest Mip Level loaded
+    atomic_uint retry;              // Claimable from this Time on (Milliseconds, 0 = Now)
+} __attribute__((aligned(ASSET_CACHE_LINE_SIZE))) asset_ref_t;
+
+typedef struct {
+    atomic_ullong resident;         // Decoded Bytes in Memory
+    atomic_ullong peak;             // Highest Decoded Bytes in Memory
+    atomic_uint count;              // Assets in Memory
+    atomic_uint loads;              // Assets Decoded
+    atomic_uint evictions;          // Assets Evicted
+} asset_counter_t;
+
+typedef enum {
+    ASSET_ACCOUNT_LOAD = 1u,        // Asset was decoded
+    ASSET_ACCOUNT_EVICT = 2u,       // Asset was evicted
+    ASSET_ACCOUNT_RESIZE = 3u,      // Asset was reloaded, only its size changed
+} __attribute__((__packed__)) asset_account_t;
+
 typedef struct {
-    asset_t* assets;                // Registry Assets
+    unsigned long long resident;    // Decoded Bytes in Memory
+    unsigned long long peak;        // Highest Decoded Bytes in Memory
+    unsigned int count;             // Assets in Memory
+    unsigned int loads;             // Assets Decoded
+    unsigned int evictions;         // Assets Evicted
+} asset_stats_t;
+
+typedef struct {
+    asset_t* asset;                 // Traced Asset
+    unsigned int frame;             // Registry Clock at First Use
+    double time;                    // Seconds since Startup at First Use
+} asset_trace_t;
+
+typedef struct {
+    unsigned int index;             // Candidate Index (Registry may grow between Steps)
+    unsigned int last_used;         // Registry Clock when Sampled
+} asset_candidate_t;
+
+// Registry Layout:
+//   Hot arrays are scanned or written every frame (lookups, acquire/release, workers
+//   and the collector), the cold array is only touched once an asset was found.
+//   All arrays share the same index, asset handles point into the cold array.
+typedef struct {
+    atomic_char* states;            // (Hot) Asset States
+    unsigned char* types;           // (Hot) Asset Types
+    unsigned int* name_hashes;      // (Hot) Asset Name Checksums (Faster Lookups)
+    asset_ref_t* refs;              // (Hot) Asset References
+    void* refs_block;               // (Hot) Unaligned Allocation backing 'refs'
+    asset_t* assets;                // (Cold) Asset Records
     unsigned int size;              // Registry Size
     unsigned int capacity;          // Registry Capacity
+    bool_t sealed;                  // Handles were given out, the arrays can't move anymore
     pthread_mutex_t mtx;            // Registry Mutex
+    atomic_uint clock;              // Registry Clock (Ticks)
+    unsigned int* table;            // Lookup Table by Type and Name (Index + 1, 0 = Empty)
+    unsigned int table_mask;        // Lookup Table Capacity - 1
+    char* names[ASSET_ARCHIVE_LIMIT];   // Asset Names per Archive (One Allocation each)
+    unsigned int* entries[ASSET_ARCHIVE_LIMIT];     // Registry Index + 1 of every Manifest Entry per Archive (0 = Not Mounted)
+    unsigned int entry_counts[ASSET_ARCHIVE_LIMIT]; // Manifest Entries per Archive
+    char** names_retired;           // Asset Names of Archives before they were Reloaded
+    unsigned int names_retired_count;   // Asset Names Retired
+    asset_counter_t stats[ASSET_STATS_LIMIT]; // Memory Usage per Type (Slot 0 = All Types)
+    unsigned long long budget;      // Decoded Bytes Allowed in Memory (0 = Unlimited)
+    unsigned int collect_cursor;    // (Collector) Next Asset to Sample
+    unsigned int collect_count;     // (Collector) Candidate Count
+    unsigned long long collect_target; // (Collector) Resident Bytes to Evict down to
+    asset_candidate_t collect_candidates[ASSET_REGISTRY_COLLECT_CANDIDATES];
 } asset_registry_t;
 
 typedef struct {
@@ -101,42 +257,87 @@ static inline const char* asset_str_type(unsigned char type) {
     case ASSET_TYPE_MODEL:           return "MODEL";
     case ASSET_TYPE_SCENE:           return "SCENE";
     case ASSET_TYPE_SCRIPT:          return "SCRIPT";
+    case ASSET_TYPE_SPRITE:          return "SPRITE";
     default: return "N/A";
     }
 }
 
 // Preallocate Space for X more assets in the registry
 // - This function is not thread safe and assumes you have manually locked the mutex.
+// - Growing moves every array, so asset handles and the references that lock-free
+//   assets_acquire()/assets_release() touch would dangle. Only call this before any
+//   thread is started or handle given out, it fails once the registry is sealed.
 bool_t registry_unsafe_preallocate(asset_registry_t* r, unsigned int amount);
 
-// Open Archive and Parse it's contents, adding them to the registry. 
+// Open Archive and Parse it's contents, adding them to the registry. Entries sharing
+// a type and name with an already mounted entry replace it, so the last archive wins.
 // - This function is not thread safe and assumes you have manually locked the mutex.
 bool_t registry_unsafe_parse(asset_registry_t* r, const char* archive_path, const unsigned int archive_id);
 
-// Discard Asset Metadata from Memory
+// Re-read the manifest of a mounted archive that changed on disk. Entries whose
+// checksum changed are reloaded in the background while their old version stays usable.
+// - This function is not thread safe and assumes you have manually locked the mutex.
+bool_t registry_unsafe_reload(asset_registry_t* r, const char* archive_path, const unsigned int archive_id);
+
+// Discard Asset Metadata from Memory, anything the renderer may hold a handle to is
+// queued for release on the render thread. Returns FALSE if the release could not be
+// queued, in which case the metadata is left untouched.
 // - This function is not thread safe and assumes you have manually locked the mutex.
-void registry_unsafe_free_meta(asset_t* a);
+bool_t registry_unsafe_free_meta(asset_t* a);
+
+// Release memory held by Asset Metadata immediately. Only call this from the render
+// thread or once the render thread has exited.
+void registry_release_meta(const unsigned char type, asset_metadata_u* meta);
 
 // Discard Registry Contents from Memory
 void registry_free(asset_registry_t* r);
 
-// Releasing memory by freeing unused assets. This assumes that usage it's usage 
-// was properly tracked by the asset_acquire() and asset_release() functions.
-void registry_collect(asset_registry_t* r);
+// Incrementally evict the least recently used assets until at most 'target' bytes
+// are resident. Work is spread across calls, each call spends at most 'slice' seconds.
+void registry_collect_step(asset_registry_t* r, double slice, unsigned long long target);
 
 // Search for an asset using it's name and type. Ensure it is loaded by calling
 // assets_acquire() on it. 
 asset_t* assets_unsafe_find(const asset_type_t find_type, const char* find_name);
 
+// Current state of an asset, it is safe to use once ASSET_STATE_DONE. Sprites
+// are only done once their atlas page is done as well.
+asset_state_t assets_state(const asset_t* a);
+
+// Queue an asset for loading ahead of its use, without holding on to it. Workers pick
+// it up once nothing that was acquired is waiting, and the collector may evict it again.
+void assets_prefetch(asset_t* a);
+
+// [INTERNAL] Mark an asset ready once the render thread has uploaded it
+void assets_publish(asset_t* a);
+
+// [INTERNAL] Swap the reloaded version of an asset to the front, returning the
+// previous version which must be released once no frame in flight uses it anymore.
+asset_metadata_u assets_unsafe_swap(asset_t* a);
+
 // Mark the asset as required. Ensure that it's state is ASSET_STATE_READY 
 // before use. Additionally it cannot garbage collected until assets_release() 
 // is called on it
 void assets_acquire(asset_t* a);
 
+// Acquire an image but only load its mip levels down to 'level', coarser levels are
+// always loaded too. Asking for a finer level later loads it while the coarser version
+// stays in use. Images without mipmaps are loaded in full, see assets_acquire().
+void assets_acquire_level(asset_t* a, unsigned int level);
+
+// Acquire a set of assets at once, see assets_acquire(). Workers are woken once for
+// the whole set and read payloads which sit next to each other in a single pass.
+// NULL entries are skipped, so the results of assets_unsafe_find() can be passed as is.
+void assets_acquire_batch(asset_t** assets, unsigned int count);
+
 // Mark the asset as no longer needed, if no other instance is using this it
 // can be garbage collected in the future.
 void assets_release(asset_t* a);
 
+// Snapshot memory usage for an asset type, or for all types using ASSET_STATS_TOTAL.
+// Returns FALSE if the type is unknown.
+bool_t assets_stats(const unsigned char type, asset_stats_t* out);
+
 // [INTERNAL] Thread which handles asset decoding
 void* engine_assets_worker(void* data);
 
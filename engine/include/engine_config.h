@@ -1,3 +1,4 @@
+#include <stddef.h>
 #pragma once
 
 // Special Boolean Type to protect against WINAPI conflicts
@@ -6,22 +7,61 @@ typedef unsigned char bool_t;
 #define FALSE 0
 
 #define ASSET_WORKER_LIMIT      8
+#define ASSET_ARCHIVE_LIMIT     32
+#define ASSET_ARCHIVE_DEFAULT   "assets.yuri"
 #define ASSET_CACHE_LINE_SIZE   64    
 
+#define ENGINE_TICK_RATE        60    // Default Simulation Rate (Hz)
+#define ENGINE_TICK_LIMIT       5     // Maximum Simulation Ticks per Frame
+#define ENGINE_FRAME_RATE       60    // Default Render Rate (Hz, 0 = Uncapped)
+#define ENGINE_FRAME_LIMIT      0.25  // Maximum Frame Time (Seconds)
+#define ENGINE_SCRIPT_GC_BUDGET 500   // Default Script Collection Time per Frame (Microseconds, 0 = Automatic)
+
+typedef enum {
+    RENDER_TARGET_WINDOW = 0u,      // Present to a Desktop Window
+    RENDER_TARGET_SHM = 1u,         // Present to a Shared Memory Ring (Headless)
+    RENDER_TARGET_QOI = 2u,         // Periodically write QOI Images (Headless)
+} __attribute__((__packed__)) render_target_t;
+
 typedef struct {
-    bool_t logger_console;      // Console Enabled?
-    int asset_threads;          // Asset Thread Count
-    int render_height;          // Render Window Height
-    int render_width;           // Render Window Width
-    bool_t render_fullscreen;   // Render Window Fullscreen?
+    bool_t logger_console;              // Console Enabled?
+    int asset_threads;                  // Asset Thread Count
+    int asset_budget;                   // Asset Memory Budget (Megabytes, 0 = Unlimited)
+    bool_t asset_hot_reload;            // Reload Archives when they change on Disk?
+    int asset_archive_count;            // Asset Archive Count (0 = ASSET_ARCHIVE_DEFAULT)
+    const char* asset_archives[ASSET_ARCHIVE_LIMIT]; // Asset Archives (Later ones shadow Earlier ones)
+    const char* asset_trace;            // Asset Access Trace (Replayed at Startup, Recorded at Exit)
+    int render_height;                  // Render Window Height
+    int render_width;                   // Render Window Width
+    bool_t render_fullscreen;           // Render Window Fullscreen?
+    int render_threads;                 // Render Thread Count (0 = All Cores)
+    render_target_t render_target;      // Render Present Target
+    const char* render_capture_path;    // Headless Output (Shared Memory Name or Directory)
+    int render_capture_interval;        // Headless Frames between Captures (QOI)
+    int render_frame_limit;             // Exit after X Frames (0 = Unlimited)
+    int engine_tick_rate;               // Simulation Rate (Hz)
+    int engine_frame_rate;              // Render Rate (Hz, 0 = Uncapped)
+    int script_gc_budget;               // Script Collection Time per Frame (Microseconds, 0 = Automatic)
 } engine_config_t;
 
-static inline engine_config_t engine_config_init() {
+static inline engine_config_t engine_config_init(void) {
     return (engine_config_t) {
         .logger_console = FALSE,
             .asset_threads = 2,
+            .asset_budget = 512,
+            .asset_hot_reload = FALSE,
+            .asset_archive_count = 0,
+            .asset_trace = NULL,
             .render_height = 0,
             .render_width = 0,
-            .render_fullscreen = FALSE
+            .render_fullscreen = FALSE,
+            .render_threads = 0,
+            .render_target = RENDER_TARGET_WINDOW,
+            .render_capture_path = NULL,
+            .render_capture_interval = 60,
+            .render_frame_limit = 0,
+            .engine_tick_rate = ENGINE_TICK_RATE,
+            .engine_frame_rate = ENGINE_FRAME_RATE,
+            .script_gc_budget = ENGINE_SCRIPT_GC_BUDGET
     };
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ typedef enum {
 #define OAUDIO  "AUDIO"
 #define ORENDER "RENDER"
 #define OLOGGER "LOGGER"
+#define OSCRIPT "SCRIPT"
 
 static inline const char* logger_str_severity(const debug_level_t severity) {
     switch (severity) {
@@ -33,4 +34,4 @@ void logger(const unsigned char severity, const char* origin, const char* fmt, .
 
 bool_t engine_logger_init(const engine_config_t* config);
 bool_t engine_logger_tick(float delta);
-void engine_logger_exit();
\ No newline at end of file
+void engine_logger_exit(void);
\ No newline at end of file
@@ -1,9 +1,57 @@
 #include <engine_config.h>
+#include <render_raster.h>
+#include <engine_assets.h>
 #pragma once
 
-#define RENDER_DELAY 1000 / 60
-#define RENDER_TITLE "KUMA"
+#define RENDER_TITLE            "KUMA"
+#define RENDER_CLEAR            0x00000000
+#define RENDER_COMMAND_LIMIT    1024    // Command Ring Capacity (Power of Two)
+#define RENDER_COMMAND_BUDGET   0.002   // Command Processing Time per Frame (Seconds)
+#define RENDER_RETIRE_FRAMES    2       // Frames a swapped out or evicted Asset Version stays alive
+
+typedef enum {
+    RENDER_COMMAND_UPLOAD = 1u,     // Asset was decoded and awaits upload
+    RENDER_COMMAND_RELEASE = 2u,    // Asset was evicted and its resources should be freed
+    RENDER_COMMAND_SWAP = 3u,       // Asset was reloaded and its new version replaces the old one
+} __attribute__((__packed__)) render_command_type_t;
+
+typedef struct {
+    render_command_type_t type;     // Command Type
+    unsigned char asset_type;       // Asset Type
+    asset_t* asset;                 // (Upload & Swap) Asset awaiting Upload
+    asset_metadata_u meta;          // (Release) Metadata detached from the Asset
+} render_command_t;
+
+// Linearly blend between the previous and current simulation state
+static inline float render_lerp(float previous, float current, float alpha) {
+    return previous + (current - previous) * alpha;
+}
+
+// Set how far (0..1) the rendered frame is between the last two simulation ticks
+void render_set_alpha(float alpha);
+
+// Get how far (0..1) the rendered frame is between the last two simulation ticks,
+// use this with render_lerp() to smooth out movement between simulation ticks
+float render_get_alpha(void);
+
+// Queue a triangle for the next frame, positions are in normalized device coordinates
+void render_draw_triangle(const raster_vertex_t v[3]);
+
+// Queue a sprite (0xAARRGGBB, premultiplied) for the next frame, the pixels must stay valid
+// until the frame has been drawn by the render thread (one frame after submission)
+void render_draw_sprite(const raster_sprite_t* sprite);
+
+// Queue a command for the render thread, safe to call from any thread.
+// Returns FALSE if the command ring is full.
+bool_t render_command_push(const render_command_t* command);
+
+// Queue a command for the render thread, blocking while the command ring is full.
+// Returns FALSE if the render thread stopped before there was room.
+bool_t render_command_push_wait(const render_command_t* command);
+
+// [INTERNAL] Thread which draws and presents submitted frame packets
+void* engine_render_thread(void* data);
 
 bool_t engine_render_init(const engine_config_t* config);
 bool_t engine_render_tick(float delta);
-void engine_render_exit();
\ No newline at end of file
+void engine_render_exit(void);
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <engine_config.h>
+#include <engine_assets.h>
+#include <lua.h>
+#pragma once
+
+#define SCRIPT_ENTRYPOINT   "/scripts/entrypoint"   // Script run once it has loaded
+#define SCRIPT_UPDATE       "update"                // Global called every Simulation Tick with the Tick Step
+#define SCRIPT_GC_PAUSE     200                     // Start a Collection once the Heap grew to X% of what the last one left
+#define SCRIPT_GC_MINIMUM   1024                    // Smallest Heap that starts a Collection (Kilobytes)
+#define SCRIPT_GC_BEHIND    4                       // Finish a Collection at once when the Heap outgrew the Threshold X Times
+#define SCRIPT_GC_STEP_SIZE 6                       // Work done per Collection Step while on a Budget (Log2 Bytes, Lua defaults to 13)
+#define SCRIPT_NAME_LIMIT   256                     // Chunk Name Length
+
+// Push the chunk of a loaded script asset (ASSET_STATE_DONE) onto the stack without
+// running it. Bytecode is only accepted from assets flagged as such, so a source file
+// can't smuggle in a binary chunk. Returns the lua_load() status, on failure the error
+// message is pushed instead.
+int script_load(lua_State* L, asset_t* a);
+
+bool_t engine_script_init(const engine_config_t* config);
+
+// Runs the entrypoint once loaded and calls update(), from the fixed rate simulation loop
+bool_t engine_script_tick(float delta);
+
+// Spends the collection budget, once per rendered frame
+bool_t engine_script_frame(float delta);
+void engine_script_exit(void);
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include <engine_config.h>
+#pragma once
+
+// Memory Pressure Levels, each level asks the registry to give back more memory
+typedef enum {
+    MEMORY_LEVEL_NONE = 0u,         // Plenty of Memory
+    MEMORY_LEVEL_LOW = 1u,          // Shed some unused Assets
+    MEMORY_LEVEL_MEDIUM = 2u,       // Shed most unused Assets
+    MEMORY_LEVEL_CRITICAL = 3u,     // Shed every unused Asset
+} __attribute__((__packed__)) memory_level_t;
+
+#define MEMORY_LEVEL_LOW_LIMIT          75  // Memory Usage (Percent)
+#define MEMORY_LEVEL_MEDIUM_LIMIT       85  // Memory Usage (Percent)
+#define MEMORY_LEVEL_CRITICAL_LIMIT     95  // Memory Usage (Percent)
+
+static inline memory_level_t memory_level_from_load(unsigned int load) {
+    if (load >= MEMORY_LEVEL_CRITICAL_LIMIT) return MEMORY_LEVEL_CRITICAL;
+    if (load >= MEMORY_LEVEL_MEDIUM_LIMIT)   return MEMORY_LEVEL_MEDIUM;
+    if (load >= MEMORY_LEVEL_LOW_LIMIT)      return MEMORY_LEVEL_LOW;
+    return MEMORY_LEVEL_NONE;
+}
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sysinfoapi.h>
+
+typedef struct {
+    int unused;
+} memory_probe_t;
+
+static inline void memory_probe_init(memory_probe_t* p) {
+    (void)p;
+}
+
+// Stalls are not reported on this platform
+static inline memory_level_t memory_probe_stall(memory_probe_t* p) {
+    (void)p;
+    return MEMORY_LEVEL_NONE;
+}
+
+static inline memory_level_t memory_probe_usage(memory_probe_t* p) {
+    (void)p;
+    MEMORYSTATUSEX state = { .dwLength = sizeof(MEMORYSTATUSEX) };
+    if (!GlobalMemoryStatusEx(&state)) {
+        return MEMORY_LEVEL_NONE;
+    }
+    return memory_level_from_load((unsigned int)state.dwMemoryLoad);
+}
+
+static inline void memory_probe_exit(memory_probe_t* p) {
+    (void)p;
+}
+
+#else
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// Stall Triggers: Report when tasks were stalled on memory for X microseconds
+// within a window. Unprivileged triggers need a window that is a multiple of 2s.
+#define MEMORY_PSI_SOME_TRIGGER         "some 150000 2000000"
+#define MEMORY_PSI_FULL_TRIGGER         "full 100000 2000000"
+#define MEMORY_CGROUP_ROOT              "/sys/fs/cgroup"
+
+typedef struct {
+    int psi_some;                   // Pressure Stall Trigger (Some Tasks Stalled)
+    int psi_full;                   // Pressure Stall Trigger (All Tasks Stalled)
+    char cgroup[512];               // Control Group Directory (Empty if Unavailable)
+} memory_probe_t;
+
+static inline bool_t memory_read_value(const char* path, unsigned long long* value) {
+    char line[64];
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return FALSE;
+    }
+    bool_t ok = fgets(line, sizeof(line), f) != NULL;
+    fclose(f);
+    // Unlimited groups report "max"
+    if (!ok || strncmp(line, "max", 3) == 0) {
+        return FALSE;
+    }
+    *value = strtoull(line, NULL, 10);
+    return TRUE;
+}
+
+static inline int memory_psi_open(const char* path, const char* trigger) {
+    int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (write(fd, trigger, strlen(trigger) + 1) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Locate the cgroup v2 directory of this process and register stall triggers,
+// preferring the cgroup's own pressure file over the system wide one.
+static inline void memory_probe_init(memory_probe_t* p) {
+    memset(p, 0, sizeof(memory_probe_t));
+    p->psi_some = -1;
+    p->psi_full = -1;
+
+    char line[512];
+    FILE* f = fopen("/proc/self/cgroup", "r");
+    if (f != NULL) {
+        while (fgets(line, sizeof(line), f)) {
+            if (strncmp(line, "0::", 3) != 0) {
+                continue;
+            }
+            line[strcspn(line, "\n")] = '\0';
+            const char* group = line + 3;
+            const char* roots[] = { MEMORY_CGROUP_ROOT, MEMORY_CGROUP_ROOT "/unified" };
+            for (unsigned int i = 0; i < sizeof(roots) / sizeof(roots[0]); i++) {
+                char path[1024];
+                snprintf(path, sizeof(path), "%s%s/memory.current", roots[i], group);
+                if (access(path, R_OK) != 0) {
+                    continue;
+                }
+                int length = snprintf(p->cgroup, sizeof(p->cgroup), "%s%s", roots[i], strcmp(group, "/") ? group : "");
+                if (length < 0 || (size_t)length >= sizeof(p->cgroup)) {
+                    p->cgroup[0] = '\0';
+                }
+                break;
+            }
+            break;
+        }
+        fclose(f);
+    }
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/memory.pressure", p->cgroup);
+    if (p->cgroup[0] == '\0' || access(path, R_OK) != 0) {
+        snprintf(path, sizeof(path), "/proc/pressure/memory");
+    }
+    p->psi_some = memory_psi_open(path, MEMORY_PSI_SOME_TRIGGER);
+    p->psi_full = memory_psi_open(path, MEMORY_PSI_FULL_TRIGGER);
+}
+
+// Check if a stall trigger fired since the last call, never blocks
+static inline memory_level_t memory_probe_stall(memory_probe_t* p) {
+    struct pollfd fds[2] = {
+        { .fd = p->psi_some, .events = POLLPRI },
+        { .fd = p->psi_full, .events = POLLPRI },
+    };
+    if (poll(fds, 2, 0) <= 0) {
+        return MEMORY_LEVEL_NONE;
+    }
+    if (fds[1].revents & POLLPRI) return MEMORY_LEVEL_CRITICAL;
+    if (fds[0].revents & POLLPRI) return MEMORY_LEVEL_MEDIUM;
+    return MEMORY_LEVEL_NONE;
+}
+
+// Usage of the cgroup limit, otherwise of the system memory
+static inline memory_level_t memory_probe_usage(memory_probe_t* p) {
+    unsigned long long current = 0, limit = 0;
+    if (p->cgroup[0] != '\0') {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/memory.current", p->cgroup);
+        bool_t has_current = memory_read_value(path, &current);
+        snprintf(path, sizeof(path), "%s/memory.max", p->cgroup);
+        if (has_current && memory_read_value(path, &limit) && limit > 0) {
+            return memory_level_from_load((unsigned int)(current * 100 / limit));
+        }
+    }
+
+    char line[128];
+    unsigned long long total = 0, available = 0;
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (f == NULL) {
+        return MEMORY_LEVEL_NONE;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, "MemTotal:", 9))     total = strtoull(line + 9, NULL, 10);
+        if (!strncmp(line, "MemAvailable:", 13)) available = strtoull(line + 13, NULL, 10);
+    }
+    fclose(f);
+    if (total == 0 || available > total) {
+        return MEMORY_LEVEL_NONE;
+    }
+    return memory_level_from_load((unsigned int)((total - available) * 100 / total));
+}
+
+static inline void memory_probe_exit(memory_probe_t* p) {
+    if (p->psi_some >= 0) close(p->psi_some);
+    if (p->psi_full >= 0) close(p->psi_full);
+    p->psi_some = -1;
+    p->psi_full = -1;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,391 @@
+#include <engine_config.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#pragma once
+
+// Asynchronous positional reads. Requests are submitted and completed by a single
+// thread while many of them are in flight at once. Uses io_uring where the kernel
+// allows it, otherwise a small pool of threads issuing blocking reads.
+
+#define READ_POOL_THREADS       4       // Fallback Reader Threads
+
+typedef enum {
+    READ_HINT_WILLNEED = 0u,            // Range is read soon, start fetching it
+    READ_HINT_DONTNEED = 1u,            // Range isn't needed anymore, drop it from the cache
+} __attribute__((__packed__)) read_hint_t;
+
+typedef struct read_request_s {
+    int fd;                             // File Descriptor
+    unsigned char* buffer;              // Destination
+    unsigned int length;                // Bytes to Read
+    unsigned long long offset;          // File Offset
+    unsigned int done;                  // Bytes Read (Less than 'length' on EOF or Error)
+    int error;                          // Error Code of a failed Read (0 = None)
+    void* user;                         // Caller Data
+    struct read_request_s* next;        // (Pool) Queue Link
+} read_request_t;
+
+#ifdef _WIN32
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+
+static inline int read_open(const char* path) {
+    return _open(path, _O_RDONLY | _O_BINARY);
+}
+
+static inline void read_close(int fd) {
+    _close(fd);
+}
+
+// Page cache hints are not implemented on this platform
+static inline void read_hint(int fd, unsigned long long offset, unsigned long long length, read_hint_t hint) {
+    (void)fd;
+    (void)offset;
+    (void)length;
+    (void)hint;
+}
+
+// Blocking read at an offset, without moving a shared file position
+static inline long long read_at(int fd, void* buffer, unsigned int length, unsigned long long offset) {
+    OVERLAPPED position = { 0 };
+    position.Offset = (DWORD)(offset & 0xFFFFFFFF);
+    position.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD received = 0;
+    if (!ReadFile((HANDLE)_get_osfhandle(fd), buffer, length, &received, &position)) {
+        if (GetLastError() == ERROR_HANDLE_EOF) {
+            return 0;
+        }
+        errno = EIO;
+        return -1;
+    }
+    return received;
+}
+
+#else
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static inline int read_open(const char* path) {
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static inline void read_close(int fd) {
+    close(fd);
+}
+
+static inline long long read_at(int fd, void* buffer, unsigned int length, unsigned long long offset) {
+    return pread(fd, buffer, length, (off_t)offset);
+}
+
+// Advise the page cache about a file range, purely a hint so errors are ignored
+static inline void read_hint(int fd, unsigned long long offset, unsigned long long length, read_hint_t hint) {
+    posix_fadvise(fd, (off_t)offset, (off_t)length,
+        hint == READ_HINT_WILLNEED ? POSIX_FADV_WILLNEED : POSIX_FADV_DONTNEED);
+}
+
+#endif
+
+typedef struct {
+    bool_t uring;                       // Using io_uring? (Otherwise the Thread Pool)
+    unsigned int depth;                 // Requests allowed in Flight
+    unsigned int inflight;              // Requests in Flight
+#ifndef _WIN32
+    int ring_fd;                        // (io_uring) Ring Handle
+    void* sq_map;                       // (io_uring) Submission Ring Mapping
+    size_t sq_map_size;                 // (io_uring) Submission Ring Mapping Size
+    void* cq_map;                       // (io_uring) Completion Ring Mapping (May equal 'sq_map')
+    size_t cq_map_size;                 // (io_uring) Completion Ring Mapping Size
+    struct io_uring_sqe* sqes;          // (io_uring) Submission Entries
+    size_t sqes_size;                   // (io_uring) Submission Entries Size
+    atomic_uint* sq_tail;               // (io_uring) Submission Tail (Written by us)
+    unsigned int sq_mask;               // (io_uring) Submission Ring Mask
+    unsigned int* sq_array;             // (io_uring) Submission Index Array
+    atomic_uint* cq_head;               // (io_uring) Completion Head (Written by us)
+    atomic_uint* cq_tail;               // (io_uring) Completion Tail (Written by the Kernel)
+    unsigned int cq_mask;               // (io_uring) Completion Ring Mask
+    struct io_uring_cqe* cqes;          // (io_uring) Completion Entries
+#endif
+    bool_t running;                     // (Pool) Threads Running?
+    unsigned int thread_count;          // (Pool) Threads Started
+    pthread_t threads[READ_POOL_THREADS];   // (Pool) Threads
+    pthread_mutex_t mtx;                // (Pool) Queue Mutex
+    pthread_cond_t submitted;           // (Pool) Signalled when a Request was Queued
+    pthread_cond_t completed;           // (Pool) Signalled when a Request was Finished
+    read_request_t* pending;            // (Pool) Queued Requests (Head)
+    read_request_t* pending_last;       // (Pool) Queued Requests (Tail)
+    read_request_t* finished;           // (Pool) Finished Requests
+} read_engine_t;
+
+// Read until the request is complete, the file ends or fails
+static inline void read_request_run(read_request_t* r) {
+    while (r->done < r->length) {
+        long long received = read_at(r->fd, r->buffer + r->done, r->length - r->done, r->offset + r->done);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0) {
+            r->error = errno;
+            return;
+        }
+        if (received == 0) {
+            return;
+        }
+        r->done += (unsigned int)received;
+    }
+}
+
+static inline void* read_pool_thread(void* data) {
+    read_engine_t* e = (read_engine_t*)data;
+    pthread_mutex_lock(&e->mtx);
+    while (TRUE) {
+        while (e->running && e->pending == NULL) {
+            pthread_cond_wait(&e->submitted, &e->mtx);
+        }
+        if (e->pending == NULL) {
+            break;
+        }
+        read_request_t* r = e->pending;
+        e->pending = r->next;
+        pthread_mutex_unlock(&e->mtx);
+
+        read_request_run(r);
+
+        pthread_mutex_lock(&e->mtx);
+        r->next = e->finished;
+        e->finished = r;
+        pthread_cond_signal(&e->completed);
+    }
+    pthread_mutex_unlock(&e->mtx);
+    return NULL;
+}
+
+#ifndef _WIN32
+static inline bool_t read_uring_init(read_engine_t* e) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, e->depth, &params);
+    if (fd < 0) {
+        return FALSE;
+    }
+    // Plain reads need 5.6, the same release added IORING_FEAT_RW_CUR_POS
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close(fd);
+        return FALSE;
+    }
+
+    e->ring_fd = fd;
+    e->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    e->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    e->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (e->cq_map_size > e->sq_map_size) e->sq_map_size = e->cq_map_size;
+        e->cq_map_size = e->sq_map_size;
+    }
+    e->sq_map = mmap(NULL, e->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (e->sq_map == MAP_FAILED) {
+        close(fd);
+        return FALSE;
+    }
+    e->cq_map = e->sq_map;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        e->cq_map = mmap(NULL, e->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (e->cq_map == MAP_FAILED) {
+            munmap(e->sq_map, e->sq_map_size);
+            close(fd);
+            return FALSE;
+        }
+    }
+    e->sqes = mmap(NULL, e->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (e->sqes == MAP_FAILED) {
+        if (e->cq_map != e->sq_map) munmap(e->cq_map, e->cq_map_size);
+        munmap(e->sq_map, e->sq_map_size);
+        close(fd);
+        return FALSE;
+    }
+
+    unsigned char* sq = (unsigned char*)e->sq_map;
+    unsigned char* cq = (unsigned char*)e->cq_map;
+    e->sq_tail = (atomic_uint*)(sq + params.sq_off.tail);
+    e->sq_mask = *(unsigned int*)(sq + params.sq_off.ring_mask);
+    e->sq_array = (unsigned int*)(sq + params.sq_off.array);
+    e->cq_head = (atomic_uint*)(cq + params.cq_off.head);
+    e->cq_tail = (atomic_uint*)(cq + params.cq_off.tail);
+    e->cq_mask = *(unsigned int*)(cq + params.cq_off.ring_mask);
+    e->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    if (params.sq_entries < e->depth) e->depth = params.sq_entries;
+    e->uring = TRUE;
+    return TRUE;
+}
+
+static inline int read_uring_enter(read_engine_t* e, unsigned int submit, unsigned int wait) {
+    while (TRUE) {
+        int result = (int)syscall(__NR_io_uring_enter, e->ring_fd, submit, wait,
+            wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (result >= 0 || errno != EINTR) {
+            return result;
+        }
+    }
+}
+
+// Queue the unread remainder of a request
+static inline bool_t read_uring_push(read_engine_t* e, read_request_t* r) {
+    unsigned int tail = atomic_load_explicit(e->sq_tail, memory_order_relaxed);
+    unsigned int index = tail & e->sq_mask;
+    struct io_uring_sqe* sqe = &e->sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = r->fd;
+    sqe->addr = (unsigned long long)(uintptr_t)(r->buffer + r->done);
+    sqe->len = r->length - r->done;
+    sqe->off = r->offset + r->done;
+    sqe->user_data = (unsigned long long)(uintptr_t)r;
+    e->sq_array[index] = index;
+    atomic_store_explicit(e->sq_tail, tail + 1, memory_order_release);
+    if (read_uring_enter(e, 1, 0) != 1) {
+        // Nothing was consumed, the kernel only looks at the ring while entered
+        atomic_store_explicit(e->sq_tail, tail, memory_order_release);
+        return FALSE;
+    }
+    return TRUE;
+}
+#endif
+
+// Prepare for up to 'depth' reads in flight, returns FALSE if neither io_uring nor
+// the fallback threads are available
+static inline bool_t read_engine_init(read_engine_t* e, unsigned int depth) {
+    memset(e, 0, sizeof(read_engine_t));
+    e->depth = depth;
+#ifndef _WIN32
+    e->ring_fd = -1;
+    if (read_uring_init(e)) {
+        return TRUE;
+    }
+#endif
+    pthread_mutex_init(&e->mtx, NULL);
+    pthread_cond_init(&e->submitted, NULL);
+    pthread_cond_init(&e->completed, NULL);
+    e->running = TRUE;
+    for (unsigned int i = 0; i < READ_POOL_THREADS; i++) {
+        if (pthread_create(&e->threads[i], NULL, read_pool_thread, e) != 0) {
+            break;
+        }
+        e->thread_count++;
+    }
+    return e->thread_count > 0;
+}
+
+// Start reading, returns FALSE if the queue is full or the read could not be issued
+static inline bool_t read_engine_submit(read_engine_t* e, read_request_t* r) {
+    if (e->inflight >= e->depth) {
+        return FALSE;
+    }
+    r->done = 0;
+    r->error = 0;
+    r->next = NULL;
+#ifndef _WIN32
+    if (e->uring) {
+        if (!read_uring_push(e, r)) {
+            return FALSE;
+        }
+        e->inflight++;
+        return TRUE;
+    }
+#endif
+    pthread_mutex_lock(&e->mtx);
+    if (e->pending) {
+        e->pending_last->next = r;
+    }
+    else {
+        e->pending = r;
+    }
+    e->pending_last = r;
+    pthread_cond_signal(&e->submitted);
+    pthread_mutex_unlock(&e->mtx);
+    e->inflight++;
+    return TRUE;
+}
+
+// Return a finished request, or NULL if none finished yet. With 'wait' set this blocks
+// until one finishes, unless nothing is in flight.
+static inline read_request_t* read_engine_complete(read_engine_t* e, bool_t wait) {
+    if (e->inflight == 0) {
+        return NULL;
+    }
+#ifndef _WIN32
+    if (e->uring) {
+        while (TRUE) {
+            unsigned int head = atomic_load_explicit(e->cq_head, memory_order_relaxed);
+            if (head == atomic_load_explicit(e->cq_tail, memory_order_acquire)) {
+                if (!wait || read_uring_enter(e, 0, 1) < 0) {
+                    return NULL;
+                }
+                continue;
+            }
+            struct io_uring_cqe* cqe = &e->cqes[head & e->cq_mask];
+            read_request_t* r = (read_request_t*)(uintptr_t)cqe->user_data;
+            int result = cqe->res;
+            atomic_store_explicit(e->cq_head, head + 1, memory_order_release);
+
+            // Short reads are continued, the request stays in flight
+            if (result > 0) {
+                r->done += (unsigned int)result;
+                if (r->done < r->length) {
+                    if (read_uring_push(e, r)) {
+                        continue;
+                    }
+                    r->error = errno;
+                }
+            }
+            else if (result < 0) {
+                r->error = -result;
+            }
+            e->inflight--;
+            return r;
+        }
+    }
+#endif
+    pthread_mutex_lock(&e->mtx);
+    while (wait && e->finished == NULL) {
+        pthread_cond_wait(&e->completed, &e->mtx);
+    }
+    read_request_t* r = e->finished;
+    if (r) {
+        e->finished = r->next;
+        e->inflight--;
+    }
+    pthread_mutex_unlock(&e->mtx);
+    return r;
+}
+
+// Release the engine, anything still in flight must have been completed beforehand
+static inline void read_engine_exit(read_engine_t* e) {
+#ifndef _WIN32
+    if (e->uring) {
+        munmap(e->sqes, e->sqes_size);
+        if (e->cq_map != e->sq_map) munmap(e->cq_map, e->cq_map_size);
+        munmap(e->sq_map, e->sq_map_size);
+        close(e->ring_fd);
+        e->ring_fd = -1;
+        e->uring = FALSE;
+        return;
+    }
+#endif
+    pthread_mutex_lock(&e->mtx);
+    e->running = FALSE;
+    pthread_cond_broadcast(&e->submitted);
+    pthread_mutex_unlock(&e->mtx);
+    for (unsigned int i = 0; i < e->thread_count; i++) {
+        pthread_join(e->threads[i], NULL);
+    }
+    e->thread_count = 0;
+    pthread_mutex_destroy(&e->mtx);
+    pthread_cond_destroy(&e->submitted);
+    pthread_cond_destroy(&e->completed);
+}
\ No newline at end of file
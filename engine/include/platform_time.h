@@ -12,6 +12,53 @@ static inline void time_get(unsigned int* h, unsigned int* m, unsigned int* s, u
     *ms = (unsigned int)t.wMilliseconds;
 }
 
+// Seconds elapsed on a monotonic clock, only useful for measuring intervals
+static inline double time_monotonic(void) {
+    static LARGE_INTEGER freq = { 0 };
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0) {
+        QueryPerformanceFrequency(&freq);
+    }
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+}
+
+// Yield the calling thread for (roughly) the requested amount of seconds
+static inline void time_sleep(double secs) {
+    DWORD sleep_ms = (DWORD)(secs * 1000.0);
+    if (sleep_ms > 0) {
+        Sleep(sleep_ms);
+    }
+}
+
 #else
-#error "Platform Time Not Implemented"
+#include <time.h>
+
+static inline void time_get(unsigned int* h, unsigned int* m, unsigned int* s, unsigned int* ms) {
+    struct timespec ts;
+    struct tm t;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    localtime_r(&ts.tv_sec, &t);
+    *h = (unsigned int)t.tm_hour;
+    *m = (unsigned int)t.tm_min;
+    *s = (unsigned int)t.tm_sec;
+    *ms = (unsigned int)(ts.tv_nsec / 1000000);
+}
+
+// Seconds elapsed on a monotonic clock, only useful for measuring intervals
+static inline double time_monotonic(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Yield the calling thread for (roughly) the requested amount of seconds
+static inline void time_sleep(double secs) {
+    struct timespec ts = {
+        .tv_sec = (time_t)secs,
+        .tv_nsec = (long)((secs - (double)(time_t)secs) * 1e9),
+    };
+    nanosleep(&ts, NULL);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include <engine_config.h>
+#pragma once
+
+// Notifies about files which were rewritten or replaced, the directory of each file
+// is watched so that tools writing a temporary file and renaming it are noticed too.
+
+#define WATCH_LIMIT             32      // Maximum Watched Files
+
+#ifdef _WIN32
+
+typedef struct {
+    int unused;
+} watch_t;
+
+// File notifications are not implemented on this platform
+static inline bool_t watch_init(watch_t* w) {
+    (void)w;
+    return FALSE;
+}
+
+static inline bool_t watch_add(watch_t* w, const char* path, int id) {
+    (void)w;
+    (void)path;
+    (void)id;
+    return FALSE;
+}
+
+static inline int watch_poll(watch_t* w) {
+    (void)w;
+    return -1;
+}
+
+static inline void watch_exit(watch_t* w) {
+    (void)w;
+}
+
+#else
+#include <sys/inotify.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+typedef struct {
+    int fd;                                     // Notification Handle
+    unsigned int count;                         // Watched Files
+    int descriptors[WATCH_LIMIT];               // Watched Directory
+    int ids[WATCH_LIMIT];                       // Caller provided ID
+    const char* names[WATCH_LIMIT];             // File Name within Directory
+    unsigned int buffer_length;                 // Unprocessed Event Bytes
+    unsigned int buffer_offset;                 // Next Event in Buffer
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+} watch_t;
+
+static inline bool_t watch_init(watch_t* w) {
+    memset(w, 0, sizeof(watch_t));
+    w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    return w->fd >= 0;
+}
+
+// Watch a file, 'path' must stay valid while it is being watched
+static inline bool_t watch_add(watch_t* w, const char* path, int id) {
+    if (w->count >= WATCH_LIMIT) {
+        return FALSE;
+    }
+    char directory[1024];
+    const char* slash = strrchr(path, '/');
+    const char* name = slash ? slash + 1 : path;
+    size_t length = slash ? (size_t)(slash - path) : 0;
+    if (length >= sizeof(directory)) {
+        return FALSE;
+    }
+    if (slash == NULL) {
+        strcpy(directory, ".");
+    }
+    else if (length == 0) {
+        strcpy(directory, "/");
+    }
+    else {
+        memcpy(directory, path, length);
+        directory[length] = '\0';
+    }
+    int descriptor = inotify_add_watch(w->fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (descriptor < 0) {
+        return FALSE;
+    }
+    w->descriptors[w->count] = descriptor;
+    w->ids[w->count] = id;
+    w->names[w->count] = name;
+    w->count++;
+    return TRUE;
+}
+
+// Returns the ID of a file that changed, or -1 once there are no more changes.
+// Never blocks, call it until it returns -1.
+static inline int watch_poll(watch_t* w) {
+    while (TRUE) {
+        if (w->buffer_offset >= w->buffer_length) {
+            ssize_t length = read(w->fd, w->buffer, sizeof(w->buffer));
+            if (length <= 0) {
+                return -1;
+            }
+            w->buffer_length = (unsigned int)length;
+            w->buffer_offset = 0;
+        }
+        const struct inotify_event* event = (const struct inotify_event*)(w->buffer + w->buffer_offset);
+        w->buffer_offset += sizeof(struct inotify_event) + event->len;
+        if (event->len == 0) {
+            continue;
+        }
+        for (unsigned int i = 0; i < w->count; i++) {
+            if (w->descriptors[i] == event->wd && !strcmp(w->names[i], event->name)) {
+                return w->ids[i];
+            }
+        }
+    }
+}
+
+static inline void watch_exit(watch_t* w) {
+    if (w->fd >= 0) {
+        close(w->fd);
+    }
+    w->fd = -1;
+    w->count = 0;
+}
+
+#endif
\ No newline at end of file
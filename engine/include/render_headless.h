@@ -0,0 +1,41 @@
+#include <engine_config.h>
+#include <stdatomic.h>
+#pragma once
+
+#define HEADLESS_SHM_NAME       "/kuma-frames"
+#define HEADLESS_SHM_SLOTS      3
+#define HEADLESS_QOI_PATH       "."
+
+static const unsigned int MAGIC_HEADLESS = ('K') | ('U' << 8) | ('M' << 16) | ('A' << 24);
+
+// Shared Memory Layout:
+//   headless_shm_header_t
+//   headless_shm_slot_t + (pixel_capacity * uint32) pixels   (repeated for each slot)
+//
+// Frames are written round-robin into the slots. A slot sequence is odd while it is
+// being written, readers should copy the pixels and retry if the sequence changed.
+// Readers must remap the segment when 'pixel_capacity' changes.
+
+typedef struct {
+    unsigned int magic;             // Magic 'KUMA'
+    unsigned int slot_count;        // Slots in Ring
+    atomic_uint pixel_capacity;     // Pixels per Slot
+    atomic_uint frame_latest;       // Most Recent Frame Number (0 = None)
+    atomic_uint slot_latest;        // Slot holding the Most Recent Frame
+} headless_shm_header_t;
+
+typedef struct {
+    atomic_uint sequence;           // Slot Sequence (Odd while Writing)
+    unsigned int frame;             // Frame Number
+    unsigned int width;             // Frame Width
+    unsigned int height;            // Frame Height
+} headless_shm_slot_t;
+
+// Prepare the configured headless target
+bool_t headless_init(const engine_config_t* config);
+
+// Write a completed frame (0x00RRGGBB) to the configured headless target
+bool_t headless_present(const unsigned int* framebuffer, int width, int height);
+
+// Release the headless target
+void headless_exit(void);
\ No newline at end of file
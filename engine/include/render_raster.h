@@ -0,0 +1,70 @@
+#include <engine_config.h>
+#pragma once
+
+#define RASTER_TILE_SIZE        64      // Tile Width & Height (Pixels)
+#define RASTER_THREAD_LIMIT     16      // Maximum Shading Threads
+#define RASTER_LIST_MINIMUM     256     // Initial Command List Capacity
+
+typedef enum {
+    RASTER_COMMAND_TRIANGLE = 1u,
+    RASTER_COMMAND_SPRITE = 2u,
+} __attribute__((__packed__)) raster_command_type_t;
+
+typedef struct {
+    float x;                        // Position X (Normalized Device Coordinates)
+    float y;                        // Position Y (Normalized Device Coordinates)
+    unsigned int color;             // Vertex Color (0x00RRGGBB)
+} raster_vertex_t;
+
+typedef struct {
+    raster_vertex_t v[3];           // Triangle Vertices
+} raster_triangle_t;
+
+typedef struct {
+    const unsigned int* pixels;     // Sprite Pixels (0xAARRGGBB, Premultiplied)
+    const unsigned char* blocks;    // Sprite Blocks, sampled instead of 'pixels' when set
+    unsigned char format;           // Block Format (bc_format_t)
+    unsigned int width;             // Sprite Width
+    unsigned int height;            // Sprite Height
+    int x;                          // Destination X (Pixels)
+    int y;                          // Destination Y (Pixels)
+    int w;                          // Destination Width (Pixels)
+    int h;                          // Destination Height (Pixels)
+} raster_sprite_t;
+
+typedef struct {
+    raster_command_type_t type;     // Command Type
+    union {
+        raster_triangle_t triangle;
+        raster_sprite_t sprite;
+    };
+} raster_command_t;
+
+typedef struct {
+    raster_command_t* commands;     // Queued Commands (Drawn in Order)
+    unsigned int size;              // Command Count
+    unsigned int capacity;          // Command Capacity
+    unsigned int clear;             // Clear Color (0x00RRGGBB)
+} raster_list_t;
+
+// Empty the command list and set the color the frame will be cleared to
+void raster_list_reset(raster_list_t* list, unsigned int clear);
+
+// Queue a flat or vertex colored triangle, either winding order is accepted
+bool_t raster_list_triangle(raster_list_t* list, const raster_vertex_t v[3]);
+
+// Queue a sprite to be scaled (nearest) and alpha blended onto the frame
+bool_t raster_list_sprite(raster_list_t* list, const raster_sprite_t* sprite);
+
+// Discard command list contents from memory
+void raster_list_free(raster_list_t* list);
+
+// Bin the list into screen tiles and shade them across all raster threads,
+// returns once the entire framebuffer (0x00RRGGBB) has been written.
+bool_t raster_draw(const raster_list_t* list, unsigned int* framebuffer, int width, int height);
+
+// Start raster threads, a count of zero will use every available core
+bool_t raster_init(int threads);
+
+// Stop raster threads and release binning memory
+void raster_exit(void);
\ No newline at end of file
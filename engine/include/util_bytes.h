@@ -40,4 +40,20 @@ static inline unsigned char read_u8(FILE* h) {
     unsigned char b;
     fread(&b, sizeof(unsigned char), sizeof(b), h);
     return b;
+}
+
+static inline unsigned int peek_u32_le(const unsigned char* b) {
+    unsigned int v =
+        ((unsigned int)b[3] << 24) |
+        ((unsigned int)b[2] << 16) |
+        ((unsigned int)b[1] << 8) |
+        ((unsigned int)b[0]);
+    return v;
+}
+
+static inline unsigned short peek_u16_le(const unsigned char* b) {
+    unsigned short v =
+        ((unsigned short)b[1] << 8) |
+        ((unsigned short)b[0]);
+    return v;
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <engine_config.h>
+#include <stddef.h>
+#pragma once
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Images are kept in the layout frames are presented in, 0xAARRGGBB with premultiplied
+// alpha, which sprites can be copied from as they are. Archives packed that way decode
+// straight into it, older ones are converted once after decoding.
+
+// Scalar Fallback
+static inline unsigned int pixel_present_one(unsigned int px, bool_t swap, bool_t premultiply) {
+    if (swap) {
+        px = (px & 0xFF00FF00) | ((px >> 16) & 0xFF) | ((px & 0xFF) << 16);
+    }
+    if (premultiply) {
+        unsigned int a = px >> 24;
+        unsigned int out = px & 0xFF000000;
+        for (unsigned int shift = 0; shift < 24; shift += 8) {
+            unsigned int t = ((px >> shift) & 0xFF) * a + 128;
+            out |= (((t + (t >> 8)) >> 8) & 0xFF) << shift;
+        }
+        px = out;
+    }
+    return px;
+}
+
+// Swap red with blue (0xAABBGGRR <-> 0xAARRGGBB) and/or multiply colors by alpha
+static inline void pixel_present(unsigned int* pixels, size_t count, bool_t swap, bool_t premultiply) {
+    if (!swap && !premultiply) {
+        return;
+    }
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i mask_ag = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i mask_c = _mm_set1_epi32(0x000000FF);
+    const __m128i mask_a = _mm_set1_epi32((int)0xFF000000);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(pixels + i));
+        if (swap) {
+            __m128i lo = _mm_and_si128(_mm_srli_epi32(v, 16), mask_c);
+            __m128i hi = _mm_slli_epi32(_mm_and_si128(v, mask_c), 16);
+            v = _mm_or_si128(_mm_and_si128(v, mask_ag), _mm_or_si128(lo, hi));
+        }
+        if (premultiply) {
+            // Widen to 16-Bit Lanes, multiply by Alpha & divide by 255 (Rounded)
+            __m128i l = _mm_unpacklo_epi8(v, zero);
+            __m128i h = _mm_unpackhi_epi8(v, zero);
+            __m128i la = _mm_shufflehi_epi16(_mm_shufflelo_epi16(l, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i ha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(h, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            l = _mm_add_epi16(_mm_mullo_epi16(l, la), half);
+            h = _mm_add_epi16(_mm_mullo_epi16(h, ha), half);
+            l = _mm_srli_epi16(_mm_add_epi16(l, _mm_srli_epi16(l, 8)), 8);
+            h = _mm_srli_epi16(_mm_add_epi16(h, _mm_srli_epi16(h, 8)), 8);
+            __m128i out = _mm_packus_epi16(l, h);
+            v = _mm_or_si128(_mm_andnot_si128(mask_a, out), _mm_and_si128(v, mask_a));
+        }
+        _mm_storeu_si128((__m128i*)(pixels + i), v);
+    }
+#endif
+    for (; i < count; i++) {
+        pixels[i] = pixel_present_one(pixels[i], swap, premultiply);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <engine_config.h>
+#include <stdatomic.h>
+#include <string.h>
+#pragma once
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+// Each slot carries a sequence number that tells producers and the consumer
+// whose turn it is, so neither side ever blocks on the other.
+
+#define RING_SLOT_SIZE(item_size) \
+    (8 + (((item_size) + 7) & ~7))
+
+#define RING_STORAGE_SIZE(capacity, item_size) \
+    ((capacity) * RING_SLOT_SIZE(item_size))
+
+typedef struct {
+    unsigned char* slots;                               // Slot Storage (Sequence + Item)
+    unsigned int slot_size;                             // Slot Size (Bytes)
+    unsigned int item_size;                             // Item Size (Bytes)
+    unsigned int mask;                                  // Capacity - 1
+    atomic_uint head __attribute__((aligned(ASSET_CACHE_LINE_SIZE)));  // (Producers) Next Slot
+    unsigned int tail __attribute__((aligned(ASSET_CACHE_LINE_SIZE))); // (Consumer) Next Slot
+} ring_t;
+
+static inline atomic_uint* ring_slot_sequence(const ring_t* r, unsigned int position) {
+    return (atomic_uint*)(r->slots + (size_t)(position & r->mask) * r->slot_size);
+}
+
+static inline void* ring_slot_item(const ring_t* r, unsigned int position) {
+    return r->slots + (size_t)(position & r->mask) * r->slot_size + 8;
+}
+
+// Prepare a ring using caller provided storage of RING_STORAGE_SIZE() bytes,
+// the capacity must be a power of two.
+static inline bool_t ring_init(ring_t* r, void* storage, unsigned int capacity, unsigned int item_size) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return FALSE;
+    }
+    r->slots = storage;
+    r->slot_size = RING_SLOT_SIZE(item_size);
+    r->item_size = item_size;
+    r->mask = capacity - 1;
+    r->tail = 0;
+    atomic_store(&r->head, 0);
+    for (unsigned int i = 0; i < capacity; i++) {
+        atomic_store(ring_slot_sequence(r, i), i);
+    }
+    return TRUE;
+}
+
+// Copy an item into the ring, safe to call from any thread.
+// Returns FALSE if the ring is full.
+static inline bool_t ring_push(ring_t* r, const void* item) {
+    unsigned int position = atomic_load_explicit(&r->head, memory_order_relaxed);
+    while (TRUE) {
+        atomic_uint* sequence = ring_slot_sequence(r, position);
+        unsigned int expect = atomic_load_explicit(sequence, memory_order_acquire);
+        int difference = (int)(expect - position);
+        if (difference == 0) {
+            // Slot is free, try to claim it
+            if (atomic_compare_exchange_weak_explicit(&r->head, &position, position + 1,
+                memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            // Slot still holds an item from the previous lap
+            return FALSE;
+        }
+        else {
+            // Another producer claimed the slot
+            position = atomic_load_explicit(&r->head, memory_order_relaxed);
+        }
+    }
+    memcpy(ring_slot_item(r, position), item, r->item_size);
+    atomic_store_explicit(ring_slot_sequence(r, position), position + 1, memory_order_release);
+    return TRUE;
+}
+
+// Copy the oldest item out of the ring, only one thread may consume.
+// Returns FALSE if the ring is empty.
+static inline bool_t ring_pop(ring_t* r, void* item) {
+    unsigned int position = r->tail;
+    atomic_uint* sequence = ring_slot_sequence(r, position);
+    unsigned int expect = atomic_load_explicit(sequence, memory_order_acquire);
+    if ((int)(expect - (position + 1)) < 0) {
+        return FALSE;
+    }
+    memcpy(item, ring_slot_item(r, position), r->item_size);
+    atomic_store_explicit(sequence, position + r->mask + 1, memory_order_release);
+    r->tail = position + 1;
+    return TRUE;
+}
\ No newline at end of file
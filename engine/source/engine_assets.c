@@ -1,51 +1,342 @@
 #include <engine_assets.h>
 #include <engine_logger.h>
+#include <engine_render.h>
+#include <platform_memory.h>
+#include <platform_watch.h>
+#include <platform_read.h>
+#include <platform_time.h>
 #include <util_bytes.h>
+#include <util_crc32.h>
+#include <util_pixel.h>
+#include <codec_qoi.h>
+#include <codec_qoa.h>
+#include <codec_mip.h>
+#include <codec_bc.h>
 #include <stdatomic.h>
 #include <pthread.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
 
-#ifdef _WIN32
-#include <sysinfoapi.h>
-static MEMORYSTATUSEX mem_state;
-static float registry_last_cleanup_memory = 0;
-#endif
+typedef struct {
+    int fd;                         // Archive Handle
+    unsigned int generation;        // Archive Generation the Handle was opened at
+} worker_archive_t;
 
-static bool worker_running = TRUE;
+typedef struct {
+    asset_t* asset;                 // Claimed Asset
+    bool_t reload;                  // Claimed for a Reload?
+    unsigned int archive_id;        // Manifest Snapshot: Archive ID
+    unsigned int archive_offset;    // Manifest Snapshot: Archive Read Offset
+    unsigned int archive_length;    // Manifest Snapshot: Archive Read Length
+    unsigned int hash;              // Manifest Snapshot: Payload Checksum
+    unsigned int generation;        // Archive Generation of the Snapshot
+    unsigned char flag;             // Manifest Snapshot: Asset Flags
+    unsigned int level;             // Finest Mip Level requested
+    unsigned int length;            // Bytes to Read, only the start of a Mipmapped Image may be needed
+    bool_t probe;                   // Reading the start of a Mipmapped Image to learn its Level Table
+} worker_read_t;
+
+typedef struct worker_group_s {
+    read_request_t request;         // Archive Read covering every Member
+    unsigned long long start;       // Archive Offset of the Buffer
+    unsigned int count;             // Members
+    unsigned int cursor;            // (Decode Queue) Next Member to hand out
+    atomic_uint remaining;          // Members not yet Decoded
+    struct worker_group_s* next;    // (Decode Queue) Next Read
+    worker_read_t members[];        // Members sorted by Offset
+} worker_group_t;
+
+typedef struct {
+    unsigned int* indices;          // Asset Indices, handed out from 'head' onwards
+    unsigned int head;              // Next Index to hand out
+    unsigned int count;             // Indices Stored
+    unsigned int capacity;          // Indices Allocated
+} worker_queue_t;
+
+static memory_probe_t memory_probe;
+static float memory_last_probe = 0;
+static float stats_last_log = 0;
+
+static bool_t worker_running = TRUE;
 static unsigned int worker_count = 0;
+static atomic_int worker_pending = 0;
+static atomic_int worker_deferred = 0;                          // Queued Assets waiting for their Retry Time
+static atomic_int worker_rescan = 0;                            // Queueing failed, the Reader looks through every Asset
+static worker_queue_t worker_queued;                            // (Worker Mutex) Assets awaiting a Load or Reload
+static worker_queue_t worker_queued_prefetch;                   // (Worker Mutex) Assets awaiting a Prefetch
+static worker_queue_t worker_retries;                           // (Reader) Claimed before their Retry Time
 static asset_worker_args_t* worker_args;
 static pthread_mutex_t worker_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t worker_cond = PTHREAD_COND_INITIALIZER;
 static pthread_t* worker_threads;
+static pthread_cond_t decode_cond = PTHREAD_COND_INITIALIZER;
+static worker_group_t* decode_queue = NULL;                     // Finished Reads awaiting Decoding
+static worker_group_t* decode_queue_last = NULL;
+static pthread_t reader_thread;
+static bool_t reader_started = FALSE;
+static atomic_uint reader_outstanding = 0;                      // Reads Submitted but not yet Decoded
 
-static char* archive_paths[] = {
-    "assets.yuri"
-};
-static unsigned int archive_count = sizeof(archive_paths) / sizeof(archive_paths[0]);
-static float registry_last_cleanup = 0;
+static const char* archive_paths[ASSET_ARCHIVE_LIMIT];
+static unsigned int archive_count = 0;
+static atomic_uint archive_generation[ASSET_ARCHIVE_LIMIT];     // Bumped whenever an Archive is remounted
+static double archive_changed[ASSET_ARCHIVE_LIMIT];             // When a Change was first noticed (0 = None)
+static bool_t archive_watching = FALSE;
+static watch_t archive_watch;
+static int archive_hint[ASSET_ARCHIVE_LIMIT];                   // Handles for Page Cache Hints (Registry Mutex)
 static asset_registry_t* registry = NULL;
 
+static const char* trace_path = NULL;
+static double trace_start = 0;
+static pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+static asset_trace_t* trace_recorded = NULL;                    // First Uses during this Run
+static unsigned int trace_recorded_count = 0;
+static unsigned int trace_recorded_capacity = 0;
+static asset_trace_t* trace_replay = NULL;                      // First Uses during the previous Run
+static unsigned int trace_replay_count = 0;
+static unsigned int trace_replay_cursor = 0;                    // Next Entry to Prefetch
+
+static inline unsigned int assets_index(const asset_t* a) {
+    return (unsigned int)(a - registry->assets);
+}
+
+// Append an index, a full queue reuses the room already handed out or grows
+static bool_t worker_queue_push(worker_queue_t* q, unsigned int index) {
+    if (q->count == q->capacity) {
+        if (q->head > 0 && q->head >= q->capacity / 2) {
+            memmove(q->indices, q->indices + q->head, (q->count - q->head) * sizeof(unsigned int));
+            q->count -= q->head;
+            q->head = 0;
+        }
+        else {
+            unsigned int capacity = q->capacity ? q->capacity * 2 : 64;
+            unsigned int* indices = realloc(q->indices, capacity * sizeof(unsigned int));
+            if (indices == NULL) {
+                return FALSE;
+            }
+            q->indices = indices;
+            q->capacity = capacity;
+        }
+    }
+    q->indices[q->count++] = index;
+    return TRUE;
+}
+
+// Take up to 'limit' of the oldest indices
+static unsigned int worker_queue_pop(worker_queue_t* q, unsigned int* indices, unsigned int limit) {
+    unsigned int count = q->count - q->head < limit ? q->count - q->head : limit;
+    if (count == 0) {
+        return 0;
+    }
+    memcpy(indices, q->indices + q->head, count * sizeof(unsigned int));
+    q->head += count;
+    if (q->head == q->count) {
+        q->head = q->count = 0;
+    }
+    return count;
+}
+
+static void worker_queue_free(worker_queue_t* q) {
+    free(q->indices);
+    *q = (worker_queue_t){ 0 };
+}
+
+// Hand assets which were just put into a queued state over to the reader, the worker
+// mutex must be locked. Prefetches are only looked at once nothing else is waiting.
+// Should an index not fit the reader falls back to looking through every asset.
+static void worker_unsafe_queue(asset_t** assets, unsigned int count, bool_t prefetch) {
+    worker_queue_t* q = prefetch ? &worker_queued_prefetch : &worker_queued;
+    for (unsigned int i = 0; i < count; i++) {
+        if (!worker_queue_push(q, assets_index(assets[i]))) {
+            atomic_store(&worker_rescan, 1);
+        }
+    }
+}
+
+// Queue an asset without counting it as pending, it already was under another state
+static void worker_queue(asset_t* a, bool_t prefetch) {
+    pthread_mutex_lock(&worker_mutex);
+    worker_unsafe_queue(&a, 1, prefetch);
+    pthread_mutex_unlock(&worker_mutex);
+}
+
+// Queue assets that were just put into a queued state and wake workers for them
+static void worker_signal_batch(asset_t** assets, unsigned int count, bool_t prefetch) {
+    pthread_mutex_lock(&worker_mutex);
+    worker_unsafe_queue(assets, count, prefetch);
+    atomic_fetch_add(&worker_pending, (int)count);
+    if (count > 1) {
+        pthread_cond_broadcast(&worker_cond);
+    }
+    else {
+        pthread_cond_signal(&worker_cond);
+    }
+    pthread_mutex_unlock(&worker_mutex);
+}
+
+// Queue an asset that was just put into a queued state and wake a worker for it
+static void worker_signal(asset_t* a, bool_t prefetch) {
+    worker_signal_batch(&a, 1, prefetch);
+}
+
+static int worker_read_compare(const void* a, const void* b) {
+    const worker_read_t* x = (const worker_read_t*)a;
+    const worker_read_t* y = (const worker_read_t*)b;
+    if (x->archive_id != y->archive_id) {
+        return x->archive_id < y->archive_id ? -1 : 1;
+    }
+    return (x->archive_offset > y->archive_offset) - (x->archive_offset < y->archive_offset);
+}
+
+// Ask for mip levels down to 'level', the finest level anyone asked for wins
+static void registry_request_level(asset_ref_t* ref, unsigned int level) {
+    unsigned int request = atomic_load(&ref->mip_request);
+    while (level < request && !atomic_compare_exchange_weak(&ref->mip_request, &request, level));
+}
+
+// Queue a reload for a ready asset whose archive entry changed while it was being
+// loaded, or which is an image coarser than the mip level that was asked for since.
+static void registry_refresh(asset_registry_t* r, unsigned int index) {
+    asset_ref_t* ref = &r->refs[index];
+    if (!atomic_load(&ref->stale) && atomic_load(&ref->mip_request) >= atomic_load(&ref->mip_loaded)) {
+        return;
+    }
+    asset_state_t expect = ASSET_STATE_DONE;
+    if (atomic_compare_exchange_strong(&r->states[index], &expect, ASSET_STATE_STALE)) {
+        worker_signal(&r->assets[index], FALSE);
+    }
+}
+
+// Mark an asset ready, see registry_refresh()
+static void registry_publish(asset_registry_t* r, unsigned int index) {
+    atomic_store(&r->states[index], ASSET_STATE_DONE);
+    registry_refresh(r, index);
+}
+
+// Queue a reload for an asset whose archive entry changed. Assets which aren't ready
+// yet pick up the change once they are published, unloaded ones simply read it later.
+static void registry_unsafe_mark_stale(asset_registry_t* r, unsigned int index) {
+    atomic_store(&r->refs[index].stale, 1);
+    asset_state_t expect = ASSET_STATE_DONE;
+    if (atomic_compare_exchange_strong(&r->states[index], &expect, ASSET_STATE_STALE)) {
+        worker_signal(&r->assets[index], FALSE);
+    }
+}
+
+
+static bool_t registry_grow(void** list, size_t old_count, size_t new_count, size_t size) {
+    void* new_list = realloc(*list, new_count * size);
+    if (new_list == NULL) {
+        return FALSE;
+    }
+    memset((unsigned char*)new_list + old_count * size, 0, (new_count - old_count) * size);
+    *list = new_list;
+    return TRUE;
+}
 
 bool_t registry_unsafe_preallocate(asset_registry_t* r, unsigned int amount) {
+    if (r->sealed) {
+        logger(LERROR, OASSET, "Cannot Grow the Registry while Assets are in Use");
+        errno = EBUSY;
+        return FALSE;
+    }
     size_t old_capacity = r->capacity;
-    asset_t* new_list = realloc(r->assets, (r->capacity + amount) * sizeof(asset_t));
-    if (new_list == NULL) {
+    size_t new_capacity = old_capacity + amount;
+    if (
+        !registry_grow((void**)&r->assets, old_capacity, new_capacity, sizeof(asset_t)) ||
+        !registry_grow((void**)&r->states, old_capacity, new_capacity, sizeof(atomic_char)) ||
+        !registry_grow((void**)&r->types, old_capacity, new_capacity, sizeof(unsigned char)) ||
+        !registry_grow((void**)&r->name_hashes, old_capacity, new_capacity, sizeof(unsigned int))
+        ) {
+        return FALSE;
+    }
+
+    // References must start on a cache line, realloc() can't promise that
+    void* block = malloc(new_capacity * sizeof(asset_ref_t) + ASSET_CACHE_LINE_SIZE);
+    if (block == NULL) {
         return FALSE;
     }
-    memset(&new_list[old_capacity], 0, amount * sizeof(asset_t));
-    r->assets = new_list;
-    r->capacity += amount;
+    asset_ref_t* refs = (asset_ref_t*)
+        (((uintptr_t)block + ASSET_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(ASSET_CACHE_LINE_SIZE - 1));
+    if (r->refs) {
+        memcpy(refs, r->refs, old_capacity * sizeof(asset_ref_t));
+    }
+    memset(&refs[old_capacity], 0, amount * sizeof(asset_ref_t));
+    free(r->refs_block);
+    r->refs_block = block;
+    r->refs = refs;
+    r->capacity = (unsigned int)new_capacity;
     return TRUE;
 }
 
-bool_t registry_unsafe_parse(asset_registry_t* r, const char* archive_path, const unsigned int archive_id) {
+static inline unsigned int registry_slot(const asset_registry_t* r, const unsigned char type, const unsigned int hash) {
+    return (hash ^ (type * 0x9E3779B1u)) & r->table_mask;
+}
+
+// Find the lookup table slot holding an asset, or the empty slot it would take
+static unsigned int registry_unsafe_probe(const asset_registry_t* r, const unsigned char type, const unsigned int hash, const char* name) {
+    unsigned int slot = registry_slot(r, type, hash);
+    while (r->table[slot] != 0) {
+        unsigned int i = r->table[slot] - 1;
+        if (r->name_hashes[i] == hash && r->types[i] == type && !strcmp(r->assets[i].name, name)) {
+            break;
+        }
+        slot = (slot + 1) & r->table_mask;
+    }
+    return slot;
+}
+
+// Grow the lookup table so it stays at most half full with 'count' assets
+static bool_t registry_unsafe_reindex(asset_registry_t* r, unsigned int count) {
+    unsigned int capacity = 64;
+    while (capacity < count * 2) {
+        capacity *= 2;
+    }
+    if (r->table && capacity <= r->table_mask + 1) {
+        return TRUE;
+    }
+    unsigned int* table = calloc(capacity, sizeof(unsigned int));
+    if (table == NULL) {
+        return FALSE;
+    }
+    free(r->table);
+    r->table = table;
+    r->table_mask = capacity - 1;
+    for (unsigned int i = 0; i < r->size; i++) {
+        r->table[registry_unsafe_probe(r, r->types[i], r->name_hashes[i], r->assets[i].name)] = i + 1;
+    }
+    return TRUE;
+}
+
+typedef struct {
+    unsigned char type;             // Entry Type
+    unsigned char flag;             // Entry Flags
+    unsigned int size;              // Entry Payload Size
+    unsigned int hash;              // Entry Payload Checksum
+    unsigned int name_length;       // Entry Name Length
+    size_t name_offset;             // Entry Name Offset in Blob
+} archive_entry_t;
+
+typedef struct {
+    archive_entry_t* list;          // Manifest Entries
+    unsigned int entries;           // Manifest Entry Count
+    unsigned int offset_header;     // Payloads begin right after the Manifest
+    char* names;                    // Entry Names (One Blob)
+} archive_manifest_t;
+
+// Read an archive manifest, problems are logged with the given severity so that a
+// reload can shrug off an archive that is still being written.
+static bool_t registry_read_manifest(const char* archive_path, archive_manifest_t* m, const unsigned char severity) {
     unsigned int archive_size = 0;
     FILE* archive_handle;
+    memset(m, 0, sizeof(archive_manifest_t));
 
     // Open Archive
     if ((archive_handle = fopen(archive_path, "rb")) == NULL) {
-        logger(LERROR, OASSET, "Unable to Open Archive (%s)", strerror(errno));
+        logger(severity, OASSET, "Unable to Open Archive '%s' (%s)", archive_path, strerror(errno));
         return FALSE;
     }
     fseek(archive_handle, 0, SEEK_END);
@@ -54,7 +345,7 @@ bool_t registry_unsafe_parse(asset_registry_t* r, const char* archive_path, cons
 
     // Read YURI Header
     if (YURI_SIZE_HEADER > archive_size) {
-        logger(LERROR, OASSET, "Unexpected EOF reading Archive Header");
+        logger(severity, OASSET, "Unexpected EOF reading Archive Header");
         fclose(archive_handle);
         return FALSE;
     }
@@ -62,226 +353,1869 @@ bool_t registry_unsafe_parse(asset_registry_t* r, const char* archive_path, cons
     unsigned int entries = read_u32_le(archive_handle);
 
     if (identify != MAGIC_YURI) {
-        logger(LERROR, OASSET, "File is not a YURI Archive");
+        logger(severity, OASSET, "File is not a YURI Archive");
         fclose(archive_handle);
         return FALSE;
     }
-    if (!registry_unsafe_preallocate(r, entries)) {
-        logger(LERROR, OASSET, "Failed to Allocate Memory for %d Entries (%s)",
-            entries, strerror(errno));
+
+    // Read YURI Entries
+    // Names are packed into a single blob owned by the archive. The blob may move
+    // while it grows, so entries are only mounted once every name has been read.
+    unsigned long long payload_size = 0;
+    size_t names_size = 0;
+    size_t names_capacity = (size_t)entries * 32 + 1;
+    char* names = malloc(names_capacity);
+    archive_entry_t* list = malloc((entries > 0 ? entries : 1) * sizeof(archive_entry_t));
+    if (names == NULL || list == NULL) {
+        logger(severity, OASSET, "Failed to Allocate Memory for %d Entries (%s)", entries, strerror(errno));
+        free(names);
+        free(list);
         fclose(archive_handle);
         return FALSE;
     }
-
-    // Read YURI Entries
-    unsigned int offset_index = r->size;
-    unsigned int offset_binary = 0;
     for (unsigned int i = 0; i < entries; i++) {
 
         if (ftell(archive_handle) + YURI_SIZE_ENTRY > archive_size) {
-            logger(LERROR, OASSET, "Unexpected EOF reading Entry #%d", i);
+            logger(severity, OASSET, "Unexpected EOF reading Entry #%d", i);
+            free(names);
+            free(list);
             fclose(archive_handle);
             return FALSE;
         }
-        unsigned char type = read_u8(archive_handle);
-        unsigned char flag = read_u8(archive_handle);
-        unsigned int size = read_u32_le(archive_handle);
-        unsigned int hash = read_u32_le(archive_handle);
-        unsigned int len = (unsigned int)read_u16_le(archive_handle);
-        char* name = NULL;
+        archive_entry_t* e = &list[i];
+        e->type = read_u8(archive_handle);
+        e->flag = read_u8(archive_handle);
+        e->size = read_u32_le(archive_handle);
+        e->hash = read_u32_le(archive_handle);
+        e->name_length = (unsigned int)read_u16_le(archive_handle);
+        e->name_offset = names_size;
+        payload_size += e->size;
 
-        if (type == 0 || type > ASSET_TYPE_SCRIPT) {
-            logger(LERROR, OASSET, "Unsupported Asset Type %d (#%d)", i, type);
+        if (e->type == 0 || e->type > ASSET_TYPE_SPRITE) {
+            logger(severity, OASSET, "Unsupported Asset Type %d (#%d)", i, e->type);
+            free(names);
+            free(list);
             fclose(archive_handle);
             return FALSE;
         }
 
         // Copy Entry Name
-        if (ftell(archive_handle) + len > archive_size) {
-            logger(LERROR, OASSET,
-                "Unexpected EOF reading Entry Name", i);
+        if (ftell(archive_handle) + e->name_length > archive_size) {
+            logger(severity, OASSET, "Unexpected EOF reading Entry Name (#%d)", i);
+            free(names);
+            free(list);
             fclose(archive_handle);
             return FALSE;
         }
-        if ((name = malloc(len)) == NULL) {
-            logger(LERROR, OASSET, "Failed to Allocate Memory for Entry Name (#%d)", i);
-            fclose(archive_handle);
-            return FALSE;
+        if (names_size + e->name_length + 1 > names_capacity) {
+            while (names_size + e->name_length + 1 > names_capacity) {
+                names_capacity *= 2;
+            }
+            char* grown = realloc(names, names_capacity);
+            if (grown == NULL) {
+                logger(severity, OASSET, "Failed to Allocate Memory for Entry Name (#%d)", i);
+                free(names);
+                free(list);
+                fclose(archive_handle);
+                return FALSE;
+            }
+            names = grown;
+        }
+        fread(names + names_size, sizeof(unsigned char), e->name_length, archive_handle);
+        names[names_size + e->name_length] = '\0';
+        names_size += e->name_length + 1;
+    }
+
+    // Payloads must fit, otherwise the archive is truncated or still being written
+    m->offset_header = ftell(archive_handle);
+    fclose(archive_handle);
+    if (m->offset_header + payload_size > archive_size) {
+        logger(severity, OASSET, "Unexpected EOF reading Archive Payloads");
+        free(names);
+        free(list);
+        return FALSE;
+    }
+
+    // Trim Blob
+    char* trimmed = realloc(names, names_size > 0 ? names_size : 1);
+    if (trimmed != NULL) {
+        names = trimmed;
+    }
+    m->list = list;
+    m->entries = entries;
+    m->names = names;
+    return TRUE;
+}
+
+// Add a new entry to the registry, the caller fills in the archive location
+static asset_t* registry_unsafe_append(asset_registry_t* r, unsigned int slot, const archive_entry_t* e, char* name, unsigned int name_hash) {
+    unsigned int index = r->size++;
+    asset_t* a = &r->assets[index];
+    atomic_store(&r->states[index], ASSET_STATE_DISK);
+    atomic_store(&r->refs[index].used, 0);
+    atomic_store(&r->refs[index].mip_request, ASSET_MIP_LIMIT);
+    r->types[index] = e->type;
+    r->name_hashes[index] = name_hash;
+    r->table[slot] = index + 1;
+    a->type = e->type;
+    a->name_length = e->name_length;
+    a->name = name;
+    return a;
+}
+
+bool_t registry_unsafe_parse(asset_registry_t* r, const char* archive_path, const unsigned int archive_id) {
+    archive_manifest_t m;
+    if (!registry_read_manifest(archive_path, &m, LERROR)) {
+        return FALSE;
+    }
+    r->names[archive_id] = m.names;
+    unsigned int* entries = calloc(m.entries > 0 ? m.entries : 1, sizeof(unsigned int));
+    if (entries == NULL || !registry_unsafe_preallocate(r, m.entries) || !registry_unsafe_reindex(r, r->size + m.entries)) {
+        logger(LERROR, OASSET, "Failed to Allocate Memory for %d Entries (%s)", m.entries, strerror(errno));
+        free(entries);
+        free(m.list);
+        return FALSE;
+    }
+    free(r->entries[archive_id]);
+    r->entries[archive_id] = entries;
+    r->entry_counts[archive_id] = m.entries;
+
+    // Mount Entries
+    unsigned int offset_binary = 0;
+    unsigned int shadowed = 0;
+    for (unsigned int i = 0; i < m.entries; i++) {
+        archive_entry_t* e = &m.list[i];
+        char* name = m.names + e->name_offset;
+        unsigned int name_hash = crc32((unsigned char*)name, (int)e->name_length);
+        unsigned int slot = registry_unsafe_probe(r, e->type, name_hash, name);
+
+        asset_t* a;
+        if (r->table[slot] != 0) {
+            // Shadow Entry, handles to it stay valid but now read from this archive
+            a = &r->assets[r->table[slot] - 1];
+            logger(LDEBUG, OASSET, "'%s' shadows archive #%d", name, a->archive_id);
+            shadowed++;
+        }
+        else {
+            a = registry_unsafe_append(r, slot, e, name, name_hash);
+        }
+        entries[i] = (unsigned int)(a - r->assets) + 1;
+        a->flag = e->flag;
+        a->hash = e->hash;
+        a->archive_id = archive_id;
+        a->archive_offset = m.offset_header + offset_binary;
+        a->archive_length = e->size;
+
+        // Track Offsets
+        offset_binary += e->size;
+        logger(LDEBUG, OASSET,
+            "%03d : '%-30s' %8s . 0x%08X . 0x%02X . %8.2fKB",
+            i + 1, name, asset_str_type(e->type), e->hash, e->flag, e->size / 1024.00
+        );
+    }
+    if (shadowed > 0) {
+        logger(LINFO, OASSET, "Archive '%s' shadows %d Entries", archive_path, shadowed);
+    }
+
+    free(m.list);
+    return TRUE;
+}
+
+// Point assets whose entry vanished from an archive back at the highest earlier archive
+// which still provides them, that entry was shadowed until now. Returns how many were found.
+static unsigned int registry_unsafe_fallback(asset_registry_t* r, const unsigned int archive_id, bool_t* vanished, const unsigned int pending) {
+    unsigned int restored = 0;
+    for (unsigned int k = archive_id; k-- > 0 && restored < pending;) {
+        archive_manifest_t m;
+        if (!registry_read_manifest(archive_paths[k], &m, LWARN)) {
+            continue;
+        }
+        unsigned int offset_binary = 0;
+        for (unsigned int i = 0; i < m.entries; i++) {
+            archive_entry_t* e = &m.list[i];
+            char* name = m.names + e->name_offset;
+            unsigned int offset = m.offset_header + offset_binary;
+            offset_binary += e->size;
+            unsigned int name_hash = crc32((unsigned char*)name, (int)e->name_length);
+            unsigned int slot = registry_unsafe_probe(r, e->type, name_hash, name);
+            if (r->table[slot] == 0 || !vanished[r->table[slot] - 1]) {
+                continue;
+            }
+            unsigned int index = r->table[slot] - 1;
+            asset_t* a = &r->assets[index];
+            if (a->hash != e->hash) {
+                free(a->mip_ends);
+                a->mip_ends = NULL;
+                a->mip_count = 0;
+            }
+            a->flag = e->flag;
+            a->hash = e->hash;
+            a->archive_id = k;
+            a->archive_offset = offset;
+            a->archive_length = e->size;
+            registry_unsafe_mark_stale(r, index);
+            vanished[index] = FALSE;
+            restored++;
+        }
+        free(m.list);
+        free(m.names);
+    }
+    return restored;
+}
+
+bool_t registry_unsafe_reload(asset_registry_t* r, const char* archive_path, const unsigned int archive_id) {
+    archive_manifest_t m;
+    if (!registry_read_manifest(archive_path, &m, LWARN)) {
+        return FALSE;
+    }
+    unsigned int mounted = r->size;
+    bool_t* seen = calloc(mounted > 0 ? mounted : 1, sizeof(bool_t));
+    unsigned int* entries = calloc(m.entries > 0 ? m.entries : 1, sizeof(unsigned int));
+    char** retired = realloc(r->names_retired, (r->names_retired_count + 1) * sizeof(char*));
+    if (seen == NULL || entries == NULL || retired == NULL || !registry_unsafe_reindex(r, r->size + m.entries)) {
+        logger(LWARN, OASSET, "Failed to Allocate Memory for Reload (%s)", strerror(errno));
+        if (retired != NULL) r->names_retired = retired;
+        free(seen);
+        free(entries);
+        free(m.list);
+        free(m.names);
+        return FALSE;
+    }
+
+    // Entries keep pointing into the previous blob, so it lives as long as the registry
+    r->names_retired = retired;
+    r->names_retired[r->names_retired_count++] = r->names[archive_id];
+    r->names[archive_id] = m.names;
+    free(r->entries[archive_id]);
+    r->entries[archive_id] = entries;
+    r->entry_counts[archive_id] = m.entries;
+
+    // Payloads of this archive moved, workers must reopen it before reading
+    atomic_fetch_add(&archive_generation[archive_id], 1);
+
+    // Remount Entries
+    unsigned int offset_binary = 0;
+    unsigned int changed = 0, added = 0, skipped = 0, removed = 0;
+    for (unsigned int i = 0; i < m.entries; i++) {
+        archive_entry_t* e = &m.list[i];
+        char* name = m.names + e->name_offset;
+        unsigned int name_hash = crc32((unsigned char*)name, (int)e->name_length);
+        unsigned int slot = registry_unsafe_probe(r, e->type, name_hash, name);
+        unsigned int offset = m.offset_header + offset_binary;
+        offset_binary += e->size;
+
+        asset_t* a;
+        unsigned int index;
+        if (r->table[slot] != 0) {
+            index = r->table[slot] - 1;
+            a = &r->assets[index];
+            if (index < mounted) {
+                seen[index] = TRUE;
+            }
+            entries[i] = index + 1;
+            if (a->archive_id != ASSET_ARCHIVE_LIMIT && a->archive_id > archive_id) {
+                continue;   // Still shadowed by a later archive
+            }
         }
-        fread(name, sizeof(unsigned char), len, archive_handle);
-        name[len] = '\0';
-
-        // Copy Entry
-        asset_t* a = &r->assets[r->size++];
-        atomic_store(&a->state, ASSET_STATE_DISK);
-        atomic_store(&a->type, type);
-        atomic_store(&a->used, 0);
-        a->flag = flag;
-        a->hash = hash;
-        a->name_length = len;
+        else if (r->size < r->capacity) {
+            // New Entry, only possible without moving the registry as handles point into it
+            a = registry_unsafe_append(r, slot, e, name, name_hash);
+            index = r->size - 1;
+            entries[i] = index + 1;
+            added++;
+        }
+        else {
+            skipped++;
+            continue;
+        }
+        bool_t stale = a->hash != e->hash || a->archive_id == ASSET_ARCHIVE_LIMIT;
+        if (a->hash != e->hash) {
+            // Level table belongs to the previous payload
+            free(a->mip_ends);
+            a->mip_ends = NULL;
+            a->mip_count = 0;
+        }
+        a->flag = e->flag;
+        a->hash = e->hash;
         a->archive_id = archive_id;
-        a->archive_offset = offset_binary;
-        a->archive_length = size;
-        a->name = name;
+        a->archive_offset = offset;
+        a->archive_length = e->size;
+        if (stale) {
+            registry_unsafe_mark_stale(r, index);
+            changed++;
+        }
+    }
+
+    // Entries that vanished from the archive fall back to an earlier archive, if no
+    // archive provides them anymore they can no longer be read
+    bool_t* vanished = seen;
+    unsigned int pending = 0;
+    for (unsigned int i = 0; i < mounted; i++) {
+        vanished[i] = r->assets[i].archive_id == archive_id && !seen[i];
+        pending += vanished[i];
+    }
+    unsigned int restored = pending > 0 ? registry_unsafe_fallback(r, archive_id, vanished, pending) : 0;
+    for (unsigned int i = 0; i < mounted; i++) {
+        if (vanished[i]) {
+            r->assets[i].archive_id = ASSET_ARCHIVE_LIMIT;
+            removed++;
+        }
+    }
+
+    logger(LINFO, OASSET, "Reloaded Archive '%s' : %d Changed, %d Added, %d Restored, %d Removed",
+        archive_path, changed, added, restored, removed);
+    if (skipped > 0) {
+        logger(LWARN, OASSET, "%d New Entries do not fit into the Registry, restart to mount them", skipped);
+    }
+
+    free(seen);
+    free(m.list);
+    return TRUE;
+}
+
+void registry_release_meta(const unsigned char type, asset_metadata_u* meta) {
+    switch (type) {
+    case ASSET_TYPE_EMBEDDED:
+    case ASSET_TYPE_SCRIPT: {
+        free(meta->embed.data);
+        meta->embed.data = NULL;
+        meta->embed.size = 0;
+        break;
+    }
+    case ASSET_TYPE_SCENE: {
+        free(meta->scene.data);
+        free(meta->scene.assets);
+        memset(&meta->scene, 0, sizeof(meta->scene));
+        break;
+    }
+    case ASSET_TYPE_MODEL: {
+        free(meta->model.data);
+        memset(&meta->model, 0, sizeof(meta->model));
+        break;
+    }
+    case ASSET_TYPE_SHADER_VERTEX:
+    case ASSET_TYPE_SHADER_FRAGMENT: {
+        free(meta->shader.code);
+        meta->shader.code = NULL;
+        meta->shader.size = 0;
+        break;
+    }
+    case ASSET_TYPE_IMAGE: {
+        if (meta->image.mips) {
+            // Pixels point at the finest loaded level
+            for (unsigned int i = 0; i < meta->image.level_count; i++) {
+                free(meta->image.mips[i].pixels);
+                free(meta->image.mips[i].blocks);
+            }
+            free(meta->image.mips);
+        }
+        else {
+            free(meta->image.pixels);
+            free(meta->image.blocks);
+        }
+        meta->image.pixels = NULL;
+        meta->image.blocks = NULL;
+        meta->image.format = 0;
+        meta->image.width = 0;
+        meta->image.height = 0;
+        meta->image.level = 0;
+        meta->image.level_count = 0;
+        meta->image.mips = NULL;
+        break;
+    }
+    case ASSET_TYPE_SPRITE: {
+        // Sprites hold on to their page
+        if (meta->sprite.page) {
+            assets_release(meta->sprite.page);
+        }
+        memset(&meta->sprite, 0, sizeof(asset_metadata_sprite_t));
+        break;
+    }
+    case ASSET_TYPE_AUDIO: {
+        free(meta->audio.pcm);
+        meta->audio.pcm = NULL;
+        meta->audio.sampleRate = 0;
+        meta->audio.channels = 0;
+        meta->audio.samples = 0;
+        break;
+    }
+    default: {
+        logger(LERROR, OASSET, "Cannot Evacuate Asset with Type (%d)", type);
+        break;
+    }
+    }
+}
+
+static void registry_counter_add(asset_counter_t* c, const asset_account_t kind, long long size) {
+    if (size < 0) {
+        atomic_fetch_sub(&c->resident, (unsigned long long)-size);
+    }
+    else {
+        unsigned long long resident = atomic_fetch_add(&c->resident, (unsigned long long)size) + (unsigned long long)size;
+        unsigned long long peak = atomic_load(&c->peak);
+        while (resident > peak && !atomic_compare_exchange_weak(&c->peak, &peak, resident));
+    }
+    switch (kind) {
+    case ASSET_ACCOUNT_LOAD: {
+        atomic_fetch_add(&c->count, 1);
+        atomic_fetch_add(&c->loads, 1);
+        break;
+    }
+    case ASSET_ACCOUNT_EVICT: {
+        atomic_fetch_sub(&c->count, 1);
+        atomic_fetch_add(&c->evictions, 1);
+        break;
+    }
+    case ASSET_ACCOUNT_RESIZE: {
+        break;
+    }
+    }
+}
+
+// Record a decoded or evicted asset (by its size), or the size change of a reloaded one
+static void registry_account(asset_registry_t* r, const unsigned char type, const asset_account_t kind, long long size) {
+    registry_counter_add(&r->stats[ASSET_STATS_TOTAL], kind, size);
+    if (type > ASSET_STATS_TOTAL && type < ASSET_STATS_LIMIT) {
+        registry_counter_add(&r->stats[type], kind, size);
+    }
+}
+
+static unsigned int worker_resident_level(unsigned int format, unsigned int width, unsigned int height) {
+    return format ? (unsigned int)bc_length(format, width, height) : width * height * sizeof(unsigned int);
+}
+
+static unsigned int worker_resident_image(const asset_metadata_image_t* image) {
+    if (image->mips == NULL) {
+        return worker_resident_level(image->format, image->width, image->height);
+    }
+    unsigned int resident = 0;
+    for (unsigned int i = image->level; i < image->level_count; i++) {
+        resident += worker_resident_level(image->mips[i].format, image->mips[i].width, image->mips[i].height);
+    }
+    return resident;
+}
+
+static unsigned int worker_resident(const unsigned char type, const asset_metadata_u* meta) {
+    switch (type) {
+    case ASSET_TYPE_SHADER_VERTEX:
+    case ASSET_TYPE_SHADER_FRAGMENT: return meta->shader.size;
+    case ASSET_TYPE_IMAGE:           return worker_resident_image(&meta->image);
+    case ASSET_TYPE_AUDIO:           return meta->audio.samples * meta->audio.channels * sizeof(signed short);
+    case ASSET_TYPE_MODEL:           return meta->model.size;
+    case ASSET_TYPE_SCENE:           return meta->scene.size + meta->scene.scene.reference_count * (unsigned int)sizeof(asset_t*);
+    case ASSET_TYPE_SPRITE:          return 0;
+    default:                         return meta->embed.size;
+    }
+}
+
+bool_t registry_unsafe_free_meta(asset_t* a) {
+    switch (a->type) {
+    case ASSET_TYPE_SHADER_VERTEX:
+    case ASSET_TYPE_SHADER_FRAGMENT:
+    case ASSET_TYPE_IMAGE:
+    case ASSET_TYPE_MODEL: {
+        // The render thread may still be using these, hand them over so it can
+        // release them once no frame in flight can reference them anymore.
+        render_command_t command = {
+            .type = RENDER_COMMAND_RELEASE,
+            .asset_type = a->type,
+            .meta = *assets_meta(a),
+        };
+        if (!render_command_push(&command)) {
+            return FALSE;
+        }
+        memset(assets_meta(a), 0, sizeof(asset_metadata_u));
+        break;
+    }
+    default: {
+        registry_release_meta(a->type, assets_meta(a));
+        break;
+    }
+    }
+    registry_account(registry, a->type, ASSET_ACCOUNT_EVICT, -(long long)a->resident);
+    a->resident = 0;
+    return TRUE;
+}
+
+void registry_free(asset_registry_t* r) {
+    pthread_mutex_lock(&r->mtx);
+    if (r->assets) {
+        for (unsigned int i = 0; i < r->size; i++) {
+            asset_t* a = &r->assets[i];
+            a->name = NULL;
+            free(a->mip_ends);
+            a->mip_ends = NULL;
+            registry_release_meta(a->type, &a->meta[0]);
+            registry_release_meta(a->type, &a->meta[1]);
+        }
+        free(r->assets);
+        r->assets = NULL;
+    }
+    free(r->states);
+    free(r->types);
+    free(r->name_hashes);
+    free(r->table);
+    free(r->refs_block);
+    r->states = NULL;
+    r->types = NULL;
+    r->name_hashes = NULL;
+    r->table = NULL;
+    r->table_mask = 0;
+    r->refs_block = NULL;
+    r->refs = NULL;
+    for (unsigned int i = 0; i < ASSET_ARCHIVE_LIMIT; i++) {
+        free(r->names[i]);
+        free(r->entries[i]);
+        r->names[i] = NULL;
+        r->entries[i] = NULL;
+        r->entry_counts[i] = 0;
+    }
+    for (unsigned int i = 0; i < r->names_retired_count; i++) {
+        free(r->names_retired[i]);
+    }
+    free(r->names_retired);
+    r->names_retired = NULL;
+    r->names_retired_count = 0;
+    r->capacity = 0;
+    r->size = 0;
+    pthread_mutex_unlock(&r->mtx);
+    pthread_mutex_destroy(&r->mtx);
+}
+
+// Evict a single asset, fails if it was acquired or touched since it was sampled
+static bool_t registry_unsafe_evict(asset_registry_t* r, unsigned int index, unsigned int last_used) {
+    asset_ref_t* ref = &r->refs[index];
+    if (atomic_load(&ref->used) > 0 || atomic_load(&ref->last_used) != last_used) {
+        return FALSE;
+    }
+    asset_state_t expect = ASSET_STATE_DONE;
+    if (!atomic_compare_exchange_strong(&r->states[index], &expect, ASSET_STATE_EVICT)) {
+        return FALSE;
+    }
+    // Mip levels are asked for again by whoever acquires it next
+    unsigned int request = atomic_exchange(&ref->mip_request, ASSET_MIP_LIMIT);
+
+    // Acquired while we were claiming it, keep it around
+    if (atomic_load(&ref->used) > 0 || !registry_unsafe_free_meta(&r->assets[index])) {
+        registry_request_level(ref, request);
+        registry_publish(r, index);
+        return FALSE;
+    }
+    atomic_store(&r->states[index], ASSET_STATE_DISK);
+
+    // Let the cache drop the payload too, the decoded copy was the one in use
+    asset_t* a = &r->assets[index];
+    if (a->archive_id < archive_count && archive_hint[a->archive_id] >= 0) {
+        read_hint(archive_hint[a->archive_id], a->archive_offset, a->archive_length, READ_HINT_DONTNEED);
+    }
+    return TRUE;
+}
+
+static int registry_candidate_compare(const void* a, const void* b) {
+    unsigned int la = ((const asset_candidate_t*)a)->last_used;
+    unsigned int lb = ((const asset_candidate_t*)b)->last_used;
+    return (la > lb) - (la < lb);
+}
+
+// Candidates are kept as a max-heap on last_used so the root is always the most
+// recently used candidate, which is the first one replaced by an older asset.
+static void registry_candidate_sift(asset_candidate_t* heap, unsigned int count, unsigned int i) {
+    while (TRUE) {
+        unsigned int l = i * 2 + 1, r = i * 2 + 2, top = i;
+        if (l < count && heap[l].last_used > heap[top].last_used) top = l;
+        if (r < count && heap[r].last_used > heap[top].last_used) top = r;
+        if (top == i) {
+            return;
+        }
+        asset_candidate_t t = heap[i];
+        heap[i] = heap[top];
+        heap[top] = t;
+        i = top;
+    }
+}
+
+static void registry_candidate_offer(asset_registry_t* r, unsigned int index) {
+    asset_candidate_t* heap = r->collect_candidates;
+    asset_candidate_t c = { .index = index, .last_used = atomic_load(&r->refs[index].last_used) };
+    if (r->collect_count < ASSET_REGISTRY_COLLECT_CANDIDATES) {
+        unsigned int i = r->collect_count++;
+        heap[i] = c;
+        while (i > 0 && heap[(i - 1) / 2].last_used < heap[i].last_used) {
+            asset_candidate_t t = heap[i];
+            heap[i] = heap[(i - 1) / 2];
+            heap[(i - 1) / 2] = t;
+            i = (i - 1) / 2;
+        }
+    }
+    else if (c.last_used < heap[0].last_used) {
+        heap[0] = c;
+        registry_candidate_sift(heap, r->collect_count, 0);
+    }
+}
+
+void registry_collect_step(asset_registry_t* r, double slice, unsigned long long target) {
+    double start = time_monotonic();
+    pthread_mutex_lock(&r->mtx);
+
+    // Pressure may lower the target of a pass that is already underway
+    if (r->collect_cursor == 0 || target < r->collect_target) {
+        r->collect_target = target;
+    }
+
+    // Sample unused assets, keeping the least recently used ones
+    while (r->collect_cursor < r->size) {
+        unsigned int index = r->collect_cursor++;
+        if (
+            atomic_load(&r->states[index]) == ASSET_STATE_DONE &&
+            atomic_load(&r->refs[index].used) == 0
+            ) {
+            registry_candidate_offer(r, index);
+        }
+        if ((r->collect_cursor & 63) == 0 && time_monotonic() - start > slice) {
+            pthread_mutex_unlock(&r->mtx);
+            return;
+        }
+    }
+
+    // Evict oldest first until we're back under budget
+    qsort(r->collect_candidates, r->collect_count, sizeof(asset_candidate_t), registry_candidate_compare);
+    unsigned int evicted = 0;
+    unsigned long long freed = 0;
+    for (unsigned int i = 0; i < r->collect_count; i++) {
+        if (atomic_load(&r->stats[ASSET_STATS_TOTAL].resident) <= r->collect_target) {
+            break;
+        }
+        asset_candidate_t* c = &r->collect_candidates[i];
+        unsigned int size = r->assets[c->index].resident;
+        if (registry_unsafe_evict(r, c->index, c->last_used)) {
+            freed += size;
+            evicted++;
+        }
+    }
+    r->collect_cursor = 0;
+    r->collect_count = 0;
+    pthread_mutex_unlock(&r->mtx);
+
+    if (evicted > 0) {
+        logger(LDEBUG, OASSET, "Evicted %d Asset(s) (%.2fKB) . %.2fMB Resident",
+            evicted, freed / 1024.00, atomic_load(&r->stats[ASSET_STATS_TOTAL].resident) / 1048576.00);
+    }
+}
+
+asset_t* assets_unsafe_find(const asset_type_t find_type, const char* find_name) {
+    if (registry->table == NULL) {
+        return NULL;
+    }
+    unsigned int find_hash = crc32((const unsigned char*)find_name, (int)strlen(find_name));
+    unsigned int slot = registry_unsafe_probe(registry, find_type, find_hash, find_name);
+    if (registry->table[slot] == 0) {
+        return NULL;
+    }
+    return &registry->assets[registry->table[slot] - 1];
+}
+
+asset_state_t assets_state(const asset_t* a) {
+    asset_state_t state = atomic_load(&registry->states[assets_index(a)]);
+    if (state == ASSET_STATE_STALE || state == ASSET_STATE_RELOAD) {
+        state = ASSET_STATE_DONE;   // Previous version remains usable
+    }
+    if (state == ASSET_STATE_PREFETCH) {
+        return ASSET_STATE_WAIT;
+    }
+    if (state == ASSET_STATE_DONE && a->type == ASSET_TYPE_SPRITE) {
+        return assets_state(assets_meta((asset_t*)a)->sprite.page);
+    }
+    return state;
+}
+
+static void assets_set_state(asset_t* a, const asset_state_t state) {
+    atomic_store(&registry->states[assets_index(a)], state);
+}
+
+void assets_publish(asset_t* a) {
+    registry_publish(registry, assets_index(a));
+}
+
+asset_metadata_u assets_unsafe_swap(asset_t* a) {
+    unsigned char front = atomic_load(&a->meta_front);
+    asset_metadata_u retired = a->meta[front];
+    unsigned int resident = worker_resident(a->type, &a->meta[front ^ 1]);
+    atomic_store(&a->meta_front, front ^ 1);
+    memset(&a->meta[front], 0, sizeof(asset_metadata_u));
+    if (a->type == ASSET_TYPE_IMAGE) {
+        atomic_store(&registry->refs[assets_index(a)].mip_loaded, a->meta[front ^ 1].image.level);
+    }
+
+    // Swap Accounting
+    registry_account(registry, a->type, ASSET_ACCOUNT_RESIZE, (long long)resident - (long long)a->resident);
+    a->resident = resident;
+    return retired;
+}
+
+// Remember when an asset was first used, so the next run can prefetch it
+static void assets_trace_record(asset_t* a) {
+    pthread_mutex_lock(&trace_mutex);
+    if (trace_recorded_count == trace_recorded_capacity) {
+        unsigned int capacity = trace_recorded_capacity + ASSET_TRACE_GROWTH;
+        asset_trace_t* recorded = realloc(trace_recorded, capacity * sizeof(asset_trace_t));
+        if (recorded == NULL) {
+            pthread_mutex_unlock(&trace_mutex);
+            logger(LWARN, OASSET, "Unable to Trace '%s' (%s)", a->name, strerror(errno));
+            return;
+        }
+        trace_recorded = recorded;
+        trace_recorded_capacity = capacity;
+    }
+    trace_recorded[trace_recorded_count++] = (asset_trace_t) {
+        .asset = a,
+        .frame = atomic_load(&registry->clock),
+        .time = time_monotonic() - trace_start,
+    };
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+// Bytes of a payload needed for the given mip level, mipmapped images whose level table
+// wasn't read yet start with a probe of their first bytes.
+// - This function is not thread safe and assumes you have manually locked the mutex.
+static unsigned int registry_unsafe_read_length(const asset_t* a, unsigned int level, bool_t* probe) {
+    *probe = FALSE;
+    if (a->type != ASSET_TYPE_IMAGE || !(a->flag & ASSET_FLAG_MIPMAPPED)) {
+        return a->archive_length;
+    }
+    if (a->mip_ends) {
+        return a->mip_ends[level < a->mip_count ? level : a->mip_count - 1];
+    }
+    if (a->archive_length > ASSET_MIP_PROBE) {
+        *probe = TRUE;
+        return ASSET_MIP_PROBE;
+    }
+    return a->archive_length;
+}
+
+static void assets_hint_flush(worker_read_t* ranges, unsigned int count) {
+    qsort(ranges, count, sizeof(worker_read_t), worker_read_compare);
+    unsigned int i = 0;
+    while (i < count) {
+        unsigned long long start = ranges[i].archive_offset;
+        unsigned long long end = start + ranges[i].archive_length;
+        unsigned int last = i + 1;
+        while (last < count &&
+            ranges[last].archive_id == ranges[i].archive_id &&
+            ranges[last].archive_offset <= end + ASSET_READ_GAP) {
+            unsigned long long next = ranges[last].archive_offset + (unsigned long long)ranges[last].archive_length;
+            if (next > end) end = next;
+            last++;
+        }
+        read_hint(archive_hint[ranges[i].archive_id], start, end - start, READ_HINT_WILLNEED);
+        i = last;
+    }
+}
+
+// Ask the kernel to start fetching payloads of queued assets, so the disk is busy
+// while the reader is still working through what was queued before them.
+static void assets_hint_load(asset_t** assets, unsigned int count) {
+    worker_read_t ranges[ASSET_READ_BATCH];
+    unsigned int ranged = 0;
+    pthread_mutex_lock(&registry->mtx);
+    for (unsigned int i = 0; i < count; i++) {
+        asset_t* a = assets[i];
+        if (a->archive_id >= archive_count || archive_hint[a->archive_id] < 0) {
+            continue;
+        }
+        bool_t probe;
+        unsigned int level = atomic_load(&registry->refs[assets_index(a)].mip_request);
+        ranges[ranged++] = (worker_read_t) {
+            .archive_id = a->archive_id,
+            .archive_offset = a->archive_offset,
+            .archive_length = registry_unsafe_read_length(a, level, &probe),
+        };
+        if (ranged == ASSET_READ_BATCH) {
+            assets_hint_flush(ranges, ranged);
+            ranged = 0;
+        }
+    }
+    if (ranged > 0) {
+        assets_hint_flush(ranges, ranged);
+    }
+    pthread_mutex_unlock(&registry->mtx);
+}
+
+// Queue an asset ahead of its use, returns TRUE if it was queued
+static bool_t assets_prefetch_queue(asset_t* a) {
+    unsigned int index = assets_index(a);
+    // Stamp it, otherwise the collector sees it as the oldest unused asset
+    atomic_store(&registry->refs[index].last_used, atomic_load(&registry->clock));
+    registry_request_level(&registry->refs[index], 0);
+    asset_state_t expect = ASSET_STATE_DISK;
+    return atomic_compare_exchange_strong(&registry->states[index], &expect, ASSET_STATE_PREFETCH);
+}
+
+void assets_prefetch(asset_t* a) {
+    if (assets_prefetch_queue(a)) {
+        assets_hint_load(&a, 1);
+        worker_signal(a, TRUE);
+    }
+}
+
+// Reference an asset and queue it if it's on the disk, returns TRUE if it was queued.
+// Images that are loaded but coarser than 'level' are queued for a reload instead.
+static bool_t assets_acquire_queue(asset_t* a, unsigned int level) {
+    unsigned int index = assets_index(a);
+    atomic_fetch_add(&registry->refs[index].used, 1);
+    if (trace_path && atomic_exchange(&registry->refs[index].traced, 1) == 0) {
+        assets_trace_record(a);
+    }
+    // An eviction either sees our reference or forgot its levels before it
+    registry_request_level(&registry->refs[index], level);
+    while (TRUE) {
+        asset_state_t expect = ASSET_STATE_DISK;
+        if (atomic_compare_exchange_strong(&registry->states[index], &expect, ASSET_STATE_WAIT)) {
+            return TRUE;
+        }
+        if (expect == ASSET_STATE_PREFETCH) {
+            // Needed now, move it ahead of the remaining prefetches
+            if (atomic_compare_exchange_strong(&registry->states[index], &expect, ASSET_STATE_WAIT)) {
+                worker_queue(a, FALSE);
+                return FALSE;
+            }
+            continue;
+        }
+        if (expect != ASSET_STATE_EVICT) {
+            // Loading or loaded, anything still loading is refreshed once published
+            registry_refresh(registry, index);
+            return FALSE;
+        }
+        // Collector is mid-eviction, it either sees our reference or finishes
+        // evicting in which case we need to request it again.
+        time_sleep(0);
+    }
+}
+
+void assets_acquire(asset_t* a) {
+    assets_acquire_level(a, 0);
+}
+
+void assets_acquire_level(asset_t* a, unsigned int level) {
+    if (assets_acquire_queue(a, level)) {
+        assets_hint_load(&a, 1);
+        worker_signal(a, FALSE);
+    }
+}
+
+void assets_acquire_batch(asset_t** assets, unsigned int count) {
+    asset_t* queued[ASSET_READ_BATCH];
+    unsigned int queued_count = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (assets[i] && assets_acquire_queue(assets[i], 0)) {
+            queued[queued_count++] = assets[i];
+        }
+        if (queued_count == ASSET_READ_BATCH || (i + 1 == count && queued_count > 0)) {
+            assets_hint_load(queued, queued_count);
+            worker_signal_batch(queued, queued_count, FALSE);
+            queued_count = 0;
+        }
+    }
+}
+
+void assets_release(asset_t* a) {
+    asset_ref_t* ref = &registry->refs[assets_index(a)];
+    if (atomic_fetch_sub(&ref->used, 1) == 1) {
+        // Last reference, stamp it so the collector evicts the oldest assets first
+        atomic_store(&ref->last_used, atomic_load(&registry->clock));
+    }
+}
+
+bool_t assets_stats(const unsigned char type, asset_stats_t* out) {
+    if (type >= ASSET_STATS_LIMIT) {
+        return FALSE;
+    }
+    asset_counter_t* c = &registry->stats[type];
+    out->resident = atomic_load(&c->resident);
+    out->peak = atomic_load(&c->peak);
+    out->count = atomic_load(&c->count);
+    out->loads = atomic_load(&c->loads);
+    out->evictions = atomic_load(&c->evictions);
+    return TRUE;
+}
+
+static void assets_stats_log(void) {
+    char line[LOG_BUFFER_ENTRIES / 2];
+    asset_stats_t stats;
+    assets_stats(ASSET_STATS_TOTAL, &stats);
+    int length = snprintf(line, sizeof(line), "%.2fMB (Peak %.2fMB) in %d Asset(s), %d Load(s), %d Eviction(s)",
+        stats.resident / 1048576.00, stats.peak / 1048576.00, stats.count, stats.loads, stats.evictions);
+
+    // Break down by Type, skipping types which were never loaded
+    for (unsigned char t = ASSET_STATS_TOTAL + 1; t < ASSET_STATS_LIMIT; t++) {
+        if (length < 0 || (size_t)length >= sizeof(line)) {
+            break;
+        }
+        assets_stats(t, &stats);
+        if (stats.loads == 0) {
+            continue;
+        }
+        length += snprintf(line + length, sizeof(line) - (size_t)length, " | %s %.2fMB/%d",
+            asset_str_type(t), stats.resident / 1048576.00, stats.count);
+    }
+    logger(LDEBUG, OASSET, "Memory : %s", line);
+}
+
+// Milliseconds on the monotonic clock, 0 is reserved for "no retry time"
+static unsigned int worker_clock(void) {
+    unsigned int now = (unsigned int)(unsigned long long)(time_monotonic() * 1000.0);
+    return now ? now : 1;
+}
+
+// Claim a single queued asset into 'read'. Returns 1 if it was claimed, 0 if it isn't
+// queued anymore (another entry got to it first) or -1 for a retry that isn't due yet,
+// which is put back as it was.
+static int worker_claim_index(unsigned int i, bool_t prefetch, unsigned int now, worker_read_t* read) {
+    // Look before locking the line, most assets a scan passes aren't queued
+    asset_state_t expect = (asset_state_t)atomic_load_explicit(&registry->states[i], memory_order_relaxed);
+    asset_state_t claim;
+    if (expect == (prefetch ? ASSET_STATE_PREFETCH : ASSET_STATE_WAIT)) {
+        claim = ASSET_STATE_BUSY;
+    }
+    else if (!prefetch && expect == ASSET_STATE_STALE) {
+        claim = ASSET_STATE_RELOAD;
+    }
+    else {
+        return 0;
+    }
+    asset_state_t queued = expect;
+    if (!atomic_compare_exchange_strong(&registry->states[i], &expect, claim)) {
+        return 0;
+    }
+
+    // Retries wait for their time, only the reader claims so the state can be put back
+    unsigned int retry = atomic_load(&registry->refs[i].retry);
+    if (retry != 0) {
+        if ((int)(retry - now) > 0) {
+            atomic_store(&registry->states[i], queued);
+            return -1;
+        }
+        atomic_store(&registry->refs[i].retry, 0);
+        atomic_fetch_sub(&worker_deferred, 1);
+    }
+    else {
+        atomic_fetch_sub(&worker_pending, 1);
+    }
+    // Anything marked stale from here on is caught when the asset is published
+    atomic_store(&registry->refs[i].stale, 0);
+    *read = (worker_read_t) { .asset = &registry->assets[i], .reload = claim == ASSET_STATE_RELOAD };
+    return 1;
+}
+
+// Remember a retry claimed too early, without room the next claim looks through every asset
+static void worker_defer(unsigned int index) {
+    if (!worker_queue_push(&worker_retries, index)) {
+        atomic_store(&worker_rescan, 1);
+    }
+}
+
+// Claim queued assets, either first loads or reloads of assets in use. Prefetches
+// are only claimed once nothing that is actually in use is waiting.
+static unsigned int worker_claim(worker_read_t* batch, unsigned int limit) {
+    unsigned int count = 0;
+    unsigned int now = worker_clock();
+
+    // Retries which came due
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < worker_retries.count; i++) {
+        unsigned int index = worker_retries.indices[i];
+        unsigned int retry = atomic_load(&registry->refs[index].retry);
+        int claimed = -1;
+        if (count < limit && (retry == 0 || (int)(retry - now) <= 0)) {
+            claimed = worker_claim_index(index, FALSE, now, &batch[count]);
+        }
+        if (claimed > 0) {
+            count++;
+        }
+        else if (claimed < 0) {
+            worker_retries.indices[kept++] = index;
+        }
+    }
+    worker_retries.count = kept;
+
+    // Queued Assets
+    unsigned int indices[ASSET_READ_BATCH];
+    for (unsigned int pass = 0; pass < 2 && (pass == 0 || count == 0); pass++) {
+        worker_queue_t* q = pass ? &worker_queued_prefetch : &worker_queued;
+        while (count < limit) {
+            unsigned int want = limit - count < ASSET_READ_BATCH ? limit - count : ASSET_READ_BATCH;
+            pthread_mutex_lock(&worker_mutex);
+            unsigned int popped = worker_queue_pop(q, indices, want);
+            pthread_mutex_unlock(&worker_mutex);
+            if (popped == 0) {
+                break;
+            }
+            for (unsigned int i = 0; i < popped; i++) {
+                int claimed = worker_claim_index(indices[i], pass, now, &batch[count]);
+                if (claimed > 0) {
+                    count++;
+                }
+                else if (claimed < 0) {
+                    worker_defer(indices[i]);
+                }
+            }
+        }
+    }
+
+    // Queueing ran out of memory at some point, look through every asset instead
+    if (count < limit && atomic_exchange(&worker_rescan, 0)) {
+        for (unsigned int pass = 0; pass < 2 && (pass == 0 || count == 0); pass++) {
+            for (unsigned int i = 0; i < registry->size && count < limit; i++) {
+                int claimed = worker_claim_index(i, pass, now, &batch[count]);
+                if (claimed > 0) {
+                    count++;
+                }
+                else if (claimed < 0) {
+                    worker_defer(i);
+                }
+            }
+        }
+        if (count == limit) {
+            atomic_store(&worker_rescan, 1);  // More may be left
+        }
+    }
+    return count;
+}
+
+// Put a claimed asset back into the queue, a delay (seconds) makes the reader skip it
+// until then instead of holding up the calling worker.
+static void worker_requeue(asset_t* a, bool_t reload, double delay) {
+    if (delay <= 0) {
+        assets_set_state(a, reload ? ASSET_STATE_STALE : ASSET_STATE_WAIT);
+        worker_signal(a, FALSE);
+        return;
+    }
+    unsigned int retry = worker_clock() + (unsigned int)(delay * 1000.0);
+    atomic_store(&registry->refs[assets_index(a)].retry, retry ? retry : 1);
+    atomic_fetch_add(&worker_deferred, 1);
+    assets_set_state(a, reload ? ASSET_STATE_STALE : ASSET_STATE_WAIT);
+    pthread_mutex_lock(&worker_mutex);
+    worker_unsafe_queue(&a, 1, FALSE);
+    pthread_cond_broadcast(&worker_cond);
+    pthread_mutex_unlock(&worker_mutex);
+}
+
+// Wait on a condition for at most 'secs' seconds, the mutex must be locked
+static void worker_wait_for(pthread_cond_t* cond, pthread_mutex_t* mutex, double secs) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    long long nanoseconds = ts.tv_nsec + (long long)(secs * 1e9);
+    ts.tv_sec += (time_t)(nanoseconds / 1000000000);
+    ts.tv_nsec = (long)(nanoseconds % 1000000000);
+    pthread_cond_timedwait(cond, mutex, &ts);
+}
+
+// Give up on a claimed asset
+static void worker_abandon(asset_t* a, bool_t reload) {
+    if (reload) {
+        // Keep using the previous version, forgetting finer mip levels that were asked
+        // for as publishing would otherwise queue it again right away
+        asset_ref_t* ref = &registry->refs[assets_index(a)];
+        atomic_store(&ref->mip_request, atomic_load(&ref->mip_loaded));
+        assets_publish(a);
+    }
+    else {
+        // Leave it on the disk, the engine is exiting or the failure was logged as an
+        // error which requests shutdown
+        assets_set_state(a, ASSET_STATE_DISK);
+    }
+}
+
+// Types which keep their payload need an allocation of their own
+static bool_t worker_keep(asset_worker_args_t* args, asset_t* a, unsigned char** payload, unsigned int length, bool_t owned) {
+    if (owned) {
+        return TRUE;
+    }
+    unsigned char* copy = malloc(length ? length : 1);
+    if (copy == NULL) {
+        logger(LERROR, OASSET, "(%d) '%s' Memory Error: %s", args->id, a->name, strerror(errno));
+        return FALSE;
+    }
+    memcpy(copy, *payload, length);
+    *payload = copy;
+    return TRUE;
+}
+
+// Bring decoded pixels into the presented layout, images packed in it are left as they are
+static void worker_present(const worker_read_t* read, unsigned int* pixels, unsigned int width, unsigned int height) {
+    pixel_present(pixels, (size_t)width * height,
+        !(read->flag & ASSET_FLAG_BGRA), !(read->flag & ASSET_FLAG_PREMULTIPLIED));
+}
+
+// Decode an image stream into a level. QOI streams are expanded to pixels, block
+// compressed ones keep their blocks and are only checked.
+static bool_t worker_decode_level(asset_worker_args_t* args, const worker_read_t* read, const unsigned char* stream, unsigned int length, unsigned char severity, asset_mip_t* level, bool_t* linear) {
+    asset_t* a = read->asset;
+    if (length >= BC_HEADER_SIZE && peek_u32_le(stream) == MAGIC_BCNX) {
+        unsigned int format = 0;
+        bc_error_t result = bc_read_header(stream, length, &format, &level->width, &level->height);
+        if (result != BC_OK) {
+            logger(severity, OASSET, "(%d) '%s' Block decoding error, please refer to the manual. Error Code: %d",
+                args->id, a->name, result);
+            return FALSE;
+        }
+        size_t size = bc_length(format, level->width, level->height);
+        level->blocks = malloc(size);
+        if (level->blocks == NULL) {
+            logger(LERROR, OASSET, "(%d) '%s' Memory Error: %s", args->id, a->name, strerror(errno));
+            return FALSE;
+        }
+        memcpy(level->blocks, stream + BC_HEADER_SIZE, size);
+        level->format = (unsigned char)format;
+        *linear = stream[BC_COLORSPACE] == 1;
+        return TRUE;
+    }
+    qoi_error_t result = qoi_decode(stream, length, &level->pixels, &level->width, &level->height);
+    if (result != QOI_OK) {
+        logger(severity, OASSET, "(%d) '%s' QOI decoding error, please refer to the manual. Error Code: %d",
+            args->id, a->name, result);
+        return FALSE;
+    }
+    worker_present(read, level->pixels, level->width, level->height);
+    *linear = stream[QOI_COLORSPACE] == 1;
+    return TRUE;
+}
+
+// Decode the mip levels of an image down to the one that was asked for, coarser levels
+// are decoded too. Only the start of the payload up to that level has to be present.
+static bool_t worker_decode_mips(asset_worker_args_t* args, const worker_read_t* read, const unsigned char* payload, unsigned char severity, asset_metadata_u* meta) {
+    asset_t* a = read->asset;
+    unsigned int levels = 0, ends[MIP_LEVEL_LIMIT], hashes[MIP_LEVEL_LIMIT];
+    mip_error_t table = mip_read_table(payload, read->length, read->archive_length, &levels, ends, hashes);
+    if (table != MIP_OK) {
+        logger(severity, OASSET, "(%d) '%s' Mip Table decoding error, please refer to the manual. Error Code: %d",
+            args->id, a->name, table);
+        return FALSE;
+    }
+    unsigned int level = read->level < levels ? read->level : levels - 1;
+    if (ends[level] > read->length) {
+        logger(severity, OASSET, "(%d) '%s' Reached EOF when attempting to read Mip Level %d",
+            args->id, a->name, level);
+        return FALSE;
+    }
+    asset_metadata_image_t* image = &meta->image;
+    image->mips = calloc(levels, sizeof(asset_mip_t));
+    if (image->mips == NULL) {
+        logger(LERROR, OASSET, "(%d) '%s' Memory Error: %s", args->id, a->name, strerror(errno));
+        return FALSE;
+    }
+    image->level_count = levels;
+    image->level = level;
+    for (unsigned int i = level; i < levels; i++) {
+        unsigned int start = mip_level_start(ends, levels, i);
+        if (!worker_decode_level(args, read, payload + start, ends[i] - start, severity, &image->mips[i], &image->linear)) {
+            logger(severity, OASSET, "(%d) '%s' Failed to decode Mip Level %d", args->id, a->name, i);
+            registry_release_meta(a->type, meta);
+            return FALSE;
+        }
+    }
+    image->pixels = image->mips[level].pixels;
+    image->blocks = image->mips[level].blocks;
+    image->format = image->mips[level].format;
+    image->width = image->mips[level].width;
+    image->height = image->mips[level].height;
+    return TRUE;
+}
+
+// Locate the atlas page of a sprite and hold on to it for as long as the sprite is loaded
+static bool_t worker_decode_sprite(asset_worker_args_t* args, const worker_read_t* read, const unsigned char* payload, unsigned char severity, asset_metadata_u* meta) {
+    asset_t* a = read->asset;
+    char page_name[1024];
+    unsigned int name_length = read->length >= ASSET_SPRITE_SIZE ? peek_u16_le(payload + 24) : 0;
+    if (read->length < ASSET_SPRITE_SIZE || name_length >= sizeof(page_name) || ASSET_SPRITE_SIZE + name_length > read->length) {
+        logger(severity, OASSET, "(%d) '%s' Sprite Entry is malformed", args->id, a->name);
+        return FALSE;
+    }
+    memcpy(page_name, payload + ASSET_SPRITE_SIZE, name_length);
+    page_name[name_length] = '\0';
 
-        // Track Offsets
-        offset_binary += size;
-        logger(LDEBUG, OASSET,
-            "%03d : '%-30s' %8s . 0x%08X . 0x%02X . %8.2fKB",
-            i + 1, name, asset_str_type(type), hash, flag, size / 1024.00
-        );
+    asset_metadata_sprite_t* sprite = &meta->sprite;
+    sprite->x = peek_u32_le(payload + 0);
+    sprite->y = peek_u32_le(payload + 4);
+    sprite->width = peek_u32_le(payload + 8);
+    sprite->height = peek_u32_le(payload + 12);
+    unsigned int page_width = peek_u32_le(payload + 16);
+    unsigned int page_height = peek_u32_le(payload + 20);
+    if (page_width == 0 || page_height == 0 ||
+        sprite->x + (unsigned long long)sprite->width > page_width ||
+        sprite->y + (unsigned long long)sprite->height > page_height) {
+        logger(severity, OASSET, "(%d) '%s' Sprite Rectangle lies outside of its Page", args->id, a->name);
+        return FALSE;
     }
+    sprite->u0 = (float)sprite->x / (float)page_width;
+    sprite->v0 = (float)sprite->y / (float)page_height;
+    sprite->u1 = (float)(sprite->x + sprite->width) / (float)page_width;
+    sprite->v1 = (float)(sprite->y + sprite->height) / (float)page_height;
 
-    // Adjust Read Offset for Archive Header, otherwise we'll be way off...
-    unsigned int offset_header = ftell(archive_handle);
-    for (unsigned int i = 0; i < entries; i++) {
-        r->assets[offset_index + i].archive_offset += offset_header;
+    // The lookup table may be rebuilt by a reload
+    pthread_mutex_lock(&registry->mtx);
+    sprite->page = assets_unsafe_find(ASSET_TYPE_IMAGE, page_name);
+    pthread_mutex_unlock(&registry->mtx);
+    if (sprite->page == NULL) {
+        logger(severity, OASSET, "(%d) '%s' Atlas Page '%s' is missing", args->id, a->name, page_name);
+        return FALSE;
     }
+    assets_acquire(sprite->page);
+    return TRUE;
+}
 
-    fclose(archive_handle);
+// Validate the records of a scene and resolve its references, which are indices into
+// the manifest of the archive the scene was read from.
+static bool_t worker_decode_scene(asset_worker_args_t* args, const worker_read_t* read, unsigned char* payload, unsigned char severity, asset_metadata_u* meta) {
+    asset_t* a = read->asset;
+    asset_metadata_scene_t* scene = &meta->scene;
+    scene_error_t result = scene_read(payload, read->length, &scene->scene);
+    if (result != SCENE_OK) {
+        logger(severity, OASSET, "(%d) '%s' Scene decoding error, please refer to the manual. Error Code: %d",
+            args->id, a->name, result);
+        return FALSE;
+    }
+    unsigned int count = scene->scene.reference_count;
+    asset_t** assets = calloc(count > 0 ? count : 1, sizeof(asset_t*));
+    if (assets == NULL) {
+        logger(severity, OASSET, "(%d) '%s' Failed to Allocate Memory for %d References (%s)",
+            args->id, a->name, count, strerror(errno));
+        return FALSE;
+    }
+
+    // The index table may be rebuilt by a reload
+    bool_t resolved = TRUE;
+    pthread_mutex_lock(&registry->mtx);
+    unsigned int archive_id = a->archive_id;
+    for (unsigned int i = 0; i < count && resolved; i++) {
+        const scene_reference_t* reference = &scene->scene.references[i];
+        unsigned int index = archive_id < ASSET_ARCHIVE_LIMIT && reference->asset < registry->entry_counts[archive_id] ?
+            registry->entries[archive_id][reference->asset] : 0;
+        resolved = index != 0 && registry->types[index - 1] == reference->type;
+        if (resolved) {
+            assets[i] = &registry->assets[index - 1];
+        }
+    }
+    pthread_mutex_unlock(&registry->mtx);
+    if (!resolved) {
+        logger(severity, OASSET, "(%d) '%s' Scene refers to an Asset missing from its Archive", args->id, a->name);
+        free(assets);
+        return FALSE;
+    }
+    scene->data = payload;
+    scene->size = read->length;
+    scene->assets = assets;
     return TRUE;
 }
 
-void registry_unsafe_free_meta(asset_t* a) {
+// Decode a payload that was read from the archive and publish it. Types which keep
+// their payload take over 'payload' when it is 'owned', otherwise they copy it.
+static bool_t worker_decode(asset_worker_args_t* args, const worker_read_t* read, unsigned char* payload, bool_t owned) {
+    asset_t* a = read->asset;
+    unsigned int length = read->length;
+    asset_metadata_u meta;
+    bool_t upload = FALSE;
+    bool_t keep = FALSE;
+    memset(&meta, 0, sizeof(meta));
 
-    // TODO: GPU related stuff should push commands to an atomic ring style command
-    // buffer so that the render thread can periodically scan and process them.
-    // That's my idea at least...
+    // A broken reload keeps the previous version around instead of shutting down
+    unsigned char severity = read->reload ? LWARN : LERROR;
 
+    // Decode Payload
     switch (a->type) {
-    case ASSET_TYPE_EMBEDDED: {
-        free(a->meta.embed.data);
-        a->meta.embed.data = NULL;
-        a->meta.embed.size = 0;
+    case ASSET_TYPE_EMBEDDED:
+    case ASSET_TYPE_SCRIPT: {
+        if (!worker_keep(args, a, &payload, length, owned)) {
+            return FALSE;
+        }
+        meta.embed.data = payload;
+        meta.embed.size = length;
+        keep = TRUE;
+        break;
+    }
+    case ASSET_TYPE_MODEL: {
+        // The mesh is used straight out of the payload
+        if (!worker_keep(args, a, &payload, length, owned)) {
+            return FALSE;
+        }
+        mesh_error_t result = mesh_read(payload, length, &meta.model.mesh);
+        if (result != MESH_OK) {
+            logger(severity, OASSET, "(%d) '%s' Mesh decoding error, please refer to the manual. Error Code: %d",
+                args->id, a->name, result);
+            free(payload);
+            return FALSE;
+        }
+        meta.model.data = payload;
+        meta.model.size = length;
+        keep = TRUE;
+        upload = TRUE;
+        break;
+    }
+    case ASSET_TYPE_SCENE: {
+        // The records are used straight out of the payload
+        if (!worker_keep(args, a, &payload, length, owned)) {
+            return FALSE;
+        }
+        if (!worker_decode_scene(args, read, payload, severity, &meta)) {
+            free(payload);
+            return FALSE;
+        }
+        keep = TRUE;
         break;
     }
     case ASSET_TYPE_SHADER_VERTEX:
     case ASSET_TYPE_SHADER_FRAGMENT: {
-        // TODO: Free from CPU & GPU Memory (from here somehow?)
+        if (!worker_keep(args, a, &payload, length, owned)) {
+            return FALSE;
+        }
+        meta.shader.code = payload;
+        meta.shader.size = length;
+        keep = TRUE;
+        upload = TRUE;
         break;
     }
     case ASSET_TYPE_IMAGE: {
-        // TODO: Free from CPU & GPU Memory (from here somehow?)
+        if (read->flag & ASSET_FLAG_MIPMAPPED) {
+            if (!worker_decode_mips(args, read, payload, severity, &meta)) {
+                if (owned) free(payload);
+                return FALSE;
+            }
+            upload = TRUE;
+            break;
+        }
+        asset_mip_t single;
+        memset(&single, 0, sizeof(single));
+        if (!worker_decode_level(args, read, payload, length, severity, &single, &meta.image.linear)) {
+            if (owned) free(payload);
+            return FALSE;
+        }
+        meta.image.pixels = single.pixels;
+        meta.image.blocks = single.blocks;
+        meta.image.format = single.format;
+        meta.image.width = single.width;
+        meta.image.height = single.height;
+        meta.image.level_count = 1;
+        upload = TRUE;
         break;
     }
-    case ASSET_TYPE_AUDIO: {
-        free(a->meta.audio.pcm);
-        a->meta.audio.pcm = NULL;
-        a->meta.audio.sampleRate = 0;
-        a->meta.audio.channels = 0;
-        a->meta.audio.samples = 0;
+    case ASSET_TYPE_SPRITE: {
+        if (!worker_decode_sprite(args, read, payload, severity, &meta)) {
+            if (owned) free(payload);
+            return FALSE;
+        }
         break;
     }
-    case ASSET_TYPE_MODEL: {
-        // TODO: Free from CPU & GPU Memory (from here somehow?)
+    case ASSET_TYPE_AUDIO: {
+        qoa_error_t result = qoa_decode(payload, length, &meta.audio.pcm,
+            &meta.audio.samples, &meta.audio.channels, &meta.audio.sampleRate);
+        if (result != QOA_OK) {
+            logger(severity, OASSET, "(%d) '%s' QOA decoding error, please refer to the manual. Error Code: %d",
+                args->id, a->name, result);
+            if (owned) free(payload);
+            return FALSE;
+        }
         break;
     }
-    case ASSET_TYPE_SCENE: {
-        // TODO: IDK WHAT THESE EXACTLY DO YET
-        break;
+    default: {
+        logger(LERROR, OASSET, "Cannot Prepare Asset '%s' with Type (%d)", a->name, a->type);
+        if (owned) free(payload);
+        return FALSE;
     }
-    case ASSET_TYPE_SCRIPT: {
-        // TODO: Release from Lua VM (from here somehow?)
-        break;
     }
+    if (owned && !keep) {
+        free(payload);
+    }
+
+    // Publish Reload
+    // The new version goes into the back buffer, the render thread swaps it to the
+    // front once it is uploaded and retires the previous version a few frames later.
+    if (read->reload) {
+        a->meta[atomic_load(&a->meta_front) ^ 1] = meta;
+        render_command_t command = {
+            .type = RENDER_COMMAND_SWAP,
+            .asset_type = a->type,
+            .asset = a,
+        };
+        render_command_push_wait(&command);
+        return TRUE;
+    }
+
+    // Publish Asset
+    *assets_meta(a) = meta;
+    if (a->type == ASSET_TYPE_IMAGE) {
+        atomic_store(&registry->refs[assets_index(a)].mip_loaded, meta.image.level);
+    }
+    a->resident = worker_resident(a->type, &meta);
+    registry_account(registry, a->type, ASSET_ACCOUNT_LOAD, a->resident);
+    if (!upload) {
+        assets_publish(a);
+        return TRUE;
     }
+    assets_set_state(a, ASSET_STATE_UPLOAD);
+    render_command_t command = {
+        .type = RENDER_COMMAND_UPLOAD,
+        .asset_type = a->type,
+        .asset = a,
+    };
+    // Render thread may be behind, wait for it to catch up
+    render_command_push_wait(&command);
+    return TRUE;
 }
 
-void registry_free(asset_registry_t* r) {
-    pthread_mutex_lock(&r->mtx);
-    if (r->assets) {
-        for (unsigned int i = 0; i < r->size; i++) {
-            asset_t* a = &r->assets[i];
-            if (a->name != NULL) {
-                free(a->name);
-                a->name = NULL;
-            }
-            registry_unsafe_free_meta(a);
+// Checksum the part of a payload that was read. The start of a mipmapped image is
+// checked level by level, a broken level table is left for the decoder to report.
+static void worker_checksum(const worker_read_t* read, const unsigned char* payload, unsigned int* hash, unsigned int* expect) {
+    *expect = read->hash;
+    if (read->length == read->archive_length) {
+        *hash = crc32(payload, read->length);
+        return;
+    }
+    *hash = read->hash;
+    unsigned int levels = 0, ends[MIP_LEVEL_LIMIT], hashes[MIP_LEVEL_LIMIT];
+    if (mip_read_table(payload, read->length, read->archive_length, &levels, ends, hashes) != MIP_OK) {
+        return;
+    }
+    for (unsigned int i = levels; i-- > 0 && ends[i] <= read->length;) {
+        unsigned int start = mip_level_start(ends, levels, i);
+        unsigned int level_hash = crc32(payload + start, (int)(ends[i] - start));
+        if (level_hash != hashes[i]) {
+            *hash = level_hash;
+            *expect = hashes[i];
+            return;
         }
-        free(r->assets);
-        r->assets = NULL;
     }
-    r->capacity = 0;
-    r->size = 0;
-    pthread_mutex_unlock(&r->mtx);
-    pthread_mutex_destroy(&r->mtx);
 }
 
-void registry_collect(asset_registry_t* r) {
-    pthread_mutex_lock(&r->mtx);
-    for (unsigned int i = 0; i < r->size; i++) {
-        asset_t* a = &r->assets[i];
-        if ((unsigned int)atomic_load(&a->used) > 0) {
-            continue;
-        }
-        asset_state_t expect = ASSET_STATE_DONE;
-        if (atomic_compare_exchange_strong(&a->state, &expect, ASSET_STATE_DISK)) {
-            registry_unsafe_free_meta(a);
-        }
+// Remember the level table of a mipmapped image which was read for the first time.
+// Returns FALSE if the levels that were asked for lie past the probe, in which case
+// the image is queued again to read exactly those.
+static bool_t worker_probe(const worker_read_t* read, const unsigned char* payload) {
+    asset_t* a = read->asset;
+    unsigned int levels = 0, ends[MIP_LEVEL_LIMIT], hashes[MIP_LEVEL_LIMIT];
+    if (mip_read_table(payload, read->length, read->archive_length, &levels, ends, hashes) != MIP_OK) {
+        return TRUE;
     }
-    pthread_mutex_unlock(&r->mtx);
+    unsigned int* copy = malloc(levels * sizeof(unsigned int));
+    if (copy != NULL) {
+        memcpy(copy, ends, levels * sizeof(unsigned int));
+    }
+    pthread_mutex_lock(&registry->mtx);
+    // The manifest may have been remounted since, in which case this table is outdated
+    if (copy != NULL && a->mip_ends == NULL && a->hash == read->hash) {
+        a->mip_ends = copy;
+        a->mip_count = levels;
+        copy = NULL;
+    }
+    pthread_mutex_unlock(&registry->mtx);
+    free(copy);
+
+    unsigned int level = read->level < levels ? read->level : levels - 1;
+    if (ends[level] <= read->length) {
+        return TRUE;
+    }
+    worker_requeue(a, read->reload, 0);
+    return FALSE;
 }
 
-asset_t* assets_unsafe_find(const asset_type_t find_type, const char* find_name) {
-    size_t find_length = strlen(find_name);
-    for (unsigned int i = 0; i < registry->size; i++) {
-        asset_t* a = &registry->assets[i];
-        if (a->type != find_type) continue;
-        if (a->name_length != find_length) continue;
-        if (!strcmp(a->name, find_name)) {
-            return a;
-        }
+// Verify a payload and decode it, see worker_decode()
+static void worker_finish(asset_worker_args_t* args, const worker_read_t* read, unsigned char* payload, bool_t owned, bool_t eof) {
+    asset_t* a = read->asset;
+    unsigned int hash = 0, expect = read->hash;
+    if (!eof) {
+        worker_checksum(read, payload, &hash, &expect);
+    }
+    if ((eof || hash != expect) && archive_watching) {
+        // Archive is most likely being rewritten, try again once it has been remounted
+        logger(LWARN, OASSET, "(%d) '%s' changed while reading, retrying", args->id, a->name);
+        if (owned) free(payload);
+        worker_requeue(a, read->reload, ASSET_RELOAD_DELAY);
+        return;
+    }
+    if (eof) {
+        logger(LERROR, OASSET, "(%d) '%s' Reached EOF when attempting to read from archive",
+            args->id, a->name);
+        if (owned) free(payload);
+        worker_abandon(a, read->reload);
+        return;
+    }
+    if (hash != expect) {
+        logger(LERROR, OASSET, "(%d) '%s' Checksum Error (0x%08X ^ 0x%08X)",
+            args->id, a->name, hash, expect);
+        if (owned) free(payload);
+        worker_abandon(a, read->reload);
+        return;
+    }
+    if (read->probe && !worker_probe(read, payload)) {
+        if (owned) free(payload);
+        return;
+    }
+    if (!worker_decode(args, read, payload, owned)) {
+        worker_abandon(a, read->reload);
     }
-    return NULL;
 }
 
-void assets_acquire(asset_t* a) {
-    atomic_fetch_add(&a->used, 1);
-    asset_state_t expect = ASSET_STATE_DISK;
-    if (atomic_compare_exchange_strong(&a->state, &expect, ASSET_STATE_WAIT)) {
-        pthread_mutex_lock(&worker_mutex);
-        pthread_cond_signal(&worker_cond);
-        pthread_mutex_unlock(&worker_mutex);
+// Hand the members of a finished read to the decode workers
+static void reader_dispatch(worker_group_t* g) {
+    if (g->request.error) {
+        logger(LWARN, OASSET, "Reader: Failed to read from archive '%s' (%s)",
+            archive_paths[g->members[0].archive_id], strerror(g->request.error));
+    }
+    pthread_mutex_lock(&worker_mutex);
+    if (decode_queue) {
+        decode_queue_last->next = g;
+    }
+    else {
+        decode_queue = g;
+    }
+    decode_queue_last = g;
+    if (g->count > 1) {
+        pthread_cond_broadcast(&decode_cond);
     }
+    else {
+        pthread_cond_signal(&decode_cond);
+    }
+    pthread_mutex_unlock(&worker_mutex);
 }
 
-void assets_release(asset_t* a) {
-    atomic_fetch_sub(&a->used, 1);
+// Release a member of a read once it was decoded, the last one frees the read
+static void reader_release(worker_group_t* g) {
+    if (atomic_fetch_sub(&g->remaining, 1) != 1) {
+        return;
+    }
+    if (g->count > 1) {
+        free(g->request.buffer);
+    }
+    free(g);
+    atomic_fetch_sub(&reader_outstanding, 1);
+
+    // Reader may be waiting for room in the queue
+    pthread_mutex_lock(&worker_mutex);
+    pthread_cond_signal(&worker_cond);
+    pthread_mutex_unlock(&worker_mutex);
 }
 
-void* engine_assets_worker(void* data) {
-    asset_worker_args_t* args = (asset_worker_args_t*)data;
-    logger(LINFO, OASSET, "Worker %02d: Spawned", args->id);
+// Wait for every read in flight and pass them on
+static void reader_drain(read_engine_t* e) {
+    read_request_t* r;
+    while ((r = read_engine_complete(e, TRUE)) != NULL) {
+        reader_dispatch((worker_group_t*)r->user);
+    }
+}
+
+// Submit a batch of claimed assets. Reads are sorted by their position in the archives
+// and neighbouring payloads are fetched with a single read, skipping small gaps.
+static void reader_submit(read_engine_t* e, worker_archive_t* archives, worker_read_t* batch, unsigned int count) {
+
+    // Locate Payloads
+    // The manifest may be remounted at any time, so read a consistent copy of it
+    pthread_mutex_lock(&registry->mtx);
+    for (unsigned int i = 0; i < count; i++) {
+        asset_t* a = batch[i].asset;
+        batch[i].archive_id = a->archive_id;
+        batch[i].archive_offset = a->archive_offset;
+        batch[i].archive_length = a->archive_length;
+        batch[i].hash = a->hash;
+        batch[i].generation = a->archive_id < archive_count ? atomic_load(&archive_generation[a->archive_id]) : 0;
+        batch[i].flag = a->flag;
+        batch[i].level = atomic_load(&registry->refs[assets_index(a)].mip_request);
+        batch[i].length = registry_unsafe_read_length(a, batch[i].level, &batch[i].probe);
+    }
+    pthread_mutex_unlock(&registry->mtx);
+    qsort(batch, count, sizeof(worker_read_t), worker_read_compare);
+
+    unsigned int i = 0;
+    while (i < count) {
+        worker_read_t* first = &batch[i];
+        asset_t* a = first->asset;
+        if (first->archive_id >= archive_count) {
+            // Nothing waiting for a first load would ever see it, fail like any other read
+            logger(first->reload ? LWARN : LERROR, OASSET,
+                "Reader: '%s' is no longer part of any Archive, restart to remount it", a->name);
+            worker_abandon(a, first->reload);
+            i++;
+            continue;
+        }
+
+        // Coalesce Reads
+        unsigned long long start = first->archive_offset;
+        unsigned long long end = start + first->length;
+        unsigned int last = i + 1;
+        while (last < count &&
+            batch[last].archive_id == first->archive_id &&
+            batch[last].archive_offset >= end &&
+            batch[last].archive_offset - end <= ASSET_READ_GAP &&
+            batch[last].archive_offset + (unsigned long long)batch[last].length - start <= ASSET_READ_LIMIT) {
+            end = batch[last].archive_offset + (unsigned long long)batch[last].length;
+            last++;
+        }
+
+        // Reopen Archive
+        // Reads in flight may still use the old handle, let them finish first
+        worker_archive_t* archive = &archives[first->archive_id];
+        if (archive->generation != first->generation) {
+            int fd = read_open(archive_paths[first->archive_id]);
+            if (fd < 0) {
+                logger(first->reload ? LWARN : LERROR, OASSET, "Reader: Failed to reopen archive '%s' (%s)",
+                    archive_paths[first->archive_id], strerror(errno));
+                for (; i < last; i++) {
+                    worker_abandon(batch[i].asset, batch[i].reload);
+                }
+                continue;
+            }
+            reader_drain(e);
+            read_close(archive->fd);
+            archive->fd = fd;
+            archive->generation = first->generation;
+        }
+
+        // Prepare Read
+        unsigned int members = last - i;
+        size_t length = (size_t)(end - start);
+        worker_group_t* g = malloc(sizeof(worker_group_t) + members * sizeof(worker_read_t));
+        unsigned char* buffer = malloc(length ? length : 1);
+        if (g == NULL || buffer == NULL) {
+            logger(LERROR, OASSET, "Reader: '%s' Memory Error: %s", a->name, strerror(errno));
+            free(g);
+            free(buffer);
+            for (; i < last; i++) {
+                worker_abandon(batch[i].asset, batch[i].reload);
+            }
+            continue;
+        }
+        memset(&g->request, 0, sizeof(read_request_t));
+        g->request.fd = archive->fd;
+        g->request.buffer = buffer;
+        g->request.length = (unsigned int)length;
+        g->request.offset = start;
+        g->request.user = g;
+        g->start = start;
+        g->count = members;
+        g->cursor = 0;
+        g->next = NULL;
+        atomic_store(&g->remaining, members);
+        memcpy(g->members, &batch[i], members * sizeof(worker_read_t));
+        atomic_fetch_add(&reader_outstanding, 1);
+        if (members > 1) {
+            logger(LDEBUG, OASSET, "Reader: Read %d Asset(s) at once (%.2fKB)", members, length / 1024.00);
+        }
+        i = last;
+
+        // Submit Read
+        // Should the queue refuse it, read it right here instead of dropping it
+        if (!read_engine_submit(e, &g->request)) {
+            read_request_run(&g->request);
+            reader_dispatch(g);
+        }
+    }
+}
+
+// Thread which keeps archive reads in flight, decoding is left to the workers
+static void* engine_assets_reader(void* data) {
+    (void)data;
+    read_engine_t engine;
+    if (!read_engine_init(&engine, ASSET_READ_DEPTH)) {
+        logger(LERROR, OASSET, "Reader: Unable to Start (%s)", strerror(errno));
+        return NULL;
+    }
+    logger(LINFO, OASSET, "Reader: Spawned (%s, %d Reads in Flight)",
+        engine.uring ? "io_uring" : "Thread Pool", engine.depth);
 
     // Open Archives
-    FILE* archive_handles[ASSET_ARCHIVE_LIMIT] = { 0 };
+    worker_archive_t archives[ASSET_ARCHIVE_LIMIT];
     for (unsigned int i = 0; i < archive_count; i++) {
-        if ((archive_handles[i] = fopen(archive_paths[i], "rb")) == NULL) {
-            logger(LERROR, OASSET, "Worker %02d: Failed to open archive '%s' (%s)",
-                args->id, archive_paths[i], strerror(errno));
+        archives[i].generation = atomic_load(&archive_generation[i]);
+        if ((archives[i].fd = read_open(archive_paths[i])) < 0) {
+            logger(LERROR, OASSET, "Reader: Failed to open archive '%s' (%s)", archive_paths[i], strerror(errno));
+            for (unsigned int j = 0; j < i; j++) {
+                read_close(archives[j].fd);
+            }
+            read_engine_exit(&engine);
             return NULL;
         }
     }
 
-    // Worker Loop
+    // Reader Loop
+    worker_read_t batch[ASSET_READ_BATCH];
     while (worker_running) {
 
+        // Pass on finished Reads
+        read_request_t* r;
+        while ((r = read_engine_complete(&engine, FALSE)) != NULL) {
+            reader_dispatch((worker_group_t*)r->user);
+        }
+
+        // Claim Work
+        // The queue is bounded by reads which weren't decoded yet, not only those in flight
+        if (atomic_load(&reader_outstanding) < engine.depth) {
+            unsigned int count = worker_claim(batch, ASSET_READ_BATCH);
+            if (count > 0) {
+                reader_submit(&engine, archives, batch, count);
+                continue;
+            }
+        }
+
         // Await Work
+        if (engine.inflight > 0) {
+            if ((r = read_engine_complete(&engine, TRUE)) != NULL) {
+                reader_dispatch((worker_group_t*)r->user);
+            }
+            continue;
+        }
         pthread_mutex_lock(&worker_mutex);
-        pthread_cond_wait(&worker_cond, &worker_mutex);
+        while (worker_running && (atomic_load(&worker_pending) <= 0 || atomic_load(&reader_outstanding) >= engine.depth)) {
+            if (atomic_load(&worker_deferred) > 0 && atomic_load(&reader_outstanding) < engine.depth) {
+                // Retries become claimable without anyone signalling, look again in a bit
+                worker_wait_for(&worker_cond, &worker_mutex, ASSET_RETRY_POLL);
+                break;
+            }
+            pthread_cond_wait(&worker_cond, &worker_mutex);
+        }
         pthread_mutex_unlock(&worker_mutex);
+    }
+
+    // Close Archives
+    // Buffers belong to the kernel until their reads finished
+    reader_drain(&engine);
+    for (unsigned int i = 0; i < archive_count; i++) {
+        read_close(archives[i].fd);
+    }
+    read_engine_exit(&engine);
+    logger(LINFO, OASSET, "Reader: Closed");
+    return NULL;
+}
+
+void* engine_assets_worker(void* data) {
+    asset_worker_args_t* args = (asset_worker_args_t*)data;
+    logger(LINFO, OASSET, "Worker %02d: Spawned", args->id);
+
+    // Worker Loop
+    // Members of a read are handed out one at a time, so a large read is decoded in parallel
+    pthread_mutex_lock(&worker_mutex);
+    while (TRUE) {
+
+        // Await Work
+        while (worker_running && decode_queue == NULL) {
+            pthread_cond_wait(&decode_cond, &worker_mutex);
+        }
         if (!worker_running) {
             break;
         }
+        worker_group_t* g = decode_queue;
+        unsigned int i = g->cursor++;
+        if (g->cursor == g->count) {
+            decode_queue = g->next;
+            if (decode_queue == NULL) {
+                decode_queue_last = NULL;
+            }
+        }
+        pthread_mutex_unlock(&worker_mutex);
 
-        // TODO: Search For Work
-        // TODO: Implement Asset Loading
+        // Decode Payload
+        // A payload filling the whole buffer is handed over, otherwise it's copied out
+        const worker_read_t* read = &g->members[i];
+        unsigned long long offset = read->archive_offset - g->start;
+        bool_t eof = offset + read->length > g->request.done;
+        worker_finish(args, read, g->request.buffer + offset, g->count == 1, eof);
+        reader_release(g);
+
+        pthread_mutex_lock(&worker_mutex);
     }
+    pthread_mutex_unlock(&worker_mutex);
 
     logger(LINFO, OASSET, "Worker %02d: Closed", args->id);
     return NULL;
 }
 
+// Read the trace of a previous run, entries of assets which no longer exist are skipped
+static void assets_trace_load(void) {
+    FILE* f = fopen(trace_path, "r");
+    if (f == NULL) {
+        logger(LINFO, OASSET, "No Asset Trace at '%s' yet, recording one", trace_path);
+        return;
+    }
+    char line[1024];
+    unsigned int capacity = 0, skipped = 0;
+    while (fgets(line, sizeof(line), f)) {
+        double time;
+        unsigned int frame, type;
+        int offset = 0;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || sscanf(line, "%lf %u %u %n", &time, &frame, &type, &offset) != 3 || offset == 0) {
+            continue;
+        }
+        asset_t* a = assets_unsafe_find((asset_type_t)type, line + offset);
+        if (a == NULL) {
+            skipped++;
+            continue;
+        }
+        if (trace_replay_count == capacity) {
+            capacity += ASSET_TRACE_GROWTH;
+            asset_trace_t* replay = realloc(trace_replay, capacity * sizeof(asset_trace_t));
+            if (replay == NULL) {
+                logger(LWARN, OASSET, "Unable to Load Asset Trace (%s)", strerror(errno));
+                break;
+            }
+            trace_replay = replay;
+        }
+        trace_replay[trace_replay_count++] = (asset_trace_t) { .asset = a, .frame = frame, .time = time };
+    }
+    fclose(f);
+    logger(LINFO, OASSET, "Replaying Asset Trace '%s' : %d Asset(s), %d Skipped",
+        trace_path, trace_replay_count, skipped);
+}
+
+// Prefetch traced assets shortly before they were first used last time. Holds off
+// while over budget, prefetching would only push out assets that are still warm.
+static void assets_trace_replay(void) {
+    if (trace_replay_cursor >= trace_replay_count) {
+        return;
+    }
+    if (registry->budget && atomic_load(&registry->stats[ASSET_STATS_TOTAL].resident) >= registry->budget) {
+        return;
+    }
+    asset_t* queued[ASSET_READ_BATCH];
+    unsigned int queued_count = 0;
+    double now = time_monotonic() - trace_start;
+    unsigned int clock = atomic_load(&registry->clock);
+    while (trace_replay_cursor < trace_replay_count) {
+        asset_trace_t* t = &trace_replay[trace_replay_cursor];
+        if (t->time > now + ASSET_TRACE_LOOKAHEAD && t->frame > clock) {
+            break;
+        }
+        if (assets_prefetch_queue(t->asset)) {
+            queued[queued_count++] = t->asset;
+        }
+        trace_replay_cursor++;
+        if (queued_count == ASSET_READ_BATCH) {
+            assets_hint_load(queued, queued_count);
+            worker_signal_batch(queued, queued_count, TRUE);
+            queued_count = 0;
+        }
+    }
+    if (queued_count > 0) {
+        assets_hint_load(queued, queued_count);
+        worker_signal_batch(queued, queued_count, TRUE);
+    }
+}
+
+// Write the first uses of this run, in the order they happened
+static void assets_trace_save(void) {
+    FILE* f = fopen(trace_path, "w");
+    if (f == NULL) {
+        logger(LWARN, OASSET, "Unable to Write Asset Trace '%s' (%s)", trace_path, strerror(errno));
+        return;
+    }
+    fprintf(f, "# Asset Trace : Seconds, Frame, Type, Name\n");
+    for (unsigned int i = 0; i < trace_recorded_count; i++) {
+        const asset_trace_t* t = &trace_recorded[i];
+        fprintf(f, "%.4f %u %u %s\n", t->time, t->frame, t->asset->type, t->asset->name);
+    }
+    if (fclose(f) != 0) {
+        logger(LWARN, OASSET, "Unable to Write Asset Trace '%s' (%s)", trace_path, strerror(errno));
+        return;
+    }
+    logger(LINFO, OASSET, "Recorded %d Asset(s) into Trace '%s'", trace_recorded_count, trace_path);
+}
+
 bool_t engine_assets_init(const engine_config_t* config) {
     worker_count = config->asset_threads;
 
@@ -294,13 +2228,6 @@ bool_t engine_assets_init(const engine_config_t* config) {
         );
         worker_count = ASSET_WORKER_LIMIT;
     }
-    if (sizeof(asset_t) > ASSET_CACHE_LINE_SIZE) {
-        logger(LWARN, OASSET,
-            "Struct 'asset_t' is %d bytes overweight!"
-            " CPU Cache performance may be affected.",
-            sizeof(asset_t) - ASSET_CACHE_LINE_SIZE
-        );
-    }
 
     // Initialize Registry
     if ((registry = malloc(sizeof(asset_registry_t))) == NULL) {
@@ -309,8 +2236,23 @@ bool_t engine_assets_init(const engine_config_t* config) {
     }
     memset(registry, 0, sizeof(asset_registry_t));
     pthread_mutex_init(&registry->mtx, NULL);
+    registry->budget = (unsigned long long)(config->asset_budget > 0 ? config->asset_budget : 0) * 1048576;
+    if (registry->budget) {
+        logger(LINFO, OASSET, "Asset Budget : %dMB", config->asset_budget);
+    }
+    memory_probe_init(&memory_probe);
 
     // Parse Archives
+    // Mounted in order, so patches and mods listed last replace base entries
+    if (config->asset_archive_count > ASSET_ARCHIVE_LIMIT) {
+        logger(LERROR, OASSET, "Cannot Mount %d Archives (Limit is %d)",
+            config->asset_archive_count, ASSET_ARCHIVE_LIMIT);
+        return FALSE;
+    }
+    archive_count = config->asset_archive_count > 0 ? (unsigned int)config->asset_archive_count : 1;
+    for (unsigned int i = 0; i < archive_count; i++) {
+        archive_paths[i] = config->asset_archive_count > 0 ? config->asset_archives[i] : ASSET_ARCHIVE_DEFAULT;
+    }
     for (unsigned int i = 0; i < archive_count; i++) {
         logger(LINFO, OASSET, "Parsing Archive : %s", archive_paths[i]);
         if (!registry_unsafe_parse(registry, archive_paths[i], i)) {
@@ -318,7 +2260,38 @@ bool_t engine_assets_init(const engine_config_t* config) {
         }
     }
 
+    // Hints are given by whichever thread queues an asset, so they get handles of their own
+    for (unsigned int i = 0; i < archive_count; i++) {
+        if ((archive_hint[i] = read_open(archive_paths[i])) < 0) {
+            logger(LWARN, OASSET, "Unable to Open '%s' for Cache Hints (%s)", archive_paths[i], strerror(errno));
+        }
+    }
+
+    // Watch Archives
+    // Asset handles point into the registry, so leave room for assets added later on
+    if (config->asset_hot_reload) {
+        if (!watch_init(&archive_watch)) {
+            logger(LWARN, OASSET, "Hot Reload is not supported on this Platform");
+        }
+        else if (!registry_unsafe_preallocate(registry, ASSET_RELOAD_RESERVE)) {
+            logger(LERROR, OASSET, "Failed to Allocate Memory for %d Entries (%s)",
+                ASSET_RELOAD_RESERVE, strerror(errno));
+            return FALSE;
+        }
+        else {
+            archive_watching = TRUE;
+            for (unsigned int i = 0; i < archive_count; i++) {
+                if (!watch_add(&archive_watch, archive_paths[i], (int)i)) {
+                    logger(LWARN, OASSET, "Unable to Watch Archive '%s' (%s)", archive_paths[i], strerror(errno));
+                }
+            }
+            logger(LINFO, OASSET, "Watching %d Archive(s) for Changes", archive_count);
+        }
+    }
+
     // Create Worker Threads
+    // From here on handles are shared between threads, the registry must not move
+    registry->sealed = TRUE;
     logger(LINFO, OASSET, "Creating %d Worker(s)", config->asset_threads);
     if ((worker_threads = malloc(sizeof(pthread_t) * worker_count)) == NULL) {
         logger(LERROR, OASSET, "Memory Error (%s)", strerror(errno));
@@ -340,33 +2313,112 @@ bool_t engine_assets_init(const engine_config_t* config) {
         }
     }
 
+    // Create Reader Thread
+    int error = pthread_create(&reader_thread, NULL, engine_assets_reader, NULL);
+    if (error) {
+        logger(LERROR, OASSET, "Failed to Create Reader (%s)", strerror(error));
+        return FALSE;
+    }
+    reader_started = TRUE;
+
+    // Replay Access Trace
+    // Whatever the previous run needed right away is queued before anyone asks for it
+    if (config->asset_trace) {
+        trace_path = config->asset_trace;
+        trace_start = time_monotonic();
+        assets_trace_load();
+        assets_trace_replay();
+    }
+
     return TRUE;
 }
 
 bool_t engine_assets_tick(float delta) {
-    registry_last_cleanup += delta;
+    atomic_fetch_add(&registry->clock, 1);
+    if (trace_path) {
+        assets_trace_replay();
+    }
 
-    // Regular Memory Collection
-    if (registry_last_cleanup > ASSET_REGISTRY_CLEANUP_INTERVAL) {
-        logger(LWARN, OASSET, "Cleaning Registry...");
-        registry_collect(registry);
-        registry_last_cleanup -= ASSET_REGISTRY_CLEANUP_INTERVAL;
+    // Reload Archives
+    // Writes usually arrive in bursts, wait for them to settle before remounting
+    if (archive_watching) {
+        double now = time_monotonic();
+        int changed;
+        while ((changed = watch_poll(&archive_watch)) >= 0) {
+            archive_changed[changed] = now;
+        }
+        for (unsigned int i = 0; i < archive_count; i++) {
+            if (archive_changed[i] > 0 && now - archive_changed[i] > ASSET_RELOAD_DELAY) {
+                archive_changed[i] = 0;
+                pthread_mutex_lock(&registry->mtx);
+                registry_unsafe_reload(registry, archive_paths[i], i);
+                if (archive_hint[i] >= 0) {
+                    read_close(archive_hint[i]);
+                }
+                archive_hint[i] = read_open(archive_paths[i]);
+                pthread_mutex_unlock(&registry->mtx);
+            }
+        }
     }
 
-    // Force Collection if Memory Pressure is High
-#ifdef _WIN32
-    registry_last_cleanup_memory += delta;
-    if (registry_last_cleanup_memory > ASSET_REGISTRY_MEMORY_PROBE_INTERVAL) {
-        if (
-            GlobalMemoryStatusEx(&mem_state) &&
-            mem_state.dwMemoryLoad > ASSET_REGISTRY_MEMORY_PRESSURE_LIMIT
-            ) {
-            logger(LWARN, OASSET, "Memory Pressure High! Cleaning Registry...");
-            registry_collect(registry);
+    // Probe Memory Pressure
+    // Stall triggers are checked every tick, usage is sampled periodically
+    memory_level_t pressure = memory_probe_stall(&memory_probe);
+    memory_last_probe += delta;
+    if (memory_last_probe > ASSET_REGISTRY_MEMORY_PROBE_INTERVAL) {
+        memory_level_t usage = memory_probe_usage(&memory_probe);
+        if (usage > pressure) {
+            pressure = usage;
         }
-        registry_last_cleanup_memory -= ASSET_REGISTRY_MEMORY_PROBE_INTERVAL;
+        memory_last_probe -= ASSET_REGISTRY_MEMORY_PROBE_INTERVAL;
+    }
+
+    // Report Memory Usage
+    stats_last_log += delta;
+    if (stats_last_log > ASSET_REGISTRY_STATS_INTERVAL) {
+        assets_stats_log();
+        stats_last_log -= ASSET_REGISTRY_STATS_INTERVAL;
+    }
+
+    // Budgeted Memory Collection
+    // Unused assets stay warm until the budget is exceeded, then the least recently
+    // used ones are evicted a little bit at a time.
+    unsigned long long resident = atomic_load(&registry->stats[ASSET_STATS_TOTAL].resident);
+    unsigned long long target = ULLONG_MAX;
+    if (registry->budget && resident > registry->budget) {
+        target = registry->budget / 100 * ASSET_REGISTRY_COLLECT_TARGET;
+    }
+
+    // Pressured Memory Collection
+    // The higher the level the more of the unused assets are given back
+    switch (pressure) {
+    case MEMORY_LEVEL_NONE: {
+        break;
+    }
+    case MEMORY_LEVEL_LOW: {
+        logger(LWARN, OASSET, "Memory Pressure Low! Collecting Registry...");
+        if (resident / 4 * 3 < target) target = resident / 4 * 3;
+        break;
+    }
+    case MEMORY_LEVEL_MEDIUM: {
+        logger(LWARN, OASSET, "Memory Pressure Medium! Collecting Registry...");
+        if (resident / 2 < target) target = resident / 2;
+        break;
+    }
+    case MEMORY_LEVEL_CRITICAL: {
+        logger(LWARN, OASSET, "Memory Pressure High! Cleaning Registry...");
+        target = 0;
+        break;
+    }
+    }
+
+    // Sweeping everything at once would stall the frame, critical pressure gets more time instead
+    if (target != ULLONG_MAX || registry->collect_cursor > 0) {
+        double slice = pressure == MEMORY_LEVEL_CRITICAL
+            ? ASSET_REGISTRY_COLLECT_URGENT
+            : ASSET_REGISTRY_COLLECT_SLICE;
+        registry_collect_step(registry, slice, target);
     }
-#endif
 
     return TRUE;
 }
@@ -377,12 +2429,67 @@ void engine_assets_exit(void) {
     pthread_mutex_lock(&worker_mutex);
     worker_running = 0;
     pthread_cond_broadcast(&worker_cond);
+    pthread_cond_broadcast(&decode_cond);
     pthread_mutex_unlock(&worker_mutex);
     for (unsigned int i = 0; i < worker_count; i++) {
         pthread_join(worker_threads[i], NULL);
     }
+    if (reader_started) {
+        pthread_join(reader_thread, NULL);
+        reader_started = FALSE;
+    }
+
+    // Discard Reads nobody decoded
+    while (decode_queue) {
+        worker_group_t* g = decode_queue;
+        decode_queue = g->next;
+        if (g->count == 1) {
+            free(g->request.buffer);    // Would have been handed over to the asset
+        }
+        // The last release frees the group, so it can't be read from anymore by then
+        unsigned int cursor = g->cursor, count = g->count;
+        for (unsigned int i = cursor; i < count; i++) {
+            worker_abandon(g->members[i].asset, g->members[i].reload);
+        }
+        for (unsigned int i = cursor; i < count; i++) {
+            reader_release(g);
+        }
+    }
+    decode_queue_last = NULL;
+
+    // Record Access Trace
+    if (trace_path) {
+        assets_trace_save();
+        free(trace_recorded);
+        free(trace_replay);
+        trace_recorded = NULL;
+        trace_replay = NULL;
+        trace_recorded_count = trace_recorded_capacity = 0;
+        trace_replay_count = trace_replay_cursor = 0;
+        trace_path = NULL;
+    }
 
     // Cleanup Registry
+    assets_stats_log();
     registry_free(registry);
+    free(registry);
     registry = NULL;
+    free(worker_threads);
+    free(worker_args);
+    worker_threads = NULL;
+    worker_args = NULL;
+    worker_queue_free(&worker_queued);
+    worker_queue_free(&worker_queued_prefetch);
+    worker_queue_free(&worker_retries);
+    memory_probe_exit(&memory_probe);
+    for (unsigned int i = 0; i < archive_count; i++) {
+        if (archive_hint[i] >= 0) {
+            read_close(archive_hint[i]);
+        }
+        archive_hint[i] = -1;
+    }
+    if (archive_watching) {
+        watch_exit(&archive_watch);
+        archive_watching = FALSE;
+    }
 }
\ No newline at end of file
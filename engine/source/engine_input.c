@@ -65,7 +65,8 @@ bool_t input_get_button(input_button_t button) {
     default: { break; }
     }
 #else
-#warning "Input Button Binds Not Implemented, all buttons will act as depressed"
+#pragma message "Input Button Binds Not Implemented, all buttons will act as depressed"
+    (void)button;
 #endif
     pthread_mutex_unlock(&input_mtx);
     return down;
@@ -103,7 +104,8 @@ bool_t engine_input_tick(float delta) {
         : &XINPUT_VIBRATE_OFF
     );
 #else
-#warning "Input Tick Not Implemented, no inputs will be collected"
+#pragma message "Input Tick Not Implemented, no inputs will be collected"
+    (void)input_controller;
 #endif
 
     // Scale Virtual Joystick
@@ -2,6 +2,9 @@
 #include <engine_logger.h>
 #include <engine_config.h>
 #include <pthread.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdlib.h>
 #include <stdio.h>
 
 #ifdef _WIN32
@@ -72,6 +75,8 @@ bool_t engine_logger_init(const engine_config_t* config) {
         freopen_s(&out, "CONOUT$", "w", stderr);
         SetConsoleTitle("Console");
     }
+#else
+    (void)config;
 #endif
     return TRUE;
 }
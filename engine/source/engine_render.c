@@ -2,8 +2,16 @@
 #include <engine_render.h>
 #include <engine_logger.h>
 #include <engine_input.h>
+#include <render_raster.h>
+#include <render_headless.h>
+#include <platform_time.h>
+#include <util_ring.h>
 // #include <vulkan/vulkan.h>
+#include <stdatomic.h>
+#include <pthread.h>
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
 
 static int render_height_def = 720;     // (Default) Window Height
 static int render_width_def = 1280;     // (Default) Window Width
@@ -14,6 +22,49 @@ static bool_t render_fullscreen = FALSE;
 static bool_t render_fullscreen_debounce = FALSE;
 static unsigned int* render_framebuffer = NULL;
 static unsigned int render_resolution = 0;
+static float render_alpha = 0;
+static render_target_t render_target = RENDER_TARGET_WINDOW;
+static unsigned int render_frame_limit = 0;
+static unsigned int render_frame_count = 0;
+static asset_t* render_placeholder_sprite = NULL;
+
+typedef struct {
+    raster_list_t list;                 // Draw Commands
+    int width;                          // Frame Width
+    int height;                         // Frame Height
+    float alpha;                        // Simulation Interpolation
+} render_packet_t;
+
+// Frame Packets are double buffered, the simulation thread fills one packet while
+// the render thread draws and presents the other one.
+static render_packet_t render_packets[2] = { 0 };
+static unsigned int render_packet_write = 0;    // (Simulation) Packet being Filled
+static unsigned int render_packet_read = 0;     // (Render) Packet being Drawn
+static bool_t render_packet_busy = FALSE;       // Render Thread is Drawing a Packet
+static bool_t render_thread_running = FALSE;
+static atomic_bool render_thread_failed = FALSE;
+static pthread_t render_thread;
+static pthread_mutex_t render_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t render_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t render_space = PTHREAD_COND_INITIALIZER;   // Command Ring has Room again
+static atomic_uint render_command_waiters = 0;                   // Threads waiting for Room
+
+// Swapped out asset versions, frames in flight may still read from them
+typedef struct {
+    unsigned char type;                 // Asset Type
+    unsigned int frame;                 // Frame the Version was swapped out at
+    asset_metadata_u meta;              // Previous Version
+} render_retired_t;
+
+static render_retired_t* render_retired = NULL;
+static unsigned int render_retired_count = 0;
+static unsigned int render_retired_capacity = 0;
+static unsigned int render_frame_drawn = 0;     // (Render) Frames Drawn
+
+// Commands from the asset workers and collector, drained by the render thread
+static ring_t render_commands;
+static unsigned char render_commands_storage[RING_STORAGE_SIZE(RENDER_COMMAND_LIMIT, sizeof(render_command_t))]
+__attribute__((aligned(ASSET_CACHE_LINE_SIZE)));
 
 #ifdef _WIN32
 #include <windows.h>
@@ -85,6 +136,22 @@ static LRESULT CALLBACK RenderWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
 }
 #endif
 
+void render_set_alpha(float alpha) {
+    render_alpha = alpha;
+}
+
+float render_get_alpha(void) {
+    return render_alpha;
+}
+
+void render_draw_triangle(const raster_vertex_t v[3]) {
+    raster_list_triangle(&render_packets[render_packet_write].list, v);
+}
+
+void render_draw_sprite(const raster_sprite_t* sprite) {
+    raster_list_sprite(&render_packets[render_packet_write].list, sprite);
+}
+
 bool_t engine_render_init(const engine_config_t* config) {
 
     // Load Configuration
@@ -103,54 +170,186 @@ bool_t engine_render_init(const engine_config_t* config) {
     render_fullscreen = config->render_fullscreen;
     render_height_cur = render_height_def;
     render_width_cur = render_width_def;
+    render_target = config->render_target;
+    render_frame_limit = config->render_frame_limit > 0 ? config->render_frame_limit : 0;
+    raster_list_reset(&render_packets[0].list, RENDER_CLEAR);
+    raster_list_reset(&render_packets[1].list, RENDER_CLEAR);
+
+    // Prepare Command Ring
+    ring_init(&render_commands, render_commands_storage, RENDER_COMMAND_LIMIT, sizeof(render_command_t));
+
+    // Prepare Rasterizer
+    if (!raster_init(config->render_threads)) {
+        return FALSE;
+    }
+
+    // Prepare Headless Target
+    if (!headless_init(config)) {
+        return FALSE;
+    }
+#ifndef _WIN32
+    if (render_target == RENDER_TARGET_WINDOW) {
+        logger(LERROR, ORENDER, "Window Backend Not Implemented, use '--headless=qoi' or '--headless=shm'");
+        return FALSE;
+    }
+#endif
 
 #ifdef _WIN32
     // Prepare Window
-    HINSTANCE hInstance = GetModuleHandle(NULL);
-    WNDCLASS window_class = {
-       .lpfnWndProc = RenderWndProc,
-       .hInstance = hInstance,
-       .lpszClassName = "RenderWindowClass",
-       .hIcon = LoadIcon(hInstance, "IDI_APPICON"),
-       .hCursor = LoadCursor(NULL, IDC_ARROW),
-    };
-    RegisterClass(&window_class);
+    if (render_target == RENDER_TARGET_WINDOW) {
+        HINSTANCE hInstance = GetModuleHandle(NULL);
+        WNDCLASS window_class = {
+           .lpfnWndProc = RenderWndProc,
+           .hInstance = hInstance,
+           .lpszClassName = "RenderWindowClass",
+           .hIcon = LoadIcon(hInstance, "IDI_APPICON"),
+           .hCursor = LoadCursor(NULL, IDC_ARROW),
+        };
+        RegisterClass(&window_class);
 
-    window_handle = CreateWindowEx(
-        0, window_class.lpszClassName, RENDER_TITLE, 0,
-        CW_USEDEFAULT, CW_USEDEFAULT, 0, 0,
-        NULL, NULL, hInstance, NULL
-    );
-    if (window_handle == NULL) {
-        logger(LERROR, ORENDER, "Unable to Create Window (%lu)", GetLastError());
-        return FALSE;
+        window_handle = CreateWindowEx(
+            0, window_class.lpszClassName, RENDER_TITLE, 0,
+            CW_USEDEFAULT, CW_USEDEFAULT, 0, 0,
+            NULL, NULL, hInstance, NULL
+        );
+        if (window_handle == NULL) {
+            logger(LERROR, ORENDER, "Unable to Create Window (%lu)", GetLastError());
+            return FALSE;
+        }
+        window_device = GetDC(window_handle);
+        render_fullscreen_set(render_fullscreen);
     }
-    window_device = GetDC(window_handle);
-    render_fullscreen_set(render_fullscreen);
 #endif
 
+    // Placeholder Scene Assets
+    render_placeholder_sprite = assets_unsafe_find(ASSET_TYPE_IMAGE, "/textures/item_robot");
+    if (render_placeholder_sprite) {
+        assets_acquire(render_placeholder_sprite);
+    }
+
+    // Create Render Thread
+    render_thread_running = TRUE;
+    int error = pthread_create(&render_thread, NULL, engine_render_thread, NULL);
+    if (error) {
+        render_thread_running = FALSE;
+        logger(LERROR, ORENDER, "Failed to Create Render Thread (%s)", strerror(error));
+        return FALSE;
+    }
+
     return TRUE;
 }
 
-bool_t engine_render_tick(float delta) {
-    (void)delta;
-    if (!render_continue) {
-        return FALSE;
+bool_t render_command_push(const render_command_t* command) {
+    return ring_push(&render_commands, command);
+}
+
+bool_t render_command_push_wait(const render_command_t* command) {
+    if (ring_push(&render_commands, command)) {
+        return TRUE;
+    }
+    bool_t pushed = FALSE;
+    pthread_mutex_lock(&render_mtx);
+    atomic_fetch_add(&render_command_waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (render_thread_running && !(pushed = ring_push(&render_commands, command))) {
+        pthread_cond_wait(&render_space, &render_mtx);
     }
+    atomic_fetch_sub(&render_command_waiters, 1);
+    pthread_mutex_unlock(&render_mtx);
+    return pushed;
+}
 
-    // Toggle Fullscreen
-    if (input_get_button(INPUT_BUTTON_FULLSCREEN)) {
-        if (!render_fullscreen_debounce) {
-            render_fullscreen_debounce = TRUE;
-            render_fullscreen_set(!render_fullscreen);
+static void render_retire(const unsigned char type, asset_metadata_u* meta) {
+    if (render_retired_count == render_retired_capacity) {
+        unsigned int capacity = render_retired_capacity ? render_retired_capacity * 2 : 16;
+        render_retired_t* retired = realloc(render_retired, capacity * sizeof(render_retired_t));
+        if (retired == NULL) {
+            // Out of memory, release it right away rather than leaking it
+            logger(LWARN, ORENDER, "Failed to retire Asset Version (%s)", strerror(errno));
+            registry_release_meta(type, meta);
+            return;
         }
+        render_retired = retired;
+        render_retired_capacity = capacity;
     }
-    else {
-        render_fullscreen_debounce = FALSE;
+    render_retired[render_retired_count++] = (render_retired_t){
+        .type = type,
+        .frame = render_frame_drawn,
+        .meta = *meta,
+    };
+}
+
+// Release retired versions which no frame in flight can reference anymore,
+// or all of them when 'all' is set.
+static void render_retire_collect(bool_t all) {
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < render_retired_count; i++) {
+        render_retired_t* r = &render_retired[i];
+        if (all || render_frame_drawn - r->frame >= RENDER_RETIRE_FRAMES) {
+            registry_release_meta(r->type, &r->meta);
+        }
+        else {
+            render_retired[kept++] = *r;
+        }
+    }
+    render_retired_count = kept;
+    if (all) {
+        free(render_retired);
+        render_retired = NULL;
+        render_retired_capacity = 0;
+    }
+}
+
+static void render_command_process(const render_command_t* command) {
+    switch (command->type) {
+    // The software rasterizer reads straight from the decoded metadata, so there is
+    // nothing to upload or destroy, commands only hand versions over between threads.
+    case RENDER_COMMAND_UPLOAD: {
+        assets_publish(command->asset);
+        break;
+    }
+    case RENDER_COMMAND_SWAP: {
+        asset_metadata_u retired = assets_unsafe_swap(command->asset);
+        render_retire(command->asset_type, &retired);
+        assets_publish(command->asset);
+        break;
     }
+    case RENDER_COMMAND_RELEASE: {
+        // A packet built before the eviction may still be drawn, keep it like a swapped out version
+        asset_metadata_u meta = command->meta;
+        render_retire(command->asset_type, &meta);
+        break;
+    }
+    }
+}
+
+// Process queued commands until the ring is empty or the budget (seconds) runs out,
+// a negative budget drains the ring entirely.
+static void render_command_drain(double budget) {
+    render_command_t command;
+    unsigned int drained = 0;
+    double start = time_monotonic();
+    while (ring_pop(&render_commands, &command)) {
+        render_command_process(&command);
+        drained++;
+        if (budget >= 0 && time_monotonic() - start > budget) {
+            break;
+        }
+    }
+
+    // Wake Workers waiting for Room
+    atomic_thread_fence(memory_order_seq_cst);
+    if (drained > 0 && atomic_load(&render_command_waiters) > 0) {
+        pthread_mutex_lock(&render_mtx);
+        pthread_cond_broadcast(&render_space);
+        pthread_mutex_unlock(&render_mtx);
+    }
+}
+
+static bool_t render_frame(render_packet_t* packet) {
 
     // Allocate Framebuffer
-    unsigned int framebuffer_resolution = render_height_cur * render_width_cur;
+    unsigned int framebuffer_resolution = packet->height * packet->width;
     unsigned int framebuffer_size = framebuffer_resolution * sizeof(unsigned int);
     if (framebuffer_resolution != render_resolution) {
         free(render_framebuffer);
@@ -160,8 +359,8 @@ bool_t engine_render_tick(float delta) {
         window_bitmap = (BITMAPINFO){
                 .bmiHeader = {
                     .biSize = sizeof(BITMAPINFOHEADER),
-                    .biWidth = render_width_cur,
-                    .biHeight = -render_height_cur,
+                    .biWidth = packet->width,
+                    .biHeight = -packet->height,
                     .biPlanes = 1,
                     .biBitCount = 32,
                     .biCompression = BI_RGB,
@@ -179,18 +378,28 @@ bool_t engine_render_tick(float delta) {
         }
         render_resolution = framebuffer_resolution;
         memset(render_framebuffer, 0, framebuffer_size);
-        logger(LINFO, ORENDER, "Resolution Changed (%dx%d)", render_width_cur, render_height_cur);
+        logger(LINFO, ORENDER, "Resolution Changed (%dx%d)", packet->width, packet->height);
     }
 
-    // TODO: Upload Textures & Shaders
-    // TODO: Render Frame
+    // Upload & Release Resources
+    render_command_drain(RENDER_COMMAND_BUDGET);
+    render_retire_collect(FALSE);
+    render_frame_drawn++;
+
+    // Render Frame
+    if (!raster_draw(&packet->list, render_framebuffer, packet->width, packet->height)) {
+        return FALSE;
+    }
 
     // Submit Framebuffer
+    if (render_target != RENDER_TARGET_WINDOW) {
+        return headless_present(render_framebuffer, packet->width, packet->height);
+    }
 #ifdef _WIN32
     StretchDIBits(
         window_device,
-        0, 0, render_width_cur, render_height_cur,
-        0, 0, render_width_cur, render_height_cur,
+        0, 0, packet->width, packet->height,
+        0, 0, packet->width, packet->height,
         render_framebuffer,
         &window_bitmap,
         DIB_RGB_COLORS,
@@ -201,7 +410,134 @@ bool_t engine_render_tick(float delta) {
     return TRUE;
 }
 
-void engine_render_exit() {
+void* engine_render_thread(void* data) {
+    (void)data;
+    logger(LINFO, ORENDER, "Render Thread Spawned");
+
+    pthread_mutex_lock(&render_mtx);
+    while (TRUE) {
+
+        // Await Packet
+        while (render_thread_running && !render_packet_busy) {
+            pthread_cond_wait(&render_cond, &render_mtx);
+        }
+        if (!render_thread_running) {
+            break;
+        }
+        render_packet_t* packet = &render_packets[render_packet_read];
+        pthread_mutex_unlock(&render_mtx);
+
+        // Draw Packet
+        if (!render_frame(packet)) {
+            atomic_store(&render_thread_failed, TRUE);
+        }
+
+        // Release Packet
+        pthread_mutex_lock(&render_mtx);
+        render_packet_busy = FALSE;
+        pthread_cond_broadcast(&render_cond);
+    }
+    pthread_mutex_unlock(&render_mtx);
+
+    logger(LINFO, ORENDER, "Render Thread Closed");
+    return NULL;
+}
+
+bool_t engine_render_tick(float delta) {
+    (void)delta;
+    if (!render_continue || atomic_load(&render_thread_failed)) {
+        return FALSE;
+    }
+
+    // Frame Limit Reached
+    if (render_frame_limit && render_frame_count >= render_frame_limit) {
+        logger(LINFO, ORENDER, "Frame Limit Reached (%d frames)", render_frame_count);
+        return FALSE;
+    }
+    render_frame_count++;
+
+    // Toggle Fullscreen
+    if (render_target == RENDER_TARGET_WINDOW && input_get_button(INPUT_BUTTON_FULLSCREEN)) {
+        if (!render_fullscreen_debounce) {
+            render_fullscreen_debounce = TRUE;
+            render_fullscreen_set(!render_fullscreen);
+        }
+    }
+    else {
+        render_fullscreen_debounce = FALSE;
+    }
+
+    // Placeholder Scene (Mirrors 'game/shaders/triangle.vert')
+    static const raster_vertex_t triangle[3] = {
+        {.x = 0.0f,  .y = -0.5f, .color = 0x00FF0000 },
+        {.x = 0.5f,  .y = 0.5f,  .color = 0x00FF0000 },
+        {.x = -0.5f, .y = 0.5f,  .color = 0x00FF0000 },
+    };
+    if (render_placeholder_sprite && assets_state(render_placeholder_sprite) == ASSET_STATE_DONE) {
+        asset_metadata_image_t* image = &assets_meta(render_placeholder_sprite)->image;
+        raster_sprite_t sprite = {
+            .pixels = image->pixels,
+            .blocks = image->blocks,
+            .format = image->format,
+            .width = image->width,
+            .height = image->height,
+            .x = 16,
+            .y = 16,
+            .w = (int)image->width / 2,
+            .h = (int)image->height / 2,
+        };
+        render_draw_sprite(&sprite);
+    }
+    render_draw_triangle(triangle);
+
+    // Prepare Packet
+    render_packet_t* packet = &render_packets[render_packet_write];
+    packet->width = render_width_cur;
+    packet->height = render_height_cur;
+    packet->alpha = render_alpha;
+
+    // Submit Packet, waiting for the previous frame to finish drawing first.
+    // Simulation of the next frame then overlaps with drawing of this one.
+    pthread_mutex_lock(&render_mtx);
+    while (render_packet_busy) {
+        pthread_cond_wait(&render_cond, &render_mtx);
+    }
+    render_packet_read = render_packet_write;
+    render_packet_busy = TRUE;
+    pthread_cond_broadcast(&render_cond);
+    pthread_mutex_unlock(&render_mtx);
+
+    // Swap Packets
+    render_packet_write ^= 1;
+    raster_list_reset(&render_packets[render_packet_write].list, RENDER_CLEAR);
+
+    return TRUE;
+}
+
+void engine_render_exit(void) {
+
+    // Cleanup Render Thread
+    if (render_thread_running) {
+        pthread_mutex_lock(&render_mtx);
+        while (render_packet_busy) {
+            pthread_cond_wait(&render_cond, &render_mtx);
+        }
+        render_thread_running = FALSE;
+        pthread_cond_broadcast(&render_cond);
+        pthread_cond_broadcast(&render_space);
+        pthread_mutex_unlock(&render_mtx);
+        pthread_join(render_thread, NULL);
+    }
+    render_command_drain(-1);
+    render_retire_collect(TRUE);
+    if (render_placeholder_sprite) {
+        assets_release(render_placeholder_sprite);
+        render_placeholder_sprite = NULL;
+    }
+    raster_exit();
+    headless_exit();
+    raster_list_free(&render_packets[0].list);
+    raster_list_free(&render_packets[1].list);
     if (render_framebuffer) {
         free(render_framebuffer);
         render_framebuffer = NULL;
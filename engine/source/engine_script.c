@@ -0,0 +1,189 @@
+#include <engine_config.h>
+#include <engine_script.h>
+#include <engine_assets.h>
+#include <engine_logger.h>
+#include <platform_time.h>
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+#include <stdio.h>
+
+typedef struct {
+    const char* data;               // Chunk
+    size_t size;                    // Chunk Size (0 once read)
+} script_reader_t;
+
+static lua_State* script_state = NULL;
+static asset_t* script_entrypoint = NULL;   // Acquired until it has been run
+static double script_gc_budget = 0;         // Collection Time per Frame (Seconds)
+static size_t script_gc_threshold = 0;      // Heap Size starting the next Collection (Kilobytes)
+static bool_t script_gc_active = FALSE;     // Collection underway?
+
+// Hands the whole payload to Lua in one piece
+static const char* script_read(lua_State* L, void* ud, size_t* size) {
+    (void)L;
+    script_reader_t* reader = ud;
+    *size = reader->size;
+    reader->size = 0;
+    return *size ? reader->data : NULL;
+}
+
+int script_load(lua_State* L, asset_t* a) {
+    if (a->type != ASSET_TYPE_SCRIPT || assets_state(a) != ASSET_STATE_DONE) {
+        lua_pushfstring(L, "Script '%s' is not loaded", a->name);
+        return LUA_ERRRUN;
+    }
+    asset_metadata_embedded_t* embed = &assets_meta(a)->embed;
+    script_reader_t reader = { (const char*)embed->data, embed->size };
+
+    // Chunk Names starting with '@' are shown as File Names in Tracebacks
+    char name[SCRIPT_NAME_LIMIT];
+    snprintf(name, sizeof(name), "@%s", a->name);
+    return lua_load(L, script_read, &reader, name, (a->flag & ASSET_FLAG_BYTECODE) ? "b" : "t");
+}
+
+// Route print() into the Log instead of Standard Output
+static int script_print(lua_State* L) {
+    int count = lua_gettop(L);
+    luaL_Buffer b;
+    luaL_buffinit(L, &b);
+    for (int i = 1; i <= count; i++) {
+        if (i > 1) {
+            luaL_addchar(&b, '\t');
+        }
+        luaL_tolstring(L, i, NULL);
+        luaL_addvalue(&b);
+    }
+    luaL_pushresult(&b);
+    logger(LINFO, OSCRIPT, "%s", lua_tostring(L, -1));
+    return 0;
+}
+
+static int script_traceback(lua_State* L) {
+    luaL_traceback(L, L, lua_tostring(L, 1), 1);
+    return 1;
+}
+
+// Call the function below 'arguments' on the stack, errors are logged with a traceback
+static bool_t script_call(lua_State* L, int arguments) {
+    int handler = lua_gettop(L) - arguments;
+    lua_pushcfunction(L, script_traceback);
+    lua_insert(L, handler);
+    int status = lua_pcall(L, arguments, 0, handler);
+    if (status != LUA_OK) {
+        const char* message = lua_tostring(L, -1);
+        logger(LERROR, OSCRIPT, "Script Error (%d) %s", status, message ? message : "Unknown Error");
+        lua_pop(L, 1);
+    }
+    lua_remove(L, handler);
+    return status == LUA_OK;
+}
+
+// Advance the collector until the frame budget is spent. Collections only start once
+// the heap has grown enough, so most frames spend nothing on them at all.
+static void script_collect(lua_State* L, double budget) {
+    size_t used = (size_t)lua_gc(L, LUA_GCCOUNT);
+    if (!script_gc_active && used < script_gc_threshold) {
+        return;
+    }
+    script_gc_active = TRUE;
+    if (used >= script_gc_threshold * SCRIPT_GC_BEHIND) {
+        // Scripts allocate faster than the budget collects! Catch up instead of running out...
+        logger(LWARN, OSCRIPT, "Collector Behind (%zuKB), Finishing Collection...", used);
+        lua_gc(L, LUA_GCCOLLECT);
+        script_gc_active = FALSE;
+    }
+    double start = time_monotonic();
+    while (script_gc_active && time_monotonic() - start < budget) {
+        if (lua_gc(L, LUA_GCSTEP, 0)) {
+            script_gc_active = FALSE;   // Cycle Finished
+        }
+    }
+
+    // Wait for the heap to grow again before starting the next one
+    if (!script_gc_active) {
+        script_gc_threshold = (size_t)lua_gc(L, LUA_GCCOUNT) * SCRIPT_GC_PAUSE / 100;
+        if (script_gc_threshold < SCRIPT_GC_MINIMUM) {
+            script_gc_threshold = SCRIPT_GC_MINIMUM;
+        }
+    }
+}
+
+bool_t engine_script_init(const engine_config_t* config) {
+    script_state = luaL_newstate();
+    if (script_state == NULL) {
+        logger(LERROR, OSCRIPT, "Unable to create Lua State");
+        return FALSE;
+    }
+    luaL_openlibs(script_state);
+    lua_register(script_state, "print", script_print);
+
+    // Collection is stepped once per frame only, never from within an allocation. Without
+    // a budget Lua collects on its own again. A default step takes milliseconds on a large
+    // heap, small steps let the budget be checked often enough to hold.
+    lua_gc(script_state, LUA_GCINC, 0, 0, 0);
+    script_gc_budget = config->script_gc_budget > 0 ? config->script_gc_budget / 1000000.0 : 0;
+    if (script_gc_budget > 0) {
+        lua_gc(script_state, LUA_GCINC, 0, 0, SCRIPT_GC_STEP_SIZE);
+        lua_gc(script_state, LUA_GCSTOP);
+    }
+    script_gc_threshold = SCRIPT_GC_MINIMUM;
+    script_gc_active = FALSE;
+    logger(LINFO, OSCRIPT, "%s . Collection Budget : %dus", LUA_RELEASE, config->script_gc_budget);
+
+    script_entrypoint = assets_unsafe_find(ASSET_TYPE_SCRIPT, SCRIPT_ENTRYPOINT);
+    if (script_entrypoint == NULL) {
+        logger(LWARN, OSCRIPT, "Missing Entrypoint Script '%s'", SCRIPT_ENTRYPOINT);
+        return TRUE;
+    }
+    assets_acquire(script_entrypoint);
+    return TRUE;
+}
+
+bool_t engine_script_tick(float delta) {
+    lua_State* L = script_state;
+
+    // Run the Entrypoint once it has loaded
+    if (script_entrypoint != NULL && assets_state(script_entrypoint) == ASSET_STATE_DONE) {
+        if (script_load(L, script_entrypoint) == LUA_OK) {
+            script_call(L, 0);
+        }
+        else {
+            logger(LERROR, OSCRIPT, "Unable to load Entrypoint Script: %s", lua_tostring(L, -1));
+            lua_pop(L, 1);
+        }
+        assets_release(script_entrypoint);
+        script_entrypoint = NULL;
+    }
+
+    // Tick Callback
+    if (lua_getglobal(L, SCRIPT_UPDATE) == LUA_TFUNCTION) {
+        lua_pushnumber(L, delta);
+        script_call(L, 1);
+    }
+    else {
+        lua_pop(L, 1);
+    }
+    return TRUE;
+}
+
+bool_t engine_script_frame(float delta) {
+    (void)delta;
+
+    // Collect Garbage
+    if (script_gc_budget > 0) {
+        script_collect(script_state, script_gc_budget);
+    }
+    return TRUE;
+}
+
+void engine_script_exit(void) {
+    if (script_entrypoint != NULL) {
+        assets_release(script_entrypoint);
+        script_entrypoint = NULL;
+    }
+    if (script_state != NULL) {
+        lua_close(script_state);
+        script_state = NULL;
+    }
+}
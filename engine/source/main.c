@@ -3,85 +3,187 @@
 #include <engine_render.h>
 #include <engine_assets.h>
 #include <engine_logger.h>
-
-static bool_t engine_continue = TRUE;
+#include <engine_script.h>
+#include <platform_time.h>
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
 
 #ifdef _WIN32
 #include <windows.h>
+#endif
 
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd) {
-    (void)hInstance;
-    (void)hPrevInstance;
-    (void)lpCmdLine;
-    (void)nShowCmd;
+static volatile sig_atomic_t engine_continue = TRUE;
 
-    // Initialize Config
-    int argc = 0;
-    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
-    engine_config_t config = engine_config_init();
-    for (int i = 0; i < argc; i++) {
-        if (!wcsncmp(argv[i], L"--asset-threads=", 16)) config.asset_threads = _wtoi(argv[i] + 16);
-        if (!wcsncmp(argv[i], L"--height=", 9))         config.render_height = _wtoi(argv[i] + 9);
-        if (!wcsncmp(argv[i], L"--width=", 8))          config.render_width = _wtoi(argv[i] + 8);
-        if (wcsstr(argv[i], L"--fullscreen"))           config.render_fullscreen = TRUE;
-        if (wcsstr(argv[i], L"--console"))              config.logger_console = TRUE;
+static void engine_config_parse(engine_config_t* config, const char* arg) {
+    if (!strncmp(arg, "--asset-threads=", 16))      config->asset_threads = atoi(arg + 16);
+    if (!strncmp(arg, "--asset-budget=", 15))       config->asset_budget = atoi(arg + 15);
+    if (!strncmp(arg, "--archive=", 10)) {
+        if (config->asset_archive_count < ASSET_ARCHIVE_LIMIT) {
+            config->asset_archives[config->asset_archive_count] = arg + 10;
+        }
+        config->asset_archive_count++;
     }
-    LocalFree(argv);
+    if (!strncmp(arg, "--asset-trace=", 14))        config->asset_trace = arg + 14;
+    if (!strncmp(arg, "--height=", 9))              config->render_height = atoi(arg + 9);
+    if (!strncmp(arg, "--width=", 8))               config->render_width = atoi(arg + 8);
+    if (!strncmp(arg, "--render-threads=", 17))     config->render_threads = atoi(arg + 17);
+    if (!strncmp(arg, "--tick-rate=", 12))          config->engine_tick_rate = atoi(arg + 12);
+    if (!strncmp(arg, "--frame-rate=", 13))         config->engine_frame_rate = atoi(arg + 13);
+    if (!strncmp(arg, "--script-gc-budget=", 19))   config->script_gc_budget = atoi(arg + 19);
+    if (!strncmp(arg, "--frames=", 9))              config->render_frame_limit = atoi(arg + 9);
+    if (!strncmp(arg, "--capture-interval=", 19))   config->render_capture_interval = atoi(arg + 19);
+    if (!strncmp(arg, "--capture-path=", 15))       config->render_capture_path = arg + 15;
+    if (!strcmp(arg, "--headless=qoi"))             config->render_target = RENDER_TARGET_QOI;
+    if (!strcmp(arg, "--headless=shm"))             config->render_target = RENDER_TARGET_SHM;
+    if (strstr(arg, "--fullscreen"))                config->render_fullscreen = TRUE;
+    if (strstr(arg, "--console"))                   config->logger_console = TRUE;
+    if (strstr(arg, "--hot-reload"))                config->asset_hot_reload = TRUE;
+}
+
+static void engine_events(void) {
+#ifdef _WIN32
+    MSG event;
+    while (PeekMessage(&event, NULL, 0, 0, PM_REMOVE)) {
+        if (event.message == WM_QUIT) {
+            engine_continue = 0;
+            break;
+        }
+        TranslateMessage(&event);
+        DispatchMessage(&event);
+    }
+#endif
+}
+
+static int engine_run(engine_config_t* config) {
 
     // Initialize Loop
     if (
-        !engine_logger_init(&config) ||
-        !engine_assets_init(&config) ||
-        !engine_input_init(&config) ||
-        !engine_render_init(&config)
+        !engine_logger_init(config) ||
+        !engine_assets_init(config) ||
+        !engine_input_init(config) ||
+        !engine_script_init(config) ||
+        !engine_render_init(config)
         ) {
         engine_logger_exit();
         return 1;
     }
 
-    LARGE_INTEGER freq, start, end;
-    QueryPerformanceFrequency(&freq);
-    QueryPerformanceCounter(&start);
+    // Simulation runs at a fixed rate, rendering runs as often as it is allowed to
+    if (config->engine_tick_rate <= 0) config->engine_tick_rate = ENGINE_TICK_RATE;
+    if (config->engine_frame_rate < 0) config->engine_frame_rate = 0;
+    double tick_step = 1.0 / config->engine_tick_rate;
+    double frame_step = config->engine_frame_rate ? 1.0 / config->engine_frame_rate : 0;
+    double tick_accumulator = 0;
+    double frame_start = time_monotonic();
+    logger(LINFO, OMAIN, "Simulation Rate : %dHz", config->engine_tick_rate);
+    logger(LINFO, OMAIN, "Render Rate : %dHz", config->engine_frame_rate);
+
     while (engine_continue) {
 
-        // Process Tick
-        QueryPerformanceCounter(&end);
-        float delta = (float)(end.QuadPart - start.QuadPart) / (float)freq.QuadPart;
-        start = end;
+        // Measure Frame
+        double frame_end = time_monotonic();
+        double delta = frame_end - frame_start;
+        frame_start = frame_end;
+        if (delta > ENGINE_FRAME_LIMIT) {
+            // Stalled for too long (breakpoint, window drag, etc.) don't try to catch up
+            delta = ENGINE_FRAME_LIMIT;
+        }
+        tick_accumulator += delta;
+
+        // Process Simulation
+        unsigned int ticks = 0;
+        while (tick_accumulator >= tick_step) {
+            if (ticks == ENGINE_TICK_LIMIT) {
+                // Simulation can't keep up! Drop the backlog instead of spiralling...
+                logger(LDEBUG, OMAIN, "Simulation Behind, Skipping %d Tick(s)",
+                    (int)(tick_accumulator / tick_step));
+                tick_accumulator -= tick_step * (int)(tick_accumulator / tick_step);
+                break;
+            }
+            if (
+                !engine_input_tick((float)tick_step) ||
+                !engine_script_tick((float)tick_step)
+                ) {
+                engine_continue = FALSE;
+                break;
+            }
+            tick_accumulator -= tick_step;
+            ticks++;
+        }
+
+        // Process Frame
+        render_set_alpha((float)(tick_accumulator / tick_step));
         if (
-            !engine_input_tick(delta) ||
-            !engine_assets_tick(delta) ||
-            !engine_render_tick(delta) ||
-            !engine_logger_tick(delta)
+            !engine_continue ||
+            !engine_assets_tick((float)delta) ||
+            !engine_script_frame((float)delta) ||
+            !engine_render_tick((float)delta) ||
+            !engine_logger_tick((float)delta)
             ) {
             break;
         }
 
         // Process Events
-        MSG event;
-        while (PeekMessage(&event, NULL, 0, 0, PM_REMOVE)) {
-            if (event.message == WM_QUIT) {
-                engine_continue = 0;
-                break;
-            }
-            TranslateMessage(&event);
-            DispatchMessage(&event);
-        }
+        engine_events();
 
         // Sleep .zZ
-        if (delta < RENDER_DELAY) {
-            DWORD sleep_ms = (DWORD)(RENDER_DELAY - delta);
-            if (sleep_ms > 0) {
-                Sleep(sleep_ms);
+        if (frame_step > 0) {
+            double frame_spent = time_monotonic() - frame_start;
+            if (frame_spent < frame_step) {
+                time_sleep(frame_step - frame_spent);
             }
         }
     }
+    engine_script_exit();
     engine_input_exit();
     engine_render_exit();
     engine_assets_exit();
     engine_logger_exit();
     return 0;
 }
+
+#ifdef _WIN32
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd) {
+    (void)hInstance;
+    (void)hPrevInstance;
+    (void)lpCmdLine;
+    (void)nShowCmd;
+
+    // Initialize Config
+    // Arguments are kept for the lifetime of the program as the config references them
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    engine_config_t config = engine_config_init();
+    for (int i = 0; i < argc; i++) {
+        int length = WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, NULL, 0, NULL, NULL);
+        char* arg = malloc(length);
+        if (arg == NULL) {
+            continue;
+        }
+        WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, arg, length, NULL, NULL);
+        engine_config_parse(&config, arg);
+    }
+    LocalFree(argv);
+
+    return engine_run(&config);
+}
 #else
-#error "Engine Loop Not Implemented"
+static void engine_signal(int signal) {
+    (void)signal;
+    engine_continue = FALSE;
+}
+
+int main(int argc, char** argv) {
+
+    // Initialize Config
+    engine_config_t config = engine_config_init();
+    for (int i = 1; i < argc; i++) {
+        engine_config_parse(&config, argv[i]);
+    }
+    signal(SIGINT, engine_signal);
+    signal(SIGTERM, engine_signal);
+
+    return engine_run(&config);
+}
 #endif
\ No newline at end of file
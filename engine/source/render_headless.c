@@ -0,0 +1,216 @@
+#include <render_headless.h>
+#include <engine_logger.h>
+#include <codec_qoi.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static render_target_t headless_target = RENDER_TARGET_WINDOW;
+static const char* headless_path = NULL;
+static unsigned int headless_interval = 1;
+static unsigned int headless_frame = 0;
+
+// QOI Target
+static unsigned int* headless_rgba = NULL;
+static unsigned int headless_rgba_capacity = 0;
+
+// Shared Memory Target
+#ifndef _WIN32
+static int headless_shm_fd = -1;
+static size_t headless_shm_size = 0;
+static unsigned int headless_shm_capacity = 0;
+static unsigned char* headless_shm = NULL;
+#endif
+
+#ifndef _WIN32
+static bool_t headless_shm_resize(unsigned int pixels) {
+    size_t slot_size = sizeof(headless_shm_slot_t) + (size_t)pixels * sizeof(unsigned int);
+    size_t size = sizeof(headless_shm_header_t) + slot_size * HEADLESS_SHM_SLOTS;
+
+    if (headless_shm) {
+        munmap(headless_shm, headless_shm_size);
+        headless_shm = NULL;
+    }
+    if (ftruncate(headless_shm_fd, (off_t)size) != 0) {
+        logger(LERROR, ORENDER, "Unable to Resize Shared Memory (%s)", strerror(errno));
+        return FALSE;
+    }
+    headless_shm = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, headless_shm_fd, 0);
+    if (headless_shm == MAP_FAILED) {
+        headless_shm = NULL;
+        logger(LERROR, ORENDER, "Unable to Map Shared Memory (%s)", strerror(errno));
+        return FALSE;
+    }
+    headless_shm_size = size;
+    headless_shm_capacity = pixels;
+
+    // Reset Header, readers notice the new capacity and remap
+    headless_shm_header_t* header = (headless_shm_header_t*)headless_shm;
+    header->magic = MAGIC_HEADLESS;
+    header->slot_count = HEADLESS_SHM_SLOTS;
+    atomic_store(&header->frame_latest, 0);
+    atomic_store(&header->slot_latest, 0);
+    atomic_store(&header->pixel_capacity, pixels);
+    return TRUE;
+}
+
+static bool_t headless_shm_write(const unsigned int* framebuffer, int width, int height) {
+    unsigned int pixels = (unsigned int)(width * height);
+    if (pixels > headless_shm_capacity && !headless_shm_resize(pixels)) {
+        return FALSE;
+    }
+
+    // Write Slot
+    headless_shm_header_t* header = (headless_shm_header_t*)headless_shm;
+    size_t slot_size = sizeof(headless_shm_slot_t) + (size_t)headless_shm_capacity * sizeof(unsigned int);
+    unsigned int slot_index = headless_frame % HEADLESS_SHM_SLOTS;
+    headless_shm_slot_t* slot = (headless_shm_slot_t*)
+        (headless_shm + sizeof(headless_shm_header_t) + slot_size * slot_index);
+
+    atomic_fetch_add(&slot->sequence, 1);
+    slot->frame = headless_frame;
+    slot->width = (unsigned int)width;
+    slot->height = (unsigned int)height;
+    memcpy(slot + 1, framebuffer, (size_t)pixels * sizeof(unsigned int));
+    atomic_fetch_add(&slot->sequence, 1);
+
+    // Publish Slot
+    atomic_store(&header->slot_latest, slot_index);
+    atomic_store(&header->frame_latest, headless_frame);
+    return TRUE;
+}
+#endif
+
+static bool_t headless_qoi_write(const unsigned int* framebuffer, int width, int height) {
+    unsigned int pixels = (unsigned int)(width * height);
+    if (pixels > headless_rgba_capacity) {
+        unsigned int* rgba = realloc(headless_rgba, pixels * sizeof(unsigned int));
+        if (rgba == NULL) {
+            logger(LERROR, ORENDER, "Failed to allocate Capture Buffer (%s)", strerror(errno));
+            return FALSE;
+        }
+        headless_rgba = rgba;
+        headless_rgba_capacity = pixels;
+    }
+
+    // Convert Pixels (0x00RRGGBB -> 0xRRGGBBAA)
+    for (unsigned int i = 0; i < pixels; i++) {
+        headless_rgba[i] = (framebuffer[i] << 8) | 0xFF;
+    }
+
+    // Encode Frame
+    unsigned char* encoded = NULL;
+    unsigned int encoded_length = 0;
+    qoi_error_t result = qoi_encode(headless_rgba, width, height, &encoded, &encoded_length);
+    if (result != QOI_OK) {
+        logger(LERROR, ORENDER, "Unable to encode Capture (%d)", result);
+        return FALSE;
+    }
+
+    // Write Frame
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/frame_%06u.qoi", headless_path, headless_frame);
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        logger(LERROR, ORENDER, "Unable to Open Capture '%s' (%s)", path, strerror(errno));
+        free(encoded);
+        return FALSE;
+    }
+    size_t written = fwrite(encoded, sizeof(unsigned char), encoded_length, f);
+    fclose(f);
+    free(encoded);
+    if (written != encoded_length) {
+        logger(LERROR, ORENDER, "Unable to Write Capture '%s'", path);
+        return FALSE;
+    }
+
+    logger(LDEBUG, ORENDER, "Captured Frame %s (%.2fKB)", path, encoded_length / 1024.00);
+    return TRUE;
+}
+
+bool_t headless_init(const engine_config_t* config) {
+    headless_target = config->render_target;
+    headless_interval = config->render_capture_interval > 0 ? config->render_capture_interval : 1;
+    headless_frame = 0;
+
+    switch (headless_target) {
+    case RENDER_TARGET_WINDOW: {
+        return TRUE;
+    }
+    case RENDER_TARGET_QOI: {
+        headless_path = config->render_capture_path ? config->render_capture_path : HEADLESS_QOI_PATH;
+        logger(LINFO, ORENDER, "Headless Target : QOI every %d frame(s) into '%s'",
+            headless_interval, headless_path);
+        return TRUE;
+    }
+    case RENDER_TARGET_SHM: {
+#ifdef _WIN32
+        logger(LERROR, ORENDER, "Shared Memory Target is not supported on this Platform");
+        return FALSE;
+#else
+        headless_path = config->render_capture_path ? config->render_capture_path : HEADLESS_SHM_NAME;
+        headless_shm_fd = shm_open(headless_path, O_CREAT | O_RDWR, 0600);
+        if (headless_shm_fd < 0) {
+            logger(LERROR, ORENDER, "Unable to Open Shared Memory '%s' (%s)", headless_path, strerror(errno));
+            return FALSE;
+        }
+        logger(LINFO, ORENDER, "Headless Target : Shared Memory '%s' (%d slots)",
+            headless_path, HEADLESS_SHM_SLOTS);
+        return TRUE;
+#endif
+    }
+    }
+
+    logger(LERROR, ORENDER, "Unknown Render Target (%d)", headless_target);
+    return FALSE;
+}
+
+bool_t headless_present(const unsigned int* framebuffer, int width, int height) {
+    headless_frame++;
+    switch (headless_target) {
+    case RENDER_TARGET_WINDOW: {
+        return TRUE;
+    }
+    case RENDER_TARGET_QOI: {
+        if (headless_frame % headless_interval != 0) {
+            return TRUE;
+        }
+        return headless_qoi_write(framebuffer, width, height);
+    }
+    case RENDER_TARGET_SHM: {
+#ifdef _WIN32
+        return FALSE;
+#else
+        return headless_shm_write(framebuffer, width, height);
+#endif
+    }
+    }
+    return FALSE;
+}
+
+void headless_exit(void) {
+    free(headless_rgba);
+    headless_rgba = NULL;
+    headless_rgba_capacity = 0;
+#ifndef _WIN32
+    if (headless_shm) {
+        munmap(headless_shm, headless_shm_size);
+        headless_shm = NULL;
+    }
+    if (headless_shm_fd >= 0) {
+        close(headless_shm_fd);
+        shm_unlink(headless_path);
+        headless_shm_fd = -1;
+    }
+    headless_shm_capacity = 0;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,526 @@
+#include <render_raster.h>
+#include <engine_logger.h>
+#include <codec_bc.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <float.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef struct {
+    unsigned int* items;            // Command Indexes (Drawn in Order)
+    unsigned int size;              // Index Count
+    unsigned int capacity;          // Index Capacity
+} raster_bin_t;
+
+typedef struct {
+    float a[3];                     // Edge Function X Coefficients
+    float b[3];                     // Edge Function Y Coefficients
+    float c[3];                     // Edge Function Constants
+    float bias[3];                  // Edge Bias (Top-Left Fill Rule)
+    float r[3];                     // Vertex Red
+    float g[3];                     // Vertex Green
+    float bl[3];                    // Vertex Blue
+    float area_inv;                 // Inverse Triangle Area
+    int min_x;                      // Screen Bounds (Inclusive)
+    int min_y;                      // Screen Bounds (Inclusive)
+    int max_x;                      // Screen Bounds (Exclusive)
+    int max_y;                      // Screen Bounds (Exclusive)
+} raster_setup_t;
+
+static pthread_t raster_threads[RASTER_THREAD_LIMIT];
+static unsigned int raster_thread_count = 0;
+static pthread_mutex_t raster_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t raster_cond_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t raster_cond_done = PTHREAD_COND_INITIALIZER;
+static unsigned int raster_generation = 0;
+static unsigned int raster_working = 0;
+static bool_t raster_running = TRUE;
+
+// Current Job (Read-Only while Shading)
+static atomic_uint job_tile_next;
+static const raster_list_t* job_list = NULL;
+static unsigned int* job_framebuffer = NULL;
+static int job_width = 0;
+static int job_height = 0;
+static int job_tiles_x = 0;
+static int job_tiles_y = 0;
+static raster_bin_t* job_bins = NULL;
+static unsigned int job_bin_capacity = 0;
+static raster_setup_t* job_setup = NULL;
+static unsigned int job_setup_capacity = 0;
+
+static inline int raster_min(int a, int b) { return a < b ? a : b; }
+static inline int raster_max(int a, int b) { return a > b ? a : b; }
+static inline unsigned int raster_channel(float v) {
+    return v <= 0 ? 0 : v >= 255.0f ? 255 : (unsigned int)(v + 0.5f);
+}
+
+static bool_t raster_list_reserve(raster_list_t* list) {
+    if (list->size < list->capacity) {
+        return TRUE;
+    }
+    unsigned int capacity = list->capacity ? list->capacity * 2 : RASTER_LIST_MINIMUM;
+    raster_command_t* commands = realloc(list->commands, capacity * sizeof(raster_command_t));
+    if (commands == NULL) {
+        logger(LERROR, ORENDER, "Failed to grow Raster List (%s)", strerror(errno));
+        return FALSE;
+    }
+    list->commands = commands;
+    list->capacity = capacity;
+    return TRUE;
+}
+
+void raster_list_reset(raster_list_t* list, unsigned int clear) {
+    list->size = 0;
+    list->clear = clear;
+}
+
+bool_t raster_list_triangle(raster_list_t* list, const raster_vertex_t v[3]) {
+    if (!raster_list_reserve(list)) {
+        return FALSE;
+    }
+    raster_command_t* c = &list->commands[list->size++];
+    c->type = RASTER_COMMAND_TRIANGLE;
+    memcpy(c->triangle.v, v, sizeof(c->triangle.v));
+    return TRUE;
+}
+
+bool_t raster_list_sprite(raster_list_t* list, const raster_sprite_t* sprite) {
+    if ((sprite->pixels == NULL && sprite->blocks == NULL) || sprite->width == 0 || sprite->height == 0) {
+        return TRUE;
+    }
+    if (!raster_list_reserve(list)) {
+        return FALSE;
+    }
+    raster_command_t* c = &list->commands[list->size++];
+    c->type = RASTER_COMMAND_SPRITE;
+    c->sprite = *sprite;
+    return TRUE;
+}
+
+void raster_list_free(raster_list_t* list) {
+    free(list->commands);
+    list->commands = NULL;
+    list->capacity = 0;
+    list->size = 0;
+}
+
+static void raster_setup_triangle(raster_setup_t* s, const raster_triangle_t* t) {
+
+    // Viewport Transform (NDC -> Pixels)
+    float x[3], y[3];
+    raster_vertex_t v[3] = { t->v[0], t->v[1], t->v[2] };
+    for (int i = 0; i < 3; i++) {
+        x[i] = (v[i].x + 1.0f) * 0.5f * (float)job_width;
+        y[i] = (v[i].y + 1.0f) * 0.5f * (float)job_height;
+    }
+
+    // Normalize Winding
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (area < 0) {
+        float tx = x[1], ty = y[1];
+        raster_vertex_t tv = v[1];
+        x[1] = x[2]; y[1] = y[2]; v[1] = v[2];
+        x[2] = tx;   y[2] = ty;   v[2] = tv;
+        area = -area;
+    }
+    if (area <= 0) {
+        // Degenerate, bounds are left empty so it is never binned
+        s->min_x = s->max_x = s->min_y = s->max_y = 0;
+        return;
+    }
+    s->area_inv = 1.0f / area;
+
+    // Edge Functions: Edge i is opposite of Vertex i
+    for (int i = 0; i < 3; i++) {
+        int va = (i + 1) % 3;
+        int vb = (i + 2) % 3;
+        s->a[i] = y[va] - y[vb];
+        s->b[i] = x[vb] - x[va];
+        s->c[i] = -s->b[i] * y[va] - s->a[i] * x[va];
+        bool_t top_left = (s->a[i] > 0) || (s->a[i] == 0 && s->b[i] > 0);
+        s->bias[i] = top_left ? 0 : -FLT_MIN;
+        s->r[i] = (float)((v[i].color >> 16) & 0xFF);
+        s->g[i] = (float)((v[i].color >> 8) & 0xFF);
+        s->bl[i] = (float)((v[i].color) & 0xFF);
+    }
+
+    // Screen Bounds
+    float min_x = x[0], max_x = x[0], min_y = y[0], max_y = y[0];
+    for (int i = 1; i < 3; i++) {
+        if (x[i] < min_x) min_x = x[i];
+        if (x[i] > max_x) max_x = x[i];
+        if (y[i] < min_y) min_y = y[i];
+        if (y[i] > max_y) max_y = y[i];
+    }
+    s->min_x = raster_max((int)min_x, 0);
+    s->min_y = raster_max((int)min_y, 0);
+    s->max_x = raster_min((int)max_x + 1, job_width);
+    s->max_y = raster_min((int)max_y + 1, job_height);
+}
+
+static void raster_setup_sprite(raster_setup_t* s, const raster_sprite_t* p) {
+    s->min_x = raster_max(p->x, 0);
+    s->min_y = raster_max(p->y, 0);
+    s->max_x = raster_min(p->x + p->w, job_width);
+    s->max_y = raster_min(p->y + p->h, job_height);
+}
+
+static bool_t raster_bin_push(raster_bin_t* bin, unsigned int index) {
+    if (bin->size == bin->capacity) {
+        unsigned int capacity = bin->capacity ? bin->capacity * 2 : 32;
+        unsigned int* items = realloc(bin->items, capacity * sizeof(unsigned int));
+        if (items == NULL) {
+            logger(LERROR, ORENDER, "Failed to grow Raster Bin (%s)", strerror(errno));
+            return FALSE;
+        }
+        bin->items = items;
+        bin->capacity = capacity;
+    }
+    bin->items[bin->size++] = index;
+    return TRUE;
+}
+
+static inline void raster_pixel_triangle(const raster_setup_t* s, unsigned int* dst, float px, float py) {
+    float w0 = s->a[0] * px + s->b[0] * py + s->c[0];
+    float w1 = s->a[1] * px + s->b[1] * py + s->c[1];
+    float w2 = s->a[2] * px + s->b[2] * py + s->c[2];
+    if (w0 < -s->bias[0] || w1 < -s->bias[1] || w2 < -s->bias[2]) {
+        return;
+    }
+    w0 *= s->area_inv;
+    w1 *= s->area_inv;
+    w2 *= s->area_inv;
+    unsigned int r = raster_channel(w0 * s->r[0] + w1 * s->r[1] + w2 * s->r[2]);
+    unsigned int g = raster_channel(w0 * s->g[0] + w1 * s->g[1] + w2 * s->g[2]);
+    unsigned int b = raster_channel(w0 * s->bl[0] + w1 * s->bl[1] + w2 * s->bl[2]);
+    *dst = (r << 16) | (g << 8) | b;
+}
+
+static void raster_shade_triangle(const raster_setup_t* s, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y < y1; y++) {
+        unsigned int* row = job_framebuffer + (size_t)y * job_width;
+        float py = (float)y + 0.5f;
+        int x = x0;
+
+#ifdef __SSE2__
+        // Evaluate Edge Functions for 4 Pixels at a time
+        __m128 step = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        __m128 zero = _mm_setzero_ps();
+        __m128 max = _mm_set1_ps(255.0f);
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 inv = _mm_set1_ps(s->area_inv);
+        __m128 e[3], de[3], edge[3];
+        for (int i = 0; i < 3; i++) {
+            // The bias is compared against rather than added, it would vanish into the edge value
+            float base = s->a[i] * ((float)x + 0.5f) + s->b[i] * py + s->c[i];
+            e[i] = _mm_add_ps(_mm_set1_ps(base), _mm_mul_ps(_mm_set1_ps(s->a[i]), step));
+            de[i] = _mm_set1_ps(s->a[i] * 4.0f);
+            edge[i] = _mm_set1_ps(-s->bias[i]);
+        }
+        for (; x + 4 <= x1; x += 4) {
+            __m128 mask = _mm_and_ps(
+                _mm_and_ps(_mm_cmpge_ps(e[0], edge[0]), _mm_cmpge_ps(e[1], edge[1])),
+                _mm_cmpge_ps(e[2], edge[2])
+            );
+            if (_mm_movemask_ps(mask)) {
+                __m128 l0 = _mm_mul_ps(e[0], inv);
+                __m128 l1 = _mm_mul_ps(e[1], inv);
+                __m128 l2 = _mm_mul_ps(e[2], inv);
+                __m128 r = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(l0, _mm_set1_ps(s->r[0])),
+                    _mm_mul_ps(l1, _mm_set1_ps(s->r[1]))),
+                    _mm_mul_ps(l2, _mm_set1_ps(s->r[2])));
+                __m128 g = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(l0, _mm_set1_ps(s->g[0])),
+                    _mm_mul_ps(l1, _mm_set1_ps(s->g[1]))),
+                    _mm_mul_ps(l2, _mm_set1_ps(s->g[2])));
+                __m128 b = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(l0, _mm_set1_ps(s->bl[0])),
+                    _mm_mul_ps(l1, _mm_set1_ps(s->bl[1]))),
+                    _mm_mul_ps(l2, _mm_set1_ps(s->bl[2])));
+                __m128i ri = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(r, half), zero), max));
+                __m128i gi = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(g, half), zero), max));
+                __m128i bi = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(b, half), zero), max));
+                __m128i color = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ri, 16), _mm_slli_epi32(gi, 8)), bi);
+                __m128i keep = _mm_castps_si128(mask);
+                __m128i old = _mm_loadu_si128((const __m128i*)(row + x));
+                __m128i out = _mm_or_si128(_mm_and_si128(keep, color), _mm_andnot_si128(keep, old));
+                _mm_storeu_si128((__m128i*)(row + x), out);
+            }
+            e[0] = _mm_add_ps(e[0], de[0]);
+            e[1] = _mm_add_ps(e[1], de[1]);
+            e[2] = _mm_add_ps(e[2], de[2]);
+        }
+#endif
+
+        // Remaining Pixels
+        for (; x < x1; x++) {
+            raster_pixel_triangle(s, &row[x], (float)x + 0.5f, py);
+        }
+    }
+}
+
+// Texel of a block compressed sprite, the last decoded block is kept around since
+// neighbouring pixels mostly sample the same one.
+static inline unsigned int raster_fetch_block(const raster_sprite_t* p, unsigned int sx, unsigned int sy, size_t* cached, unsigned int* texels) {
+    size_t block = (size_t)(sy / 4) * ((p->width + 3) / 4) + sx / 4;
+    if (block != *cached) {
+        if (!bc_decode_block(p->blocks + block * bc_block_size(p->format), p->format, texels)) {
+            memset(texels, 0, 16 * sizeof(unsigned int));
+        }
+        *cached = block;
+    }
+    return texels[(sy % 4) * 4 + sx % 4];
+}
+
+static void raster_shade_sprite(const raster_sprite_t* p, int x0, int y0, int x1, int y1) {
+    size_t cached = SIZE_MAX;
+    unsigned int texels[16];
+    for (int y = y0; y < y1; y++) {
+        unsigned int* row = job_framebuffer + (size_t)y * job_width;
+        unsigned int sy = (unsigned int)(((long long)(y - p->y) * p->height) / p->h);
+        const unsigned int* src = p->pixels ? p->pixels + (size_t)sy * p->width : NULL;
+        for (int x = x0; x < x1; x++) {
+            unsigned int sx = (unsigned int)(((long long)(x - p->x) * p->width) / p->w);
+            unsigned int argb = src ? src[sx] : raster_fetch_block(p, sx, sy, &cached, texels);
+            unsigned int a = argb >> 24;
+            if (a == 0) {
+                continue;
+            }
+            if (a == 0xFF) {
+                row[x] = argb & 0xFFFFFF;
+                continue;
+            }
+            // Blend (Premultiplied Alpha)
+            unsigned int dst = row[x];
+            unsigned int rb = (((dst & 0xFF00FF) * (255 - a)) >> 8) & 0xFF00FF;
+            unsigned int g = (((dst & 0x00FF00) * (255 - a)) >> 8) & 0x00FF00;
+            row[x] = (argb & 0xFFFFFF) + rb + g;
+        }
+    }
+}
+
+static void raster_process_tiles(void) {
+    unsigned int tile_count = (unsigned int)(job_tiles_x * job_tiles_y);
+    unsigned int tile;
+    while ((tile = atomic_fetch_add(&job_tile_next, 1)) < tile_count) {
+        int tx0 = (int)(tile % job_tiles_x) * RASTER_TILE_SIZE;
+        int ty0 = (int)(tile / job_tiles_x) * RASTER_TILE_SIZE;
+        int tx1 = raster_min(tx0 + RASTER_TILE_SIZE, job_width);
+        int ty1 = raster_min(ty0 + RASTER_TILE_SIZE, job_height);
+
+        // Clear Tile
+        for (int y = ty0; y < ty1; y++) {
+            unsigned int* row = job_framebuffer + (size_t)y * job_width;
+            for (int x = tx0; x < tx1; x++) {
+                row[x] = job_list->clear;
+            }
+        }
+
+        // Shade Tile
+        raster_bin_t* bin = &job_bins[tile];
+        for (unsigned int i = 0; i < bin->size; i++) {
+            unsigned int index = bin->items[i];
+            const raster_setup_t* s = &job_setup[index];
+            int x0 = raster_max(s->min_x, tx0);
+            int y0 = raster_max(s->min_y, ty0);
+            int x1 = raster_min(s->max_x, tx1);
+            int y1 = raster_min(s->max_y, ty1);
+            switch (job_list->commands[index].type) {
+            case RASTER_COMMAND_TRIANGLE: {
+                raster_shade_triangle(s, x0, y0, x1, y1);
+                break;
+            }
+            case RASTER_COMMAND_SPRITE: {
+                raster_shade_sprite(&job_list->commands[index].sprite, x0, y0, x1, y1);
+                break;
+            }
+            }
+        }
+    }
+}
+
+static void* raster_worker(void* data) {
+    (void)data;
+    unsigned int generation = 0;
+
+    pthread_mutex_lock(&raster_mtx);
+    while (TRUE) {
+
+        // Await Work
+        while (raster_running && generation == raster_generation) {
+            pthread_cond_wait(&raster_cond_start, &raster_mtx);
+        }
+        if (!raster_running) {
+            break;
+        }
+        generation = raster_generation;
+        pthread_mutex_unlock(&raster_mtx);
+
+        raster_process_tiles();
+
+        // Report Completion
+        pthread_mutex_lock(&raster_mtx);
+        if (--raster_working == 0) {
+            pthread_cond_signal(&raster_cond_done);
+        }
+    }
+    pthread_mutex_unlock(&raster_mtx);
+    return NULL;
+}
+
+bool_t raster_draw(const raster_list_t* list, unsigned int* framebuffer, int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return TRUE;
+    }
+    job_list = list;
+    job_framebuffer = framebuffer;
+    job_width = width;
+    job_height = height;
+    job_tiles_x = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    job_tiles_y = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+
+    // Allocate Bins
+    unsigned int tile_count = (unsigned int)(job_tiles_x * job_tiles_y);
+    if (tile_count > job_bin_capacity) {
+        raster_bin_t* bins = realloc(job_bins, tile_count * sizeof(raster_bin_t));
+        if (bins == NULL) {
+            logger(LERROR, ORENDER, "Failed to allocate %d Raster Bins (%s)", tile_count, strerror(errno));
+            return FALSE;
+        }
+        memset(&bins[job_bin_capacity], 0, (tile_count - job_bin_capacity) * sizeof(raster_bin_t));
+        job_bins = bins;
+        job_bin_capacity = tile_count;
+    }
+    for (unsigned int i = 0; i < tile_count; i++) {
+        job_bins[i].size = 0;
+    }
+    if (list->size > job_setup_capacity) {
+        raster_setup_t* setup = realloc(job_setup, list->capacity * sizeof(raster_setup_t));
+        if (setup == NULL) {
+            logger(LERROR, ORENDER, "Failed to allocate Raster Setup (%s)", strerror(errno));
+            return FALSE;
+        }
+        job_setup = setup;
+        job_setup_capacity = list->capacity;
+    }
+
+    // Bin Commands
+    for (unsigned int i = 0; i < list->size; i++) {
+        const raster_command_t* c = &list->commands[i];
+        raster_setup_t* s = &job_setup[i];
+        switch (c->type) {
+        case RASTER_COMMAND_TRIANGLE: {
+            raster_setup_triangle(s, &c->triangle);
+            break;
+        }
+        case RASTER_COMMAND_SPRITE: {
+            raster_setup_sprite(s, &c->sprite);
+            break;
+        }
+        }
+        if (s->min_x >= s->max_x || s->min_y >= s->max_y) {
+            continue;
+        }
+        int bx0 = s->min_x / RASTER_TILE_SIZE;
+        int by0 = s->min_y / RASTER_TILE_SIZE;
+        int bx1 = (s->max_x - 1) / RASTER_TILE_SIZE;
+        int by1 = (s->max_y - 1) / RASTER_TILE_SIZE;
+        for (int by = by0; by <= by1; by++) {
+            for (int bx = bx0; bx <= bx1; bx++) {
+                if (!raster_bin_push(&job_bins[by * job_tiles_x + bx], i)) {
+                    return FALSE;
+                }
+            }
+        }
+    }
+
+    // Shade Tiles
+    atomic_store(&job_tile_next, 0);
+    pthread_mutex_lock(&raster_mtx);
+    raster_generation++;
+    raster_working = raster_thread_count;
+    pthread_cond_broadcast(&raster_cond_start);
+    pthread_mutex_unlock(&raster_mtx);
+
+    raster_process_tiles();
+
+    pthread_mutex_lock(&raster_mtx);
+    while (raster_working > 0) {
+        pthread_cond_wait(&raster_cond_done, &raster_mtx);
+    }
+    pthread_mutex_unlock(&raster_mtx);
+
+    return TRUE;
+}
+
+bool_t raster_init(int threads) {
+
+    // The calling thread shades tiles as well
+    if (threads <= 0) {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        threads = (int)info.dwNumberOfProcessors;
+#else
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    }
+    if (threads > RASTER_THREAD_LIMIT) {
+        threads = RASTER_THREAD_LIMIT;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    logger(LINFO, ORENDER, "Creating %d Raster Thread(s)", threads - 1);
+    raster_running = TRUE;
+    for (int i = 0; i < threads - 1; i++) {
+        int error = pthread_create(&raster_threads[i], NULL, raster_worker, NULL);
+        if (error) {
+            logger(LERROR, ORENDER, "Failed to Create Raster Thread #%02d (%s)", i, strerror(error));
+            return FALSE;
+        }
+        raster_thread_count++;
+    }
+
+    return TRUE;
+}
+
+void raster_exit(void) {
+
+    // Cleanup Threads
+    pthread_mutex_lock(&raster_mtx);
+    raster_running = FALSE;
+    pthread_cond_broadcast(&raster_cond_start);
+    pthread_mutex_unlock(&raster_mtx);
+    for (unsigned int i = 0; i < raster_thread_count; i++) {
+        pthread_join(raster_threads[i], NULL);
+    }
+    raster_thread_count = 0;
+
+    // Cleanup Bins
+    for (unsigned int i = 0; i < job_bin_capacity; i++) {
+        free(job_bins[i].items);
+    }
+    free(job_bins);
+    free(job_setup);
+    job_bins = NULL;
+    job_setup = NULL;
+    job_bin_capacity = 0;
+    job_setup_capacity = 0;
+}
\ No newline at end of file
@@ -15,7 +15,8 @@ input_files=$(find "source" -type f -name "*.c")
 extra_files=$(find "source" -type f -name "*.o")
 gcc $input_files $extra_files \
     -Wall -Wextra -Werror -pedantic -std=c23 \
-    -Iinclude -flto -O3  \
+    -Iinclude -I$LUA_SDK/src -flto -O3 \
+    -L$LUA_SDK/src -llua -lm -ldl -lpthread \
     -o "$OUTPUT/yuri.elf"
 
 echo "Build Complete! Your executable can be found in '$OUTPUT'"
@@ -31,7 +31,8 @@ $extraFiles = Get-ChildItem -Recurse -Include "*.o" -Path "source" | ForEach-Obj
 
 gcc $inputFiles $extraFiles $resources `
     -Wall -Wextra -Werror -pedantic -std=c23 `
-    -Iinclude $opt_level `
+    -Iinclude -I$env:LUA_SDK\src $opt_level `
+    -L$env:LUA_SDK\src -llua -lm `
     -o "..\bin\yuri.exe"
 
 if ($LASTEXITCODE -ne 0) {
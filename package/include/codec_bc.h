@@ -0,0 +1,767 @@
+#include <stdatomic.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+#pragma once
+
+// Block compressed images keep GPU texture blocks behind a small header, so they can
+// be uploaded or sampled as they are instead of being expanded to 32-Bit pixels. Every
+// 4x4 block is encoded on its own, rows of blocks are spread across threads. Pixels
+// past the right and bottom edge repeat the last column and row.
+//
+//   uint32  Magic 'BCNX'
+//   uint8   Block Format (1 = BC1, 3 = BC3, 7 = BC7)
+//   uint8   Colorspace (0 = sRGB, 1 = Linear)
+//   uint16  Reserved (0)
+//   uint32  Width
+//   uint32  Height
+//   Blocks, left to right and top to bottom (8 Bytes each for BC1, 16 otherwise)
+//
+// BC7 blocks are always written in mode 6 (single subset, RGBA endpoints, 4-Bit indices).
+
+static const unsigned int MAGIC_BCNX = ('B') | ('C' << 8) | ('N' << 16) | ('X' << 24);
+
+#define BC_HEADER_SIZE       16
+#define BC_THREAD_LIMIT      16
+#define BC_MAX_DIMENSION     16384
+
+typedef enum {
+    BC_FORMAT_BC1 = 1u,             // RGB + 1-Bit Alpha, 8 Bytes per Block
+    BC_FORMAT_BC3 = 3u,             // RGB + Interpolated Alpha, 16 Bytes per Block
+    BC_FORMAT_BC7 = 7u,             // RGBA (Mode 6), 16 Bytes per Block
+} bc_format_t;
+
+typedef enum {
+    BC_QUALITY_FAST = 0u,           // Bounding Box Endpoints
+    BC_QUALITY_NORMAL = 1u,         // Principal Axis Endpoints, refined once
+    BC_QUALITY_HIGH = 2u,           // Principal Axis Endpoints, refined until no longer improving
+} bc_quality_t;
+
+typedef enum {
+    BC_OK = 0,
+    BC_MEMORY_ERROR = 1,
+    BC_INVALID_ARGUMENTS = 2,
+    BC_UNEXPECTED_EOF = 3,
+    BC_INVALID_HEADER = 501,
+    BC_UNSUPPORTED_MODE = 502,
+} bc_error_t;
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static inline unsigned int bc_block_size(unsigned int format) {
+    return format == BC_FORMAT_BC1 ? 8 : 16;
+}
+
+static inline size_t bc_length(unsigned int format, unsigned int width, unsigned int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * bc_block_size(format);
+}
+
+static inline int bc_clamp(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// -----------------------------------------------------------------------------
+// Decoding
+// -----------------------------------------------------------------------------
+
+static inline void bc_unpack565(unsigned int v, int* out) {
+    int r = (v >> 11) & 0x1F, g = (v >> 5) & 0x3F, b = v & 0x1F;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+// Colors of a BC1 style block, BC3 always uses the four color mode
+static inline void bc1_palette(unsigned int c0, unsigned int c1, int four, int palette[4][4]) {
+    bc_unpack565(c0, palette[0]);
+    bc_unpack565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        if (four) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = four ? 255 : 0;
+}
+
+// Alpha values of a BC4 block
+static inline void bc4_palette(int a0, int a1, int palette[8]) {
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1) {
+        for (int i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+    }
+    else {
+        for (int i = 1; i < 5; i++) {
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static inline unsigned long long bc_read_u64(const unsigned char* b) {
+    unsigned long long v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | b[i];
+    }
+    return v;
+}
+
+// Read 'count' bits starting at bit 'offset' of a 128-Bit block
+static inline unsigned int bc_bits(const unsigned long long* block, unsigned int offset, unsigned int count) {
+    unsigned long long v = offset >= 64 ? block[1] >> (offset - 64) : block[0] >> offset;
+    if (offset < 64 && offset + count > 64) {
+        v |= block[1] << (64 - offset);
+    }
+    return (unsigned int)(v & ((1ull << count) - 1));
+}
+
+// Decode a block to 16 pixels (0xRRGGBBAA), returns FALSE for BC7 modes other than 6
+static inline int bc_decode_block(const unsigned char* block, unsigned int format, unsigned int* out) {
+    int palette[16][4];
+    switch (format) {
+    case BC_FORMAT_BC1:
+    case BC_FORMAT_BC3: {
+        const unsigned char* color = format == BC_FORMAT_BC3 ? block + 8 : block;
+        unsigned int c0 = color[0] | (color[1] << 8);
+        unsigned int c1 = color[2] | (color[3] << 8);
+        unsigned int indices = color[4] | (color[5] << 8) | (color[6] << 16) | ((unsigned int)color[7] << 24);
+        bc1_palette(c0, c1, format == BC_FORMAT_BC3 || c0 > c1, palette);
+        int alpha[8];
+        unsigned long long alpha_indices = 0;
+        if (format == BC_FORMAT_BC3) {
+            bc4_palette(block[0], block[1], alpha);
+            alpha_indices = bc_read_u64(block) >> 16;
+        }
+        for (int i = 0; i < 16; i++) {
+            const int* p = palette[(indices >> (i * 2)) & 3];
+            int a = format == BC_FORMAT_BC3 ? alpha[(alpha_indices >> (i * 3)) & 7] : p[3];
+            out[i] = ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)a;
+        }
+        return 1;
+    }
+    case BC_FORMAT_BC7: {
+        unsigned long long bits[2] = { bc_read_u64(block), bc_read_u64(block + 8) };
+        if ((bits[0] & 0x7F) != 0x40) {
+            return 0;
+        }
+        int e[2][4];
+        for (int c = 0; c < 4; c++) {
+            e[0][c] = (int)bc_bits(bits, 7 + c * 14, 7) << 1;
+            e[1][c] = (int)bc_bits(bits, 14 + c * 14, 7) << 1;
+        }
+        for (int c = 0; c < 4; c++) {
+            e[0][c] |= (int)bc_bits(bits, 63, 1);
+            e[1][c] |= (int)bc_bits(bits, 64, 1);
+        }
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 4; c++) {
+                palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e[0][c] + BC7_WEIGHTS[i] * e[1][c] + 32) >> 6;
+            }
+        }
+        for (int i = 0; i < 16; i++) {
+            unsigned int index = i == 0 ? bc_bits(bits, 65, 3) : bc_bits(bits, 64 + i * 4, 4);
+            const int* p = palette[index];
+            out[i] = ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+        }
+        return 1;
+    }
+    default: {
+        return 0;
+    }
+    }
+}
+
+// Expand a block compressed stream to 0xRRGGBBAA pixels
+static inline bc_error_t bc_decode(
+    const unsigned char* input_buffer,  // Encoded Buffer
+    const unsigned int input_length,    // Encoded Buffer Length
+    unsigned int** image_rgba,          // Pixel Data
+    unsigned int* image_width,          // Array Width
+    unsigned int* image_height          // Array Height
+) {
+    if (!input_buffer || !image_rgba || !image_width || !image_height) {
+        return BC_INVALID_ARGUMENTS;
+    }
+    if (input_length < BC_HEADER_SIZE) {
+        return BC_UNEXPECTED_EOF;
+    }
+    unsigned int magic = (unsigned int)bc_read_u64(input_buffer);
+    unsigned int format = input_buffer[4];
+    unsigned int width = (unsigned int)(bc_read_u64(input_buffer + 8));
+    unsigned int height = (unsigned int)(bc_read_u64(input_buffer + 8) >> 32);
+    if (magic != MAGIC_BCNX || (format != BC_FORMAT_BC1 && format != BC_FORMAT_BC3 && format != BC_FORMAT_BC7) ||
+        width == 0 || width > BC_MAX_DIMENSION || height == 0 || height > BC_MAX_DIMENSION) {
+        return BC_INVALID_HEADER;
+    }
+    if (BC_HEADER_SIZE + bc_length(format, width, height) > input_length) {
+        return BC_UNEXPECTED_EOF;
+    }
+    unsigned int* output = malloc((size_t)width * height * sizeof(unsigned int));
+    if (!output) {
+        return BC_MEMORY_ERROR;
+    }
+    unsigned int blocks_x = (width + 3) / 4;
+    const unsigned char* blocks = input_buffer + BC_HEADER_SIZE;
+    for (unsigned int by = 0; by < (height + 3) / 4; by++) {
+        for (unsigned int bx = 0; bx < blocks_x; bx++) {
+            unsigned int texels[16];
+            if (!bc_decode_block(blocks + ((size_t)by * blocks_x + bx) * bc_block_size(format), format, texels)) {
+                free(output);
+                return BC_UNSUPPORTED_MODE;
+            }
+            for (unsigned int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (unsigned int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    output[(size_t)(by * 4 + y) * width + bx * 4 + x] = texels[y * 4 + x];
+                }
+            }
+        }
+    }
+    *image_rgba = output;
+    *image_width = width;
+    *image_height = height;
+    return BC_OK;
+}
+
+// -----------------------------------------------------------------------------
+// Encoding
+// -----------------------------------------------------------------------------
+
+static inline unsigned int bc_pack565(const float* c) {
+    int r = bc_clamp((int)(c[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+    int g = bc_clamp((int)(c[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+    int b = bc_clamp((int)(c[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+    return (unsigned int)((r << 11) | (g << 5) | b);
+}
+
+// Pick the closest palette entry for every used pixel, returns the summed squared error
+static inline float bc_fit(const float px[16][4], const unsigned char* used, int channels, const int palette[][4], int entries, unsigned int* indices) {
+    float total = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        if (!used[i]) {
+            continue;
+        }
+        float best = INFINITY;
+        for (int p = 0; p < entries; p++) {
+            float error = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                float d = px[i][c] - (float)palette[p][c];
+                error += d * d;
+            }
+            if (error < best) {
+                best = error;
+                indices[i] = (unsigned int)p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// Endpoints spanning the used pixels, along their principal axis unless asked to be fast
+static inline void bc_endpoints(const float px[16][4], const unsigned char* used, int channels, bc_quality_t quality, float* e0, float* e1) {
+    float mean[4] = { 0 }, lo[4], hi[4];
+    int count = 0;
+    for (int c = 0; c < 4; c++) {
+        lo[c] = c < channels ? INFINITY : 0.0f;
+        hi[c] = c < channels ? -INFINITY : 0.0f;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (!used[i]) continue;
+        for (int c = 0; c < channels; c++) {
+            mean[c] += px[i][c];
+            if (px[i][c] < lo[c]) lo[c] = px[i][c];
+            if (px[i][c] > hi[c]) hi[c] = px[i][c];
+        }
+        count++;
+    }
+    if (count == 0) {
+        memset(e0, 0, 4 * sizeof(float));
+        memset(e1, 0, 4 * sizeof(float));
+        return;
+    }
+    if (quality == BC_QUALITY_FAST) {
+        memcpy(e0, lo, 4 * sizeof(float));
+        memcpy(e1, hi, 4 * sizeof(float));
+        return;
+    }
+    for (int c = 0; c < channels; c++) {
+        mean[c] /= (float)count;
+    }
+
+    // Covariance & Power Iteration
+    float cov[4][4] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        if (!used[i]) continue;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+            }
+        }
+    }
+    float axis[4] = { 0 };
+    for (int c = 0; c < channels; c++) {
+        axis[c] = hi[c] - lo[c];
+    }
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = { 0 }, length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += cov[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f) {
+            break;
+        }
+        length = sqrtf(length);
+        for (int c = 0; c < channels; c++) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    // Project onto the Axis
+    float t_lo = INFINITY, t_hi = -INFINITY;
+    for (int i = 0; i < 16; i++) {
+        if (!used[i]) continue;
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (px[i][c] - mean[c]) * axis[c];
+        }
+        if (t < t_lo) t_lo = t;
+        if (t > t_hi) t_hi = t;
+    }
+    for (int c = 0; c < 4; c++) {
+        e0[c] = c < channels ? mean[c] + axis[c] * t_lo : 0.0f;
+        e1[c] = c < channels ? mean[c] + axis[c] * t_hi : 0.0f;
+    }
+}
+
+// Least squares endpoints for the given blend weights (0 = e0, 1 = e1), FALSE if degenerate
+static inline int bc_refine(const float px[16][4], const unsigned char* used, int channels, const float* weights, float* e0, float* e1) {
+    float a = 0.0f, b = 0.0f, c = 0.0f, d0[4] = { 0 }, d1[4] = { 0 };
+    for (int i = 0; i < 16; i++) {
+        if (!used[i]) continue;
+        float w = weights[i];
+        a += (1.0f - w) * (1.0f - w);
+        b += (1.0f - w) * w;
+        c += w * w;
+        for (int k = 0; k < channels; k++) {
+            d0[k] += (1.0f - w) * px[i][k];
+            d1[k] += w * px[i][k];
+        }
+    }
+    float det = a * c - b * b;
+    if (fabsf(det) < 1e-6f) {
+        return 0;
+    }
+    for (int k = 0; k < channels; k++) {
+        e0[k] = fminf(fmaxf((c * d0[k] - b * d1[k]) / det, 0.0f), 255.0f);
+        e1[k] = fminf(fmaxf((a * d1[k] - b * d0[k]) / det, 0.0f), 255.0f);
+    }
+    return 1;
+}
+
+static inline int bc_refinements(bc_quality_t quality) {
+    return quality == BC_QUALITY_HIGH ? 4 : (quality == BC_QUALITY_NORMAL ? 1 : 0);
+}
+
+typedef struct {
+    unsigned int c0;                // First Endpoint (565)
+    unsigned int c1;                // Second Endpoint (565)
+    unsigned int indices[16];       // Palette Entry per Pixel
+    float error;                    // Summed Squared Error
+} bc1_fit_t;
+
+// Fit a BC1 color block starting from the given endpoints, refitting them to the chosen
+// indices for as long as that keeps improving (up to 'rounds' times).
+static inline void bc1_search(const float px[16][4], const unsigned char* used, int transparent, int bc3, int rounds, float* e0, float* e1, bc1_fit_t* best) {
+    for (int round = 0; round <= rounds; round++) {
+        unsigned int c0 = bc_pack565(e1), c1 = bc_pack565(e0);
+        if (transparent ? c0 > c1 : c0 < c1) {
+            unsigned int t = c0;
+            c0 = c1;
+            c1 = t;
+        }
+        int four = bc3 || c0 > c1;
+        int palette[4][4];
+        bc1_palette(c0, c1, four, palette);
+        unsigned int indices[16] = { 0 };
+        float error = bc_fit(px, used, 3, (const int(*)[4])palette, four ? 4 : 3, indices);
+        for (int i = 0; i < 16; i++) {
+            if (!used[i]) indices[i] = 3;
+        }
+        if (error < best->error) {
+            best->error = error;
+            best->c0 = c0;
+            best->c1 = c1;
+            memcpy(best->indices, indices, sizeof(indices));
+        }
+        else if (round > 0) {
+            break;
+        }
+
+        // Refit to the chosen Indices (Palette Entry -> Weight toward c1)
+        static const float weights_four[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        static const float weights_three[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            weights[i] = (four ? weights_four : weights_three)[indices[i]];
+        }
+        float r0[4] = { 0 }, r1[4] = { 0 };
+        int u0[4], u1[4];
+        bc_unpack565(c0, u0);
+        bc_unpack565(c1, u1);
+        for (int c = 0; c < 3; c++) {
+            r0[c] = (float)u0[c];
+            r1[c] = (float)u1[c];
+        }
+        if (round == rounds || !bc_refine(px, used, 3, weights, r0, r1)) {
+            break;
+        }
+        memcpy(e1, r0, sizeof(r0));
+        memcpy(e0, r1, sizeof(r1));
+    }
+}
+
+// Color half of a BC1 or BC3 block, BC1 keeps transparent pixels in the three color mode
+static inline void bc1_encode(const float px[16][4], bc_quality_t quality, int bc3, unsigned char* out) {
+    unsigned char used[16];
+    int transparent = 0;
+    for (int i = 0; i < 16; i++) {
+        used[i] = bc3 || px[i][3] >= 128.0f;
+        transparent |= !used[i];
+    }
+    bc1_fit_t best = { .error = INFINITY };
+    float e0[4], e1[4];
+    bc_endpoints(px, used, 3, quality, e0, e1);
+    bc1_search(px, used, transparent, bc3, bc_refinements(quality), e0, e1, &best);
+    if (quality == BC_QUALITY_HIGH) {
+        // The bounding box wins on some blocks (Hard Edges, Noise)
+        bc_endpoints(px, used, 3, BC_QUALITY_FAST, e0, e1);
+        bc1_search(px, used, transparent, bc3, bc_refinements(quality), e0, e1, &best);
+    }
+
+    unsigned int bits = 0;
+    for (int i = 0; i < 16; i++) {
+        bits |= best.indices[i] << (i * 2);
+    }
+    out[0] = best.c0 & 0xFF;
+    out[1] = (best.c0 >> 8) & 0xFF;
+    out[2] = best.c1 & 0xFF;
+    out[3] = (best.c1 >> 8) & 0xFF;
+    out[4] = bits & 0xFF;
+    out[5] = (bits >> 8) & 0xFF;
+    out[6] = (bits >> 16) & 0xFF;
+    out[7] = (bits >> 24) & 0xFF;
+}
+
+// Alpha half of a BC3 block, the six value mode (with exact 0 and 255) is tried too when asked for quality
+static inline void bc4_encode(const float px[16][4], bc_quality_t quality, unsigned char* out) {
+    int lo = 255, hi = 0, inner_lo = 255, inner_hi = 0;
+    for (int i = 0; i < 16; i++) {
+        int a = (int)(px[i][3] + 0.5f);
+        if (a < lo) lo = a;
+        if (a > hi) hi = a;
+        if (a > 0 && a < 255) {
+            if (a < inner_lo) inner_lo = a;
+            if (a > inner_hi) inner_hi = a;
+        }
+    }
+    int candidates[2][2] = { { hi, lo }, { inner_lo, inner_hi } };
+    int tries = quality != BC_QUALITY_FAST && inner_lo <= inner_hi ? 2 : 1;
+    unsigned long long best_bits = 0;
+    int best_a0 = hi, best_a1 = lo;
+    float best_error = INFINITY;
+    for (int t = 0; t < tries; t++) {
+        int palette[8];
+        bc4_palette(candidates[t][0], candidates[t][1], palette);
+        unsigned long long bits = 0;
+        float error = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            float best = INFINITY;
+            unsigned int index = 0;
+            for (unsigned int p = 0; p < 8; p++) {
+                float d = px[i][3] - (float)palette[p];
+                if (d * d < best) {
+                    best = d * d;
+                    index = p;
+                }
+            }
+            error += best;
+            bits |= (unsigned long long)index << (i * 3);
+        }
+        if (error < best_error) {
+            best_error = error;
+            best_bits = bits;
+            best_a0 = candidates[t][0];
+            best_a1 = candidates[t][1];
+        }
+    }
+    out[0] = (unsigned char)best_a0;
+    out[1] = (unsigned char)best_a1;
+    for (int i = 0; i < 6; i++) {
+        out[2 + i] = (best_bits >> (i * 8)) & 0xFF;
+    }
+}
+
+// Quantize an endpoint to 7 Bits per channel plus a shared lowest bit, either the given
+// one or (if negative) whichever is closest.
+static inline void bc7_quantize(const float* e, int bit, int* q, int* p) {
+    float best = INFINITY;
+    for (int b = bit < 0 ? 0 : bit; b < (bit < 0 ? 2 : bit + 1); b++) {
+        int candidate[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            candidate[c] = bc_clamp((int)((e[c] - (float)b) / 2.0f + 0.5f), 0, 127);
+            float d = (float)((candidate[c] << 1) | b) - e[c];
+            error += d * d;
+        }
+        if (error < best) {
+            best = error;
+            memcpy(q, candidate, sizeof(candidate));
+            *p = b;
+        }
+    }
+}
+
+// Append bits to a 128-Bit block, lowest first
+static inline void bc_put(unsigned char* block, unsigned int* offset, unsigned int value, unsigned int count) {
+    for (unsigned int i = 0; i < count; i++, (*offset)++) {
+        if ((value >> i) & 1) {
+            block[*offset / 8] |= (unsigned char)(1u << (*offset % 8));
+        }
+    }
+}
+
+typedef struct {
+    int q[2][4];                    // Endpoints (7 Bits per Channel)
+    int p[2];                       // Endpoint Lowest Bits
+    unsigned int indices[16];       // Palette Entry per Pixel
+    float error;                    // Summed Squared Error
+} bc7_fit_t;
+
+// Fit a BC7 mode 6 block starting from the given endpoints, every pairing of lowest bits
+// is tried when asked to be exhaustive rather than the closest one per endpoint.
+static inline void bc7_search(const float px[16][4], const unsigned char* used, int rounds, int exhaustive, float* e0, float* e1, bc7_fit_t* best) {
+    for (int round = 0; round <= rounds; round++) {
+        float round_error = INFINITY;
+        unsigned int round_indices[16] = { 0 };
+        for (int pairing = exhaustive ? 0 : -1; pairing < (exhaustive ? 4 : 0); pairing++) {
+            bc7_fit_t fit = { 0 };
+            bc7_quantize(e0, pairing < 0 ? -1 : pairing & 1, fit.q[0], &fit.p[0]);
+            bc7_quantize(e1, pairing < 0 ? -1 : pairing >> 1, fit.q[1], &fit.p[1]);
+            int palette[16][4];
+            for (int i = 0; i < 16; i++) {
+                for (int c = 0; c < 4; c++) {
+                    int a = (fit.q[0][c] << 1) | fit.p[0], b = (fit.q[1][c] << 1) | fit.p[1];
+                    palette[i][c] = ((64 - BC7_WEIGHTS[i]) * a + BC7_WEIGHTS[i] * b + 32) >> 6;
+                }
+            }
+            fit.error = bc_fit(px, used, 4, (const int(*)[4])palette, 16, fit.indices);
+            if (fit.error < round_error) {
+                round_error = fit.error;
+                memcpy(round_indices, fit.indices, sizeof(round_indices));
+            }
+            if (fit.error < best->error) {
+                *best = fit;
+            }
+        }
+        if (round > 0 && round_error > best->error) {
+            break;
+        }
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            weights[i] = (float)BC7_WEIGHTS[round_indices[i]] / 64.0f;
+        }
+        if (round == rounds || !bc_refine(px, used, 4, weights, e0, e1)) {
+            break;
+        }
+    }
+}
+
+static inline void bc7_encode(const float px[16][4], bc_quality_t quality, unsigned char* out) {
+    unsigned char used[16];
+    memset(used, 1, sizeof(used));
+    bc7_fit_t best = { .error = INFINITY };
+    float e0[4], e1[4];
+    bc_endpoints(px, used, 4, quality, e0, e1);
+    bc7_search(px, used, bc_refinements(quality), quality == BC_QUALITY_HIGH, e0, e1, &best);
+    if (quality == BC_QUALITY_HIGH) {
+        bc_endpoints(px, used, 4, BC_QUALITY_FAST, e0, e1);
+        bc7_search(px, used, bc_refinements(quality), 1, e0, e1, &best);
+    }
+
+    // The highest bit of the first index is implied zero, swap the endpoints to make it so
+    if (best.indices[0] >= 8) {
+        for (int c = 0; c < 4; c++) {
+            int t = best.q[0][c];
+            best.q[0][c] = best.q[1][c];
+            best.q[1][c] = t;
+        }
+        int t = best.p[0];
+        best.p[0] = best.p[1];
+        best.p[1] = t;
+        for (int i = 0; i < 16; i++) {
+            best.indices[i] = 15 - best.indices[i];
+        }
+    }
+    memset(out, 0, 16);
+    unsigned int offset = 0;
+    bc_put(out, &offset, 0x40, 7);
+    for (int c = 0; c < 4; c++) {
+        bc_put(out, &offset, (unsigned int)best.q[0][c], 7);
+        bc_put(out, &offset, (unsigned int)best.q[1][c], 7);
+    }
+    bc_put(out, &offset, (unsigned int)best.p[0], 1);
+    bc_put(out, &offset, (unsigned int)best.p[1], 1);
+    for (int i = 0; i < 16; i++) {
+        bc_put(out, &offset, best.indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+typedef struct {
+    const unsigned int* rgba;       // Source Pixels (0xRRGGBBAA)
+    unsigned int width;             // Source Width
+    unsigned int height;            // Source Height
+    unsigned int format;            // Block Format
+    bc_quality_t quality;           // Encoder Quality
+    unsigned char* blocks;          // Output Blocks
+    atomic_uint row;                // Next Row of Blocks to encode
+} bc_job_t;
+
+static inline void* bc_worker(void* arg) {
+    bc_job_t* job = (bc_job_t*)arg;
+    unsigned int blocks_x = (job->width + 3) / 4;
+    unsigned int blocks_y = (job->height + 3) / 4;
+    unsigned int by;
+    while ((by = atomic_fetch_add(&job->row, 1)) < blocks_y) {
+        for (unsigned int bx = 0; bx < blocks_x; bx++) {
+            float px[16][4];
+            for (unsigned int i = 0; i < 16; i++) {
+                unsigned int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x >= job->width) x = job->width - 1;
+                if (y >= job->height) y = job->height - 1;
+                unsigned int v = job->rgba[(size_t)y * job->width + x];
+                px[i][0] = (float)((v >> 24) & 0xFF);
+                px[i][1] = (float)((v >> 16) & 0xFF);
+                px[i][2] = (float)((v >> 8) & 0xFF);
+                px[i][3] = (float)(v & 0xFF);
+            }
+            unsigned char* out = job->blocks + ((size_t)by * blocks_x + bx) * bc_block_size(job->format);
+            switch (job->format) {
+            case BC_FORMAT_BC1: {
+                bc1_encode((const float(*)[4])px, job->quality, 0, out);
+                break;
+            }
+            case BC_FORMAT_BC3: {
+                bc4_encode((const float(*)[4])px, job->quality, out);
+                bc1_encode((const float(*)[4])px, job->quality, 1, out + 8);
+                break;
+            }
+            default: {
+                bc7_encode((const float(*)[4])px, job->quality, out);
+                break;
+            }
+            }
+        }
+    }
+    return NULL;
+}
+
+// Encode an image (0xRRGGBBAA) to blocks, see the layout above
+static inline bc_error_t bc_encode(
+    const unsigned int* input_rgba,     // Pixel Data (0xRRGGBBAA)
+    const unsigned int input_width,     // Array Width
+    const unsigned int input_height,    // Array Height
+    const unsigned int input_format,    // Block Format (bc_format_t)
+    const bc_quality_t input_quality,   // Encoder Quality
+    const unsigned int input_linear,    // Pixels hold Linear Values
+    unsigned char** complete_buffer,    // Output Pointer
+    unsigned int* complete_length       // Output Size
+) {
+    if (!input_rgba || !complete_buffer || !complete_length ||
+        (input_format != BC_FORMAT_BC1 && input_format != BC_FORMAT_BC3 && input_format != BC_FORMAT_BC7)) {
+        return BC_INVALID_ARGUMENTS;
+    }
+    if (input_width == 0 || input_width > BC_MAX_DIMENSION || input_height == 0 || input_height > BC_MAX_DIMENSION) {
+        return BC_INVALID_HEADER;
+    }
+    size_t length = BC_HEADER_SIZE + bc_length(input_format, input_width, input_height);
+    unsigned char* output_buffer = malloc(length);
+    if (!output_buffer) {
+        return BC_MEMORY_ERROR;
+    }
+    const unsigned int header[4] = { MAGIC_BCNX, input_format | ((input_linear ? 1u : 0u) << 8), input_width, input_height };
+    for (int f = 0; f < 4; f++) {
+        output_buffer[f * 4 + 0] = (header[f]) & 0xFF;
+        output_buffer[f * 4 + 1] = (header[f] >> 8) & 0xFF;
+        output_buffer[f * 4 + 2] = (header[f] >> 16) & 0xFF;
+        output_buffer[f * 4 + 3] = (header[f] >> 24) & 0xFF;
+    }
+
+    // Encode Blocks
+    // Helpers that fail to start just leave more rows to the calling thread
+    bc_job_t job = {
+        .rgba = input_rgba,
+        .width = input_width,
+        .height = input_height,
+        .format = input_format,
+        .quality = input_quality,
+        .blocks = output_buffer + BC_HEADER_SIZE,
+    };
+    atomic_init(&job.row, 0);
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int threads = (int)info.dwNumberOfProcessors;
+#else
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    int rows = (int)((input_height + 3) / 4);
+    threads = bc_clamp(threads < rows ? threads : rows, 1, BC_THREAD_LIMIT);
+    pthread_t helpers[BC_THREAD_LIMIT];
+    int started[BC_THREAD_LIMIT] = { 0 };
+    for (int i = 1; i < threads; i++) {
+        started[i] = pthread_create(&helpers[i], NULL, bc_worker, &job) == 0;
+    }
+    bc_worker(&job);
+    for (int i = 1; i < threads; i++) {
+        if (started[i]) {
+            pthread_join(helpers[i], NULL);
+        }
+    }
+
+    *complete_buffer = output_buffer;
+    *complete_length = (unsigned int)length;
+    return BC_OK;
+}
+
+// Peak signal to noise ratio of a decoded stream against its source (Decibels, all channels)
+static inline double bc_psnr(const unsigned int* source, const unsigned int* decoded, unsigned int width, unsigned int height) {
+    double error = 0.0;
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            double d = (double)((source[i] >> shift) & 0xFF) - (double)((decoded[i] >> shift) & 0xFF);
+            error += d * d;
+        }
+    }
+    error /= (double)count * 4.0;
+    return error > 0.0 ? 10.0 * log10(255.0 * 255.0 / error) : INFINITY;
+}
\ No newline at end of file
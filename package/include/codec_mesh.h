@@ -0,0 +1,513 @@
+#include <util_simplify.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#pragma once
+
+// Meshes are stored as flat vertex and index arrays ready to be handed to the GPU, so
+// loading one is a header check rather than a text parse. Triangles are reordered for
+// the post-transform vertex cache (Forsyth), vertices are then renumbered in the order
+// they are first used so fetches walk the vertex array front to back. Attributes are
+// quantized against the bounds of the mesh, identical vertices are merged after that.
+// Coarser levels of detail are simplified from the source and share its vertices, the
+// vertices of a level come before the ones only finer levels use.
+//
+//   uint32  Magic 'MESH'
+//   uint32  Vertex Count
+//   uint32  Index Count (All Levels, Multiple of 3)
+//   uint8   Index Size (2 or 4 Bytes)
+//   uint8   Attributes (0x01 = Texture Coordinates, 0x02 = Normals)
+//   uint8   Vertex Size (16 Bytes)
+//   uint8   Level Count (N), Level 0 is the Source
+//   float   Position Minimum (XYZ), Position Scale (XYZ)
+//   float   Texture Coordinate Minimum (UV), Texture Coordinate Scale (UV)
+//   N * { uint32 First Index, uint32 Index Count, uint32 Vertex Count, float Error }
+//   Vertices { uint16 Position XYZ, uint16 Reserved, int8 Normal XYZ, int8 Reserved, uint16 UV }
+//   Indices of Level 0 up to Level N-1
+
+static const unsigned int MAGIC_MESH = ('M') | ('E' << 8) | ('S' << 16) | ('H' << 24);
+
+#define MESH_HEADER_SIZE     56
+#define MESH_VERTEX_SIZE     16
+#define MESH_LOD_SIZE        16
+#define MESH_LOD_LIMIT       8
+#define MESH_LOD_DEFAULT     4
+#define MESH_LOD_MINIMUM     32      // Meshes with fewer than X Triangles aren't simplified further
+#define MESH_LOD_RATIO       0.5     // Triangles kept by each Level of Detail
+#define MESH_LOD_PROGRESS    0.9     // Levels keeping more than X of the previous Triangles are dropped
+#define MESH_LOD_ERROR       0.05f   // Largest Error of a Level relative to the Mesh Diagonal
+#define MESH_TABLE_SIZE(n)   (MESH_HEADER_SIZE + (n) * MESH_LOD_SIZE)
+#define MESH_CACHE_SIZE      32      // Simulated Vertex Cache Entries (Ordering)
+#define MESH_CACHE_MEASURE   16      // Simulated FIFO Cache Entries (Reported ACMR)
+#define MESH_ATTRIBUTE_UV     0x01
+#define MESH_ATTRIBUTE_NORMAL 0x02
+
+typedef enum {
+    MESH_OK = 0,
+    MESH_MEMORY_ERROR = 1,
+    MESH_INVALID_ARGUMENTS = 2,
+    MESH_UNEXPECTED_EOF = 3,
+    MESH_INVALID_HEADER = 701,
+    MESH_INVALID_INDEX = 702,
+} mesh_error_t;
+
+typedef struct {
+    float position[3];              // Position
+    float uv[2];                    // Texture Coordinate
+    float normal[3];                // Normal (Unit Length)
+} mesh_vertex_t;
+
+typedef struct {
+    unsigned int vertices;          // Vertices after Merging
+    unsigned int triangles;         // Triangles
+    double acmr_before;             // Average Cache Miss Ratio of the Source Order
+    double acmr_after;              // Average Cache Miss Ratio of the Stored Order
+    unsigned int lod_count;         // Levels of Detail
+    unsigned int lod_triangles[MESH_LOD_LIMIT]; // Triangles per Level
+    float lod_errors[MESH_LOD_LIMIT];           // Error per Level (Distance)
+} mesh_stats_t;
+
+// Apply a packager option ("--lods=4"), returns 0 if it isn't one
+static inline int mesh_option(const char* option, unsigned int* lods) {
+    if (strncmp(option, "--lods=", 7) != 0) {
+        return 0;
+    }
+    char* end;
+    long value = strtol(option + 7, &end, 10);
+    if (*end != '\0' || value < 1 || value > MESH_LOD_LIMIT) {
+        return 0;
+    }
+    *lods = (unsigned int)value;
+    return 1;
+}
+
+static inline void mesh_write_u32(unsigned char* b, unsigned int v) {
+    b[0] = (v) & 0xFF;
+    b[1] = (v >> 8) & 0xFF;
+    b[2] = (v >> 16) & 0xFF;
+    b[3] = (v >> 24) & 0xFF;
+}
+
+static inline void mesh_write_u16(unsigned char* b, unsigned int v) {
+    b[0] = (v) & 0xFF;
+    b[1] = (v >> 8) & 0xFF;
+}
+
+static inline void mesh_write_f32(unsigned char* b, float v) {
+    unsigned int bits;
+    memcpy(&bits, &v, sizeof(bits));
+    mesh_write_u32(b, bits);
+}
+
+// Vertex cache misses per triangle through a FIFO cache, 0.5 is the best possible
+// for large meshes, 3.0 means no vertex is ever reused.
+static inline double mesh_acmr(const unsigned int* indices, unsigned int index_count, unsigned int vertex_count) {
+    if (index_count < 3) {
+        return 0.0;
+    }
+    unsigned int* stamp = calloc(vertex_count ? vertex_count : 1, sizeof(unsigned int));
+    if (stamp == NULL) {
+        return 0.0;
+    }
+    // A vertex is cached while fewer than MESH_CACHE_MEASURE misses happened since it was loaded
+    unsigned int misses = 0;
+    for (unsigned int i = 0; i < index_count; i++) {
+        unsigned int v = indices[i];
+        if (stamp[v] == 0 || misses - (stamp[v] - 1) >= MESH_CACHE_MEASURE) {
+            stamp[v] = ++misses;
+        }
+    }
+    free(stamp);
+    return (double)misses / (index_count / 3);
+}
+
+// Score of a vertex for the Forsyth ordering, recently used vertices and those with
+// few triangles left are preferred.
+static inline float mesh_score(int cache_position, unsigned int remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            score = 0.75f;
+        }
+        else {
+            float scaled = 1.0f - (float)(cache_position - 3) / (MESH_CACHE_SIZE - 3);
+            score = powf(scaled, 1.5f);
+        }
+    }
+    return score + 2.0f / sqrtf((float)remaining);
+}
+
+static inline int mesh_contains(const unsigned int* list, unsigned int count, unsigned int v) {
+    for (unsigned int i = 0; i < count; i++) {
+        if (list[i] == v) return 1;
+    }
+    return 0;
+}
+
+// Reorder triangles for the post-transform vertex cache, in place
+static inline mesh_error_t mesh_optimize_cache(unsigned int* indices, unsigned int index_count, unsigned int vertex_count) {
+    unsigned int triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return MESH_OK;
+    }
+    unsigned int* offsets = calloc(vertex_count + 1, sizeof(unsigned int));
+    unsigned int* remaining = calloc(vertex_count, sizeof(unsigned int));
+    int* cache_position = malloc(vertex_count * sizeof(int));
+    float* vertex_score = malloc(vertex_count * sizeof(float));
+    unsigned int* adjacency = malloc(index_count * sizeof(unsigned int));
+    float* triangle_score = malloc(triangle_count * sizeof(float));
+    unsigned char* emitted = calloc(triangle_count, sizeof(unsigned char));
+    unsigned int* output = malloc(index_count * sizeof(unsigned int));
+    if (!offsets || !remaining || !cache_position || !vertex_score || !adjacency || !triangle_score || !emitted || !output) {
+        free(offsets); free(remaining); free(cache_position); free(vertex_score);
+        free(adjacency); free(triangle_score); free(emitted); free(output);
+        return MESH_MEMORY_ERROR;
+    }
+
+    // Triangles using each Vertex
+    for (unsigned int i = 0; i < index_count; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (unsigned int v = 0; v < vertex_count; v++) {
+        remaining[v] = offsets[v + 1];
+        offsets[v + 1] += offsets[v];
+    }
+    unsigned int* fill = calloc(vertex_count ? vertex_count : 1, sizeof(unsigned int));
+    if (fill == NULL) {
+        free(offsets); free(remaining); free(cache_position); free(vertex_score);
+        free(adjacency); free(triangle_score); free(emitted); free(output);
+        return MESH_MEMORY_ERROR;
+    }
+    for (unsigned int i = 0; i < index_count; i++) {
+        unsigned int v = indices[i];
+        adjacency[offsets[v] + fill[v]++] = i / 3;
+    }
+    free(fill);
+    for (unsigned int v = 0; v < vertex_count; v++) {
+        cache_position[v] = -1;
+        vertex_score[v] = mesh_score(-1, remaining[v]);
+    }
+    for (unsigned int t = 0; t < triangle_count; t++) {
+        triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+    }
+
+    // Emit the best scoring Triangle touching the Cache, scanning for the next
+    // unused one whenever the Cache runs dry.
+    unsigned int cache[MESH_CACHE_SIZE + 3];
+    unsigned int cache_count = 0;
+    unsigned int scan = 0;
+    unsigned int output_count = 0;
+    int best = 0;
+    while (best >= 0) {
+        unsigned int t = (unsigned int)best;
+        emitted[t] = 1;
+        for (unsigned int k = 0; k < 3; k++) {
+            output[output_count++] = indices[t * 3 + k];
+        }
+
+        // Move the Triangle to the Front of the Cache
+        unsigned int next[MESH_CACHE_SIZE + 3];
+        unsigned int next_count = 0;
+        for (unsigned int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            if (!mesh_contains(next, next_count, v)) {
+                next[next_count++] = v;
+            }
+            remaining[v]--;
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v] + 1; a++) {
+                if (adjacency[a] == t) {
+                    adjacency[a] = adjacency[offsets[v] + remaining[v]];
+                    break;
+                }
+            }
+        }
+        unsigned int front = next_count;
+        for (unsigned int c = 0; c < cache_count; c++) {
+            if (!mesh_contains(next, front, cache[c])) {
+                next[next_count++] = cache[c];
+            }
+        }
+        for (unsigned int c = 0; c < next_count; c++) {
+            cache_position[next[c]] = c < MESH_CACHE_SIZE ? (int)c : -1;
+        }
+        cache_count = next_count < MESH_CACHE_SIZE ? next_count : MESH_CACHE_SIZE;
+        memcpy(cache, next, next_count * sizeof(unsigned int));
+
+        // Rescore what the Cache touched, including Vertices that just fell out
+        best = -1;
+        float best_score = -1.0f;
+        for (unsigned int c = 0; c < next_count; c++) {
+            unsigned int v = next[c];
+            float delta = mesh_score(cache_position[v], remaining[v]) - vertex_score[v];
+            vertex_score[v] += delta;
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+                unsigned int adjacent = adjacency[a];
+                triangle_score[adjacent] += delta;
+                if (c < cache_count && triangle_score[adjacent] > best_score) {
+                    best_score = triangle_score[adjacent];
+                    best = (int)adjacent;
+                }
+            }
+        }
+        if (best < 0) {
+            while (scan < triangle_count && emitted[scan]) {
+                scan++;
+            }
+            best = scan < triangle_count ? (int)scan : -1;
+        }
+    }
+    memcpy(indices, output, index_count * sizeof(unsigned int));
+    free(offsets); free(remaining); free(cache_position); free(vertex_score);
+    free(adjacency); free(triangle_score); free(emitted); free(output);
+    return MESH_OK;
+}
+
+static inline unsigned int mesh_quantize(float v, float minimum, float scale, unsigned int limit) {
+    if (scale <= 0.0f) {
+        return 0;
+    }
+    float q = (v - minimum) / scale + 0.5f;
+    return q <= 0.0f ? 0 : (q >= (float)limit ? limit : (unsigned int)q);
+}
+
+static inline unsigned int mesh_snorm8(float v) {
+    float q = v * 127.0f;
+    int i = (int)(q < 0.0f ? q - 0.5f : q + 0.5f);
+    i = i < -127 ? -127 : (i > 127 ? 127 : i);
+    return (unsigned int)i & 0xFF;
+}
+
+// Bounds of an attribute across all vertices, 'scale' maps a 16-Bit step to the range
+static inline void mesh_bounds(const float* first, unsigned int stride, unsigned int count, unsigned int components, float* minimum, float* scale) {
+    for (unsigned int c = 0; c < components; c++) {
+        float lo = INFINITY, hi = -INFINITY;
+        for (unsigned int i = 0; i < count; i++) {
+            float v = first[(size_t)i * stride + c];
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+        minimum[c] = count ? lo : 0.0f;
+        scale[c] = count && hi > lo ? (hi - lo) / 65535.0f : 0.0f;
+    }
+}
+
+static inline unsigned int mesh_hash(const unsigned char* vertex) {
+    unsigned int h = 2166136261u;
+    for (unsigned int i = 0; i < MESH_VERTEX_SIZE; i++) {
+        h = (h ^ vertex[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Quantize, merge, simplify, reorder and store a triangle list
+static inline mesh_error_t mesh_encode(
+    const mesh_vertex_t* input_vertices,    // Vertices
+    const unsigned int input_vertex_count,  // Vertex Count
+    const unsigned int* input_indices,      // Triangle Indices
+    const unsigned int input_index_count,   // Index Count (Multiple of 3)
+    const unsigned char input_attributes,   // Attributes to Store (MESH_ATTRIBUTE_*)
+    const unsigned int input_lods,          // Levels of Detail to generate (1 = Source only)
+    unsigned char** complete_buffer,        // Output Pointer
+    unsigned int* complete_length,          // Output Size
+    mesh_stats_t* complete_stats            // Output Statistics (Optional)
+) {
+    if (!input_vertices || !input_indices || !complete_buffer || !complete_length || input_index_count % 3 != 0 ||
+        input_lods == 0 || input_lods > MESH_LOD_LIMIT) {
+        return MESH_INVALID_ARGUMENTS;
+    }
+    for (unsigned int i = 0; i < input_index_count; i++) {
+        if (input_indices[i] >= input_vertex_count) {
+            return MESH_INVALID_INDEX;
+        }
+    }
+    float position_min[3], position_scale[3], uv_min[2] = { 0 }, uv_scale[2] = { 0 };
+    const unsigned int stride = sizeof(mesh_vertex_t) / sizeof(float);
+    mesh_bounds(input_vertices[0].position, stride, input_vertex_count, 3, position_min, position_scale);
+    if (input_attributes & MESH_ATTRIBUTE_UV) {
+        mesh_bounds(input_vertices[0].uv, stride, input_vertex_count, 2, uv_min, uv_scale);
+    }
+
+    // Quantize & merge Vertices that became identical
+    size_t slots = 1;
+    while (slots < (size_t)input_vertex_count * 2) slots <<= 1;
+    unsigned char* packed = calloc(input_vertex_count ? input_vertex_count : 1, MESH_VERTEX_SIZE);
+    unsigned int* table = malloc(slots * sizeof(unsigned int));
+    unsigned int* merged = malloc((input_vertex_count ? input_vertex_count : 1) * sizeof(unsigned int));
+    unsigned int* lod_indices[MESH_LOD_LIMIT] = { 0 };
+    unsigned int lod_counts[MESH_LOD_LIMIT] = { 0 };
+    float lod_errors[MESH_LOD_LIMIT] = { 0 };
+    lod_indices[0] = malloc((input_index_count ? input_index_count : 1) * sizeof(unsigned int));
+    if (!packed || !table || !merged || !lod_indices[0]) {
+        free(packed); free(table); free(merged); free(lod_indices[0]);
+        return MESH_MEMORY_ERROR;
+    }
+    memset(table, 0xFF, slots * sizeof(unsigned int));
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < input_vertex_count; i++) {
+        const mesh_vertex_t* v = &input_vertices[i];
+        unsigned char* out = packed + (size_t)unique * MESH_VERTEX_SIZE;
+        memset(out, 0, MESH_VERTEX_SIZE);
+        for (unsigned int c = 0; c < 3; c++) {
+            mesh_write_u16(out + c * 2, mesh_quantize(v->position[c], position_min[c], position_scale[c], 65535));
+        }
+        if (input_attributes & MESH_ATTRIBUTE_NORMAL) {
+            for (unsigned int c = 0; c < 3; c++) {
+                out[8 + c] = (unsigned char)mesh_snorm8(v->normal[c]);
+            }
+        }
+        if (input_attributes & MESH_ATTRIBUTE_UV) {
+            for (unsigned int c = 0; c < 2; c++) {
+                mesh_write_u16(out + 12 + c * 2, mesh_quantize(v->uv[c], uv_min[c], uv_scale[c], 65535));
+            }
+        }
+        size_t slot = mesh_hash(out) & (slots - 1);
+        while (table[slot] != 0xFFFFFFFF && memcmp(packed + (size_t)table[slot] * MESH_VERTEX_SIZE, out, MESH_VERTEX_SIZE) != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        if (table[slot] == 0xFFFFFFFF) {
+            table[slot] = unique++;
+        }
+        merged[i] = table[slot];
+    }
+    free(table);
+    for (unsigned int i = 0; i < input_index_count; i++) {
+        lod_indices[0][i] = merged[input_indices[i]];
+    }
+    lod_counts[0] = input_index_count;
+    double acmr_before = mesh_acmr(lod_indices[0], input_index_count, unique);
+
+    // Levels of Detail, each simplified from the previous one as long as that still
+    // removes a good share of the triangles
+    float* positions = malloc((unique ? unique : 1) * 3 * sizeof(float));
+    if (positions == NULL) {
+        free(packed); free(merged); free(lod_indices[0]);
+        return MESH_MEMORY_ERROR;
+    }
+    for (unsigned int v = 0; v < unique; v++) {
+        for (unsigned int c = 0; c < 3; c++) {
+            unsigned int q = packed[(size_t)v * MESH_VERTEX_SIZE + c * 2] | (packed[(size_t)v * MESH_VERTEX_SIZE + c * 2 + 1] << 8);
+            positions[(size_t)v * 3 + c] = position_min[c] + q * position_scale[c];
+        }
+    }
+    float extent = 0.0f;
+    for (unsigned int c = 0; c < 3; c++) {
+        extent += (position_scale[c] * 65535.0f) * (position_scale[c] * 65535.0f);
+    }
+    extent = sqrtf(extent);
+    unsigned int lod_count = 1;
+    while (lod_count < input_lods && lod_counts[lod_count - 1] / 3 > MESH_LOD_MINIMUM) {
+        unsigned int previous = lod_counts[lod_count - 1];
+        unsigned int* next = malloc(previous * sizeof(unsigned int));
+        if (next == NULL) {
+            break;
+        }
+        unsigned int target = (unsigned int)(previous / 3 * MESH_LOD_RATIO) * 3;
+        float error = 0.0f;
+        unsigned int count = simplify(positions, unique, lod_indices[lod_count - 1], previous, target,
+            extent * MESH_LOD_ERROR, next, &error);
+        if (count == 0 || count > previous * MESH_LOD_PROGRESS) {
+            free(next);
+            break;
+        }
+        lod_indices[lod_count] = next;
+        lod_counts[lod_count] = count;
+        lod_errors[lod_count] = lod_errors[lod_count - 1] + error;
+        lod_count++;
+    }
+    free(positions);
+
+    // Triangle Order
+    mesh_error_t result = MESH_OK;
+    for (unsigned int l = 0; l < lod_count && result == MESH_OK; l++) {
+        result = mesh_optimize_cache(lod_indices[l], lod_counts[l], unique);
+    }
+    if (result != MESH_OK) {
+        for (unsigned int l = 0; l < lod_count; l++) free(lod_indices[l]);
+        free(packed); free(merged);
+        return result;
+    }
+
+    // Vertex Order, by first use starting from the coarsest Level. Coarser Levels only use
+    // Vertices of finer ones, so every Level draws from the start of the Vertex Array.
+    unsigned int* remap = merged;
+    memset(remap, 0xFF, (input_vertex_count ? input_vertex_count : 1) * sizeof(unsigned int));
+    unsigned int vertex_count = 0;
+    unsigned int lod_vertices[MESH_LOD_LIMIT] = { 0 };
+    unsigned int total_indices = 0;
+    for (unsigned int l = lod_count; l-- > 0;) {
+        for (unsigned int i = 0; i < lod_counts[l]; i++) {
+            if (remap[lod_indices[l][i]] == 0xFFFFFFFF) {
+                remap[lod_indices[l][i]] = vertex_count++;
+            }
+        }
+        lod_vertices[l] = vertex_count;
+        total_indices += lod_counts[l];
+    }
+    unsigned int index_size = vertex_count <= 65536 ? 2 : 4;
+    size_t length = MESH_TABLE_SIZE(lod_count) + (size_t)vertex_count * MESH_VERTEX_SIZE + (size_t)total_indices * index_size;
+    length = (length + 3) & ~(size_t)3;
+    unsigned char* output = calloc(length, 1);
+    if (output == NULL) {
+        for (unsigned int l = 0; l < lod_count; l++) free(lod_indices[l]);
+        free(packed); free(merged);
+        return MESH_MEMORY_ERROR;
+    }
+    unsigned char* vertices = output + MESH_TABLE_SIZE(lod_count);
+    unsigned char* index_data = vertices + (size_t)vertex_count * MESH_VERTEX_SIZE;
+    for (unsigned int v = 0; v < unique; v++) {
+        if (remap[v] != 0xFFFFFFFF) {
+            memcpy(vertices + (size_t)remap[v] * MESH_VERTEX_SIZE, packed + (size_t)v * MESH_VERTEX_SIZE, MESH_VERTEX_SIZE);
+        }
+    }
+    unsigned int first = 0;
+    for (unsigned int l = 0; l < lod_count; l++) {
+        unsigned char* entry = output + MESH_TABLE_SIZE(l);
+        mesh_write_u32(entry + 0, first);
+        mesh_write_u32(entry + 4, lod_counts[l]);
+        mesh_write_u32(entry + 8, lod_vertices[l]);
+        mesh_write_f32(entry + 12, lod_errors[l]);
+        for (unsigned int i = 0; i < lod_counts[l]; i++) {
+            unsigned int index = remap[lod_indices[l][i]];
+            if (index_size == 2) mesh_write_u16(index_data + (size_t)(first + i) * 2, index);
+            else                 mesh_write_u32(index_data + (size_t)(first + i) * 4, index);
+            lod_indices[l][i] = index;
+        }
+        first += lod_counts[l];
+    }
+
+    // Header
+    mesh_write_u32(output + 0, MAGIC_MESH);
+    mesh_write_u32(output + 4, vertex_count);
+    mesh_write_u32(output + 8, total_indices);
+    output[12] = (unsigned char)index_size;
+    output[13] = input_attributes & (MESH_ATTRIBUTE_UV | MESH_ATTRIBUTE_NORMAL);
+    output[14] = MESH_VERTEX_SIZE;
+    output[15] = (unsigned char)lod_count;
+    for (unsigned int c = 0; c < 3; c++) {
+        mesh_write_f32(output + 16 + c * 4, position_min[c]);
+        mesh_write_f32(output + 28 + c * 4, position_scale[c]);
+    }
+    for (unsigned int c = 0; c < 2; c++) {
+        mesh_write_f32(output + 40 + c * 4, uv_min[c]);
+        mesh_write_f32(output + 48 + c * 4, uv_scale[c]);
+    }
+    if (complete_stats) {
+        complete_stats->vertices = vertex_count;
+        complete_stats->triangles = input_index_count / 3;
+        complete_stats->acmr_before = acmr_before;
+        complete_stats->acmr_after = mesh_acmr(lod_indices[0], input_index_count, vertex_count);
+        complete_stats->lod_count = lod_count;
+        for (unsigned int l = 0; l < lod_count; l++) {
+            complete_stats->lod_triangles[l] = lod_counts[l] / 3;
+            complete_stats->lod_errors[l] = lod_errors[l];
+        }
+    }
+    for (unsigned int l = 0; l < lod_count; l++) free(lod_indices[l]);
+    free(packed); free(merged);
+    *complete_buffer = output;
+    *complete_length = (unsigned int)length;
+    return MESH_OK;
+}
\ No newline at end of file
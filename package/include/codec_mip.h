@@ -0,0 +1,252 @@
+#include <codec_qoi.h>
+#include <util_pixel.h>
+#include <util_crc32.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#pragma once
+
+// Mipmapped images store every level as an image stream (QOI or block compressed) of its
+// own behind a level table.
+// Levels are written coarsest first, so the start of the payload up to the end of any
+// level holds that level and every coarser one, each decodable on its own.
+//
+//   uint32  Magic 'MIPS'
+//   uint32  Level Count (N), Level 0 is the full resolution
+//   N * { uint32 End Offset of the Level, uint32 CRC32 of the Level }
+//   Image Streams of Level N-1 down to Level 0
+
+static const unsigned int MAGIC_MIPS = ('M') | ('I' << 8) | ('P' << 16) | ('S' << 24);
+
+#define MIP_LEVEL_LIMIT      16
+#define MIP_MINIMUM_SIZE     128     // Images smaller than X Pixels on either Side are stored as is
+#define MIP_HEADER_SIZE      8
+#define MIP_LEVEL_SIZE       8
+#define MIP_TABLE_SIZE(n)    (MIP_HEADER_SIZE + (n) * MIP_LEVEL_SIZE)
+
+typedef enum {
+    MIP_OK = 0,
+    MIP_MEMORY_ERROR = 1,
+    MIP_INVALID_ARGUMENTS = 2,
+    MIP_UNEXPECTED_EOF = 3,
+    MIP_INVALID_HEADER = 301,
+    MIP_ENCODE_ERROR = 302,
+} mip_error_t;
+
+static inline void mip_write_u32(unsigned char* b, unsigned int v) {
+    b[0] = (v) & 0xFF;
+    b[1] = (v >> 8) & 0xFF;
+    b[2] = (v >> 16) & 0xFF;
+    b[3] = (v >> 24) & 0xFF;
+}
+
+static inline unsigned int mip_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+// sRGB to Linear Light, indexed by the 8-Bit sRGB Value. Images which already
+// hold linear values are filtered as they are.
+static inline const float* mip_linear_table(unsigned int format) {
+    static float table[2][256];
+    static int ready = 0;
+    if (!ready) {
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            table[0][i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            table[1][i] = c;
+        }
+        ready = 1;
+    }
+    return table[(format & PIXEL_FORMAT_LINEAR) ? 1 : 0];
+}
+
+// Linear Light to sRGB, picks the closest entry of the table above
+static inline unsigned int mip_srgb(const float* table, float linear) {
+    int lo = 0, hi = 255;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (table[mid] < linear) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo > 0 && linear - table[lo - 1] < table[lo] - linear) {
+        lo--;
+    }
+    return (unsigned int)lo;
+}
+
+// Halve a level of premultiplied linear RGBA using a separable [1 3 3 1] tent filter.
+// Odd sizes round down, samples past the edges are clamped.
+static inline float* mip_downsample(const float* src, unsigned int width, unsigned int height, unsigned int* out_width, unsigned int* out_height) {
+    unsigned int w = width > 1 ? width / 2 : 1;
+    unsigned int h = height > 1 ? height / 2 : 1;
+    float* row = malloc((size_t)w * height * 4 * sizeof(float));
+    float* dst = malloc((size_t)w * h * 4 * sizeof(float));
+    if (!row || !dst) {
+        free(row);
+        free(dst);
+        return NULL;
+    }
+    static const float weights[4] = { 0.125f, 0.375f, 0.375f, 0.125f };
+
+    // Horizontal Pass
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < w; x++) {
+            float sum[4] = { 0 };
+            for (int t = 0; t < 4; t++) {
+                long sx = (long)x * 2 - 1 + t;
+                if (sx < 0) sx = 0;
+                if (sx >= (long)width) sx = width - 1;
+                const float* p = src + ((size_t)y * width + sx) * 4;
+                for (int c = 0; c < 4; c++) sum[c] += p[c] * weights[t];
+            }
+            memcpy(row + ((size_t)y * w + x) * 4, sum, sizeof(sum));
+        }
+    }
+
+    // Vertical Pass
+    for (unsigned int y = 0; y < h; y++) {
+        for (unsigned int x = 0; x < w; x++) {
+            float sum[4] = { 0 };
+            for (int t = 0; t < 4; t++) {
+                long sy = (long)y * 2 - 1 + t;
+                if (sy < 0) sy = 0;
+                if (sy >= (long)height) sy = height - 1;
+                const float* p = row + ((size_t)sy * w + x) * 4;
+                for (int c = 0; c < 4; c++) sum[c] += p[c] * weights[t];
+            }
+            memcpy(dst + ((size_t)y * w + x) * 4, sum, sizeof(sum));
+        }
+    }
+
+    free(row);
+    *out_width = w;
+    *out_height = h;
+    return dst;
+}
+
+// Convert RGBA (0xRRGGBBAA) to premultiplied linear light and back
+static inline float* mip_unpack(const unsigned int* rgba, unsigned int width, unsigned int height, unsigned int format) {
+    const float* table = mip_linear_table(format);
+    size_t count = (size_t)width * height;
+    float* out = malloc(count * 4 * sizeof(float));
+    if (!out) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        float a = (rgba[i] & 0xFF) / 255.0f;
+        out[i * 4 + 0] = table[(rgba[i] >> 24) & 0xFF] * a;
+        out[i * 4 + 1] = table[(rgba[i] >> 16) & 0xFF] * a;
+        out[i * 4 + 2] = table[(rgba[i] >> 8) & 0xFF] * a;
+        out[i * 4 + 3] = a;
+    }
+    return out;
+}
+
+static inline unsigned int* mip_pack(const float* linear, unsigned int width, unsigned int height, unsigned int format) {
+    const float* table = mip_linear_table(format);
+    size_t count = (size_t)width * height;
+    unsigned int* out = malloc(count * sizeof(unsigned int));
+    if (!out) {
+        return NULL;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const float* p = linear + i * 4;
+        float a = p[3] > 1.0f ? 1.0f : p[3];
+        unsigned int color = 0;
+        for (int c = 0; c < 3; c++) {
+            float v = a > 0.0f ? p[c] / a : 0.0f;
+            color |= mip_srgb(table, v) << (24 - c * 8);
+        }
+        out[i] = color | (unsigned int)(a * 255.0f + 0.5f);
+    }
+    return out;
+}
+
+// Encode an image along with its mip chain down to 1x1, see the layout above
+static inline mip_error_t mip_encode(
+    const unsigned int* input_rgba,     // Pixel Data (0xRRGGBBAA)
+    const unsigned int input_width,     // Array Width
+    const unsigned int input_height,    // Array Height
+    const unsigned int input_format,    // Layout to Store (pixel_format_t)
+    unsigned char** complete_buffer,    // Output Pointer
+    unsigned int* complete_length,      // Output Size
+    unsigned int* complete_levels,      // Output Level Count
+    double* complete_psnr               // Output Block PSNR of Level 0 (Optional)
+) {
+    if (!input_rgba || !complete_buffer || !complete_length || !complete_levels) {
+        return MIP_INVALID_ARGUMENTS;
+    }
+    unsigned char* levels[MIP_LEVEL_LIMIT] = { 0 };
+    unsigned int lengths[MIP_LEVEL_LIMIT] = { 0 };
+    unsigned int count = 0;
+    mip_error_t result = MIP_OK;
+
+    // Encode Levels
+    // Each level is filtered from the unquantized previous one so rounding doesn't accumulate
+    unsigned int width = input_width, height = input_height;
+    float* linear = mip_unpack(input_rgba, width, height, input_format);
+    if (!linear) {
+        return MIP_MEMORY_ERROR;
+    }
+    while (count < MIP_LEVEL_LIMIT) {
+        if (count == 0) {
+            if (pixel_encode(input_rgba, width, height, input_format, &levels[count], &lengths[count], complete_psnr) != QOI_OK) {
+                result = MIP_ENCODE_ERROR;
+                break;
+            }
+        }
+        else {
+            unsigned int* rgba = mip_pack(linear, width, height, input_format);
+            if (!rgba) {
+                result = MIP_MEMORY_ERROR;
+                break;
+            }
+            qoi_error_t encoded = pixel_encode(rgba, width, height, input_format, &levels[count], &lengths[count], NULL);
+            free(rgba);
+            if (encoded != QOI_OK) {
+                result = MIP_ENCODE_ERROR;
+                break;
+            }
+        }
+        count++;
+        if (width == 1 && height == 1) {
+            break;
+        }
+        float* next = mip_downsample(linear, width, height, &width, &height);
+        free(linear);
+        linear = next;
+        if (!linear) {
+            result = MIP_MEMORY_ERROR;
+            break;
+        }
+    }
+    free(linear);
+
+    // Write Table & Levels
+    size_t total = MIP_TABLE_SIZE(count);
+    for (unsigned int i = 0; i < count; i++) {
+        total += lengths[i];
+    }
+    unsigned char* output_buffer = result == MIP_OK ? malloc(total) : NULL;
+    if (result == MIP_OK && !output_buffer) {
+        result = MIP_MEMORY_ERROR;
+    }
+    if (result == MIP_OK) {
+        unsigned int output_offset = MIP_TABLE_SIZE(count);
+        mip_write_u32(output_buffer, MAGIC_MIPS);
+        mip_write_u32(output_buffer + 4, count);
+        for (unsigned int i = count; i-- > 0;) {
+            memcpy(output_buffer + output_offset, levels[i], lengths[i]);
+            output_offset += lengths[i];
+            mip_write_u32(output_buffer + MIP_TABLE_SIZE(i), output_offset);
+            mip_write_u32(output_buffer + MIP_TABLE_SIZE(i) + 4, crc32(levels[i], (int)lengths[i]));
+        }
+        *complete_buffer = output_buffer;
+        *complete_length = output_offset;
+        *complete_levels = count;
+    }
+    for (unsigned int i = 0; i < MIP_LEVEL_LIMIT; i++) {
+        free(levels[i]);
+    }
+    return result;
+}
\ No newline at end of file
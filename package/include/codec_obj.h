@@ -0,0 +1,234 @@
+#include <codec_mesh.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#pragma once
+
+// Reads the geometry of a Wavefront .obj file into a triangle list. Positions ('v'),
+// texture coordinates ('vt'), normals ('vn') and faces ('f') are used, polygons are
+// split into fans and every distinct position/coordinate/normal triple becomes one
+// vertex. Everything else (objects, groups, materials) is ignored.
+
+#define OBJ_LINE_LIMIT       4096
+
+typedef enum {
+    OBJ_OK = 0,
+    OBJ_MEMORY_ERROR = 1,
+    OBJ_INVALID_ARGUMENTS = 2,
+    OBJ_UNEXPECTED_EOF = 3,
+    OBJ_INVALID_STATEMENT = 601,
+    OBJ_INVALID_INDEX = 602,
+    OBJ_LINE_TOO_LONG = 603,
+} obj_error_t;
+
+typedef struct {
+    float* data;                    // Values
+    unsigned int count;             // Elements
+    unsigned int capacity;          // Element Capacity
+} obj_list_t;
+
+static inline int obj_push(obj_list_t* list, const float* values, unsigned int components) {
+    if (list->count == list->capacity) {
+        unsigned int capacity = list->capacity ? list->capacity * 2 : 256;
+        float* grown = realloc(list->data, (size_t)capacity * components * sizeof(float));
+        if (grown == NULL) {
+            return 0;
+        }
+        list->data = grown;
+        list->capacity = capacity;
+    }
+    memcpy(list->data + (size_t)list->count * components, values, components * sizeof(float));
+    list->count++;
+    return 1;
+}
+
+// Resolve a (possibly negative, relative) index against the elements read so far
+static inline int obj_index(long value, unsigned int count, unsigned int* out) {
+    long index = value < 0 ? (long)count + value : value - 1;
+    if (value == 0 || index < 0 || index >= (long)count) {
+        return 0;
+    }
+    *out = (unsigned int)index;
+    return 1;
+}
+
+static inline obj_error_t obj_decode(
+    const unsigned char* input_buffer,  // Encoded Buffer
+    const unsigned int input_length,    // Encoded Buffer Length
+    mesh_vertex_t** mesh_vertices,      // Vertices
+    unsigned int* mesh_vertex_count,    // Vertex Count
+    unsigned int** mesh_indices,        // Triangle Indices
+    unsigned int* mesh_index_count,     // Index Count
+    unsigned char* mesh_attributes      // Attributes present (MESH_ATTRIBUTE_*)
+) {
+    if (!input_buffer || !mesh_vertices || !mesh_vertex_count || !mesh_indices || !mesh_index_count || !mesh_attributes) {
+        return OBJ_INVALID_ARGUMENTS;
+    }
+    obj_list_t positions = { 0 }, uvs = { 0 }, normals = { 0 };
+    mesh_vertex_t* vertices = NULL;
+    unsigned int* keys = NULL;
+    unsigned int* indices = NULL;
+    unsigned int vertex_count = 0, vertex_capacity = 0;
+    unsigned int index_count = 0, index_capacity = 0;
+    unsigned int* table = NULL;
+    size_t slots = 0;
+    unsigned char attributes = MESH_ATTRIBUTE_UV | MESH_ATTRIBUTE_NORMAL;
+    obj_error_t result = OBJ_OK;
+    char line[OBJ_LINE_LIMIT];
+
+    for (unsigned int offset = 0; offset < input_length && result == OBJ_OK;) {
+        // Copy Line
+        unsigned int end = offset;
+        while (end < input_length && input_buffer[end] != '\n') end++;
+        if (end - offset >= sizeof(line)) {
+            result = OBJ_LINE_TOO_LONG;
+            break;
+        }
+        memcpy(line, input_buffer + offset, end - offset);
+        line[end - offset] = '\0';
+        offset = end + 1;
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char* cursor = line;
+        while (*cursor == ' ' || *cursor == '\t') cursor++;
+        if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t' || cursor[1] == 't' || cursor[1] == 'n')) {
+            // Vertex Attributes
+            unsigned int components = cursor[1] == 't' ? 2 : 3;
+            obj_list_t* list = cursor[1] == 't' ? &uvs : (cursor[1] == 'n' ? &normals : &positions);
+            cursor += cursor[1] == 't' || cursor[1] == 'n' ? 2 : 1;
+            float values[3] = { 0 };
+            for (unsigned int c = 0; c < components; c++) {
+                char* after;
+                values[c] = strtof(cursor, &after);
+                if (after == cursor) {
+                    // A texture coordinate may leave out 'v'
+                    if (components == 2 && c == 1) break;
+                    result = OBJ_INVALID_STATEMENT;
+                    break;
+                }
+                cursor = after;
+            }
+            if (result == OBJ_OK && !obj_push(list, values, components)) {
+                result = OBJ_MEMORY_ERROR;
+            }
+        }
+        else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+            // Face, split into a Fan around its first Corner
+            cursor += 1;
+            unsigned int corners = 0, first = 0, previous = 0;
+            for (;;) {
+                while (*cursor == ' ' || *cursor == '\t' || *cursor == '\r') cursor++;
+                if (*cursor == '\0') break;
+                char* after;
+                unsigned int key[3] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+                if (!obj_index(strtol(cursor, &after, 10), positions.count, &key[0]) || after == cursor) {
+                    result = OBJ_INVALID_INDEX;
+                    break;
+                }
+                cursor = after;
+                for (unsigned int k = 1; k < 3 && *cursor == '/'; k++) {
+                    cursor++;
+                    if (*cursor == '/' || *cursor == ' ' || *cursor == '\t' || *cursor == '\0' || *cursor == '\r') continue;
+                    if (!obj_index(strtol(cursor, &after, 10), k == 1 ? uvs.count : normals.count, &key[k]) || after == cursor) {
+                        result = OBJ_INVALID_INDEX;
+                        break;
+                    }
+                    cursor = after;
+                }
+                if (result != OBJ_OK) break;
+                if (key[1] == 0xFFFFFFFF) attributes &= ~MESH_ATTRIBUTE_UV;
+                if (key[2] == 0xFFFFFFFF) attributes &= ~MESH_ATTRIBUTE_NORMAL;
+
+                // Find or add the Vertex
+                if (vertex_count * 2 >= slots) {
+                    size_t grown_slots = slots ? slots * 2 : 1024;
+                    unsigned int* grown = malloc(grown_slots * sizeof(unsigned int));
+                    if (grown == NULL) {
+                        result = OBJ_MEMORY_ERROR;
+                        break;
+                    }
+                    memset(grown, 0xFF, grown_slots * sizeof(unsigned int));
+                    for (unsigned int v = 0; v < vertex_count; v++) {
+                        size_t slot = ((keys[v * 3] * 73856093u) ^ (keys[v * 3 + 1] * 19349663u) ^ (keys[v * 3 + 2] * 83492791u)) & (grown_slots - 1);
+                        while (grown[slot] != 0xFFFFFFFF) slot = (slot + 1) & (grown_slots - 1);
+                        grown[slot] = v;
+                    }
+                    free(table);
+                    table = grown;
+                    slots = grown_slots;
+                }
+                size_t slot = ((key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u)) & (slots - 1);
+                while (table[slot] != 0xFFFFFFFF && memcmp(&keys[table[slot] * 3], key, sizeof(key)) != 0) {
+                    slot = (slot + 1) & (slots - 1);
+                }
+                if (table[slot] == 0xFFFFFFFF) {
+                    if (vertex_count == vertex_capacity) {
+                        vertex_capacity = vertex_capacity ? vertex_capacity * 2 : 256;
+                        mesh_vertex_t* grown = realloc(vertices, vertex_capacity * sizeof(mesh_vertex_t));
+                        unsigned int* grown_keys = realloc(keys, vertex_capacity * 3 * sizeof(unsigned int));
+                        if (grown) vertices = grown;
+                        if (grown_keys) keys = grown_keys;
+                        if (!grown || !grown_keys) {
+                            result = OBJ_MEMORY_ERROR;
+                            break;
+                        }
+                    }
+                    mesh_vertex_t* v = &vertices[vertex_count];
+                    memset(v, 0, sizeof(mesh_vertex_t));
+                    memcpy(v->position, positions.data + (size_t)key[0] * 3, sizeof(v->position));
+                    if (key[1] != 0xFFFFFFFF) memcpy(v->uv, uvs.data + (size_t)key[1] * 2, sizeof(v->uv));
+                    if (key[2] != 0xFFFFFFFF) {
+                        const float* n = normals.data + (size_t)key[2] * 3;
+                        float length = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                        for (unsigned int c = 0; c < 3 && length > 0.0f; c++) v->normal[c] = n[c] / length;
+                    }
+                    memcpy(&keys[vertex_count * 3], key, sizeof(key));
+                    table[slot] = vertex_count++;
+                }
+                unsigned int vertex = table[slot];
+
+                // Emit Triangle
+                if (corners == 0) first = vertex;
+                if (corners >= 2) {
+                    if (index_count + 3 > index_capacity) {
+                        index_capacity = index_capacity ? index_capacity * 2 : 768;
+                        unsigned int* grown = realloc(indices, index_capacity * sizeof(unsigned int));
+                        if (grown == NULL) {
+                            result = OBJ_MEMORY_ERROR;
+                            break;
+                        }
+                        indices = grown;
+                    }
+                    indices[index_count++] = first;
+                    indices[index_count++] = previous;
+                    indices[index_count++] = vertex;
+                }
+                previous = vertex;
+                corners++;
+            }
+            if (result == OBJ_OK && corners < 3) {
+                result = OBJ_INVALID_STATEMENT;
+            }
+        }
+    }
+    free(positions.data);
+    free(uvs.data);
+    free(normals.data);
+    free(keys);
+    free(table);
+    if (result == OBJ_OK && index_count == 0) {
+        result = OBJ_UNEXPECTED_EOF;
+    }
+    if (result != OBJ_OK) {
+        free(vertices);
+        free(indices);
+        return result;
+    }
+    *mesh_vertices = vertices;
+    *mesh_vertex_count = vertex_count;
+    *mesh_indices = indices;
+    *mesh_index_count = index_count;
+    *mesh_attributes = attributes;
+    return OBJ_OK;
+}
\ No newline at end of file
@@ -47,10 +47,10 @@ static inline qoi_error_t qoi_encode(
     unsigned int input_offset = 0;
 
     // Initialize Encoder
-    // We naively assume that everything will into this buffer, if it doesn't then we'll just simply die! :3
+    // Sized for the worst case, every pixel taking an RGBA opcode (5 Bytes)
     // This function *really* shouldn't be called during gameplay...
     unsigned int output_offset = 0;
-    unsigned char* output_buffer = malloc(QOI_MINIMUM_SIZE + (input_width * input_height * 2));
+    unsigned char* output_buffer = malloc(QOI_MINIMUM_SIZE + ((size_t)input_width * input_height * 5));
     if (!output_buffer) {
         return QOI_MEMORY_ERROR;
     }
@@ -160,6 +160,11 @@ static inline qoi_error_t qoi_encode(
             pre = cur;
         }
     }
+    if (run) {
+        // Image ended mid-run, flush current run...
+        unsigned char run_byte = QOI_OP_RUN | (run - 1);
+        output_buffer[output_offset++] = run_byte;
+    }
 
     // Write Footer
     output_buffer[output_offset++] = 0x00;
@@ -0,0 +1,644 @@
+#include <util_yuri.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#pragma once
+
+// Scenes are written as XML and compiled into flat records the engine uses in place,
+// so loading one is a single read and a range check instead of a parse.
+//
+//   <scene>
+//     <entity name="bear">
+//       <transform position="0 0 -5" scale="2"/>
+//       <renderer model="/models/bear" image="/textures/bear" visible="true"/>
+//       <entity name="hat"> ... </entity>
+//     </entity>
+//   </scene>
+//
+// Entities nest, every other element within an entity is one of its components and
+// every attribute of a component is a property. A property named after an asset type
+// ('image', 'model', ...) refers to that asset and is resolved to its archive index,
+// 'true' and 'false' are booleans, one to four numbers are floats and anything else
+// is kept as a string.
+//
+//   uint32  Magic 'SCNE'
+//   uint32  Entity Count
+//   uint32  Component Count
+//   uint32  Reference Count
+//   uint32  Property Bytes
+//   uint32  String Bytes
+//   References { uint32 Asset Index, uint32 Asset Type }
+//   Entities { uint32 Name, uint32 Parent, uint32 First Component, uint32 Component Count }
+//   Components { uint32 Type, uint32 Property Offset, uint32 Property Bytes, uint32 Property Count }
+//   Properties { uint32 Name, uint8 Kind, uint8 Value Count, uint16 Reserved, uint32 Values[] }
+//   Strings (NUL Terminated, Offset 0 is the empty String)
+
+static const unsigned int MAGIC_SCNE = ('S') | ('C' << 8) | ('N' << 16) | ('E' << 24);
+
+#define SCENE_HEADER_SIZE    24
+#define SCENE_REFERENCE_SIZE 8
+#define SCENE_ENTITY_SIZE    16
+#define SCENE_COMPONENT_SIZE 16
+#define SCENE_PROPERTY_SIZE  8
+#define SCENE_NONE           0xFFFFFFFF  // Parent of Entities at the Top of the Scene
+#define SCENE_DEPTH_LIMIT    64          // Entities nested deeper than X are rejected
+#define SCENE_NAME_LIMIT     256
+#define SCENE_VALUE_LIMIT    4096
+
+typedef enum {
+    SCENE_OK = 0,
+    SCENE_MEMORY_ERROR = 1,
+    SCENE_INVALID_ARGUMENTS = 2,
+    SCENE_UNEXPECTED_EOF = 3,
+    SCENE_INVALID_HEADER = 801,
+    SCENE_INVALID_RECORD = 802,
+    SCENE_INVALID_SYNTAX = 803,
+    SCENE_INVALID_ELEMENT = 804,
+    SCENE_MISSING_ASSET = 805,
+} scene_error_t;
+
+typedef enum {
+    SCENE_PROPERTY_FLOAT = 1u,      // 1 to 4 Floats
+    SCENE_PROPERTY_BOOL = 2u,       // 0 or 1
+    SCENE_PROPERTY_STRING = 3u,     // String Offset
+    SCENE_PROPERTY_REFERENCE = 4u,  // Reference Index
+} scene_property_kind_t;
+
+typedef struct {
+    const char* name;               // Property Name
+    unsigned char type;             // Asset Type
+} scene_reference_name_t;
+
+static const scene_reference_name_t SCENE_REFERENCE_NAMES[] = {
+    { "embedded", YURI_TYPE_EMBEDDED },
+    { "shader-v", YURI_TYPE_SHADER_VERTEX },
+    { "shader-f", YURI_TYPE_SHADER_FRAGMENT },
+    { "image",    YURI_TYPE_IMAGE },
+    { "audio",    YURI_TYPE_AUDIO },
+    { "model",    YURI_TYPE_MODEL },
+    { "scene",    YURI_TYPE_SCENE },
+    { "script",   YURI_TYPE_SCRIPT },
+    { "sprite",   YURI_TYPE_SPRITE },
+};
+
+typedef struct {
+    unsigned int entities;          // Entities
+    unsigned int components;        // Components
+    unsigned int references;        // Distinct Assets referred to
+    unsigned int line;              // Line the Error was found on (Failures only)
+} scene_stats_t;
+
+typedef struct {
+    unsigned char* data;            // Bytes
+    unsigned int size;              // Bytes used
+    unsigned int capacity;          // Bytes allocated
+} scene_buffer_t;
+
+typedef struct {
+    unsigned int entity;            // Owning Entity
+    unsigned int type;              // Type (String Offset)
+    unsigned int offset;            // Property Offset
+    unsigned int size;              // Property Bytes
+    unsigned int count;             // Property Count
+} scene_component_t;
+
+typedef struct {
+    const unsigned char* input;     // XML Source
+    unsigned int length;            // XML Source Length
+    unsigned int offset;            // Read Position
+    scene_buffer_t strings;         // String Table
+    unsigned int* string_table;     // String Lookup (Offset + 1, 0 = Empty)
+    unsigned int string_slots;      // String Lookup Capacity
+    unsigned int string_count;      // Strings in the Table
+    scene_buffer_t entities;        // Entity Records
+    scene_buffer_t properties;      // Property Records
+    scene_buffer_t references;      // Reference Records
+    scene_component_t* components;  // Components in Document Order
+    unsigned int component_count;   // Components
+    unsigned int component_capacity; // Component Capacity
+} scene_writer_t;
+
+static inline void scene_write_u32(unsigned char* b, unsigned int v) {
+    b[0] = (v) & 0xFF;
+    b[1] = (v >> 8) & 0xFF;
+    b[2] = (v >> 16) & 0xFF;
+    b[3] = (v >> 24) & 0xFF;
+}
+
+static inline unsigned int scene_read_u32(const unsigned char* b) {
+    return (unsigned int)b[0] | ((unsigned int)b[1] << 8) | ((unsigned int)b[2] << 16) | ((unsigned int)b[3] << 24);
+}
+
+static inline int scene_append(scene_buffer_t* b, const void* data, unsigned int size) {
+    if (b->size + size > b->capacity) {
+        unsigned int capacity = b->capacity ? b->capacity : 256;
+        while (b->size + size > capacity) capacity *= 2;
+        unsigned char* grown = realloc(b->data, capacity);
+        if (grown == NULL) {
+            return 0;
+        }
+        b->data = grown;
+        b->capacity = capacity;
+    }
+    memcpy(b->data + b->size, data, size);
+    b->size += size;
+    return 1;
+}
+
+static inline int scene_append_u32(scene_buffer_t* b, unsigned int v) {
+    unsigned char bytes[4];
+    scene_write_u32(bytes, v);
+    return scene_append(b, bytes, sizeof(bytes));
+}
+
+static inline unsigned int scene_string_hash(const char* s) {
+    unsigned int h = 2166136261u;
+    while (*s) h = (h ^ (unsigned char)*s++) * 16777619u;
+    return h;
+}
+
+// Offset of a string within the table, added if it isn't there yet
+static inline scene_error_t scene_intern(scene_writer_t* w, const char* string, unsigned int* offset) {
+    if (string[0] == '\0') {
+        *offset = 0;
+        return SCENE_OK;
+    }
+    if ((w->string_count + 1) * 2 > w->string_slots) {
+        unsigned int slots = w->string_slots ? w->string_slots * 2 : 256;
+        unsigned int* grown = calloc(slots, sizeof(unsigned int));
+        if (grown == NULL) {
+            return SCENE_MEMORY_ERROR;
+        }
+        for (unsigned int i = 0; i < w->string_slots; i++) {
+            if (w->string_table[i] == 0) continue;
+            unsigned int slot = scene_string_hash((const char*)w->strings.data + w->string_table[i] - 1) & (slots - 1);
+            while (grown[slot] != 0) slot = (slot + 1) & (slots - 1);
+            grown[slot] = w->string_table[i];
+        }
+        free(w->string_table);
+        w->string_table = grown;
+        w->string_slots = slots;
+    }
+    unsigned int slot = scene_string_hash(string) & (w->string_slots - 1);
+    while (w->string_table[slot] != 0) {
+        if (strcmp((const char*)w->strings.data + w->string_table[slot] - 1, string) == 0) {
+            *offset = w->string_table[slot] - 1;
+            return SCENE_OK;
+        }
+        slot = (slot + 1) & (w->string_slots - 1);
+    }
+    *offset = w->strings.size;
+    if (!scene_append(&w->strings, string, (unsigned int)strlen(string) + 1)) {
+        return SCENE_MEMORY_ERROR;
+    }
+    w->string_table[slot] = *offset + 1;
+    w->string_count++;
+    return SCENE_OK;
+}
+
+static inline int scene_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline int scene_name_char(unsigned char c, int first) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || c >= 0x80 ||
+        (!first && ((c >= '0' && c <= '9') || c == '-' || c == '.'));
+}
+
+static inline void scene_skip_space(scene_writer_t* w) {
+    while (w->offset < w->length && scene_space(w->input[w->offset])) w->offset++;
+}
+
+// Skip past the next occurrence of 'terminator'
+static inline scene_error_t scene_skip_past(scene_writer_t* w, const char* terminator) {
+    size_t length = strlen(terminator);
+    for (; w->offset + length <= w->length; w->offset++) {
+        if (memcmp(w->input + w->offset, terminator, length) == 0) {
+            w->offset += (unsigned int)length;
+            return SCENE_OK;
+        }
+    }
+    return SCENE_UNEXPECTED_EOF;
+}
+
+static inline scene_error_t scene_read_name(scene_writer_t* w, char* out) {
+    unsigned int length = 0;
+    while (w->offset < w->length && scene_name_char(w->input[w->offset], length == 0)) {
+        if (length + 1 >= SCENE_NAME_LIMIT) {
+            return SCENE_INVALID_SYNTAX;
+        }
+        out[length++] = (char)w->input[w->offset++];
+    }
+    out[length] = '\0';
+    return length > 0 ? SCENE_OK : (w->offset < w->length ? SCENE_INVALID_SYNTAX : SCENE_UNEXPECTED_EOF);
+}
+
+// Read a quoted attribute value, replacing character and entity references
+static inline scene_error_t scene_read_value(scene_writer_t* w, char* out) {
+    if (w->offset >= w->length) {
+        return SCENE_UNEXPECTED_EOF;
+    }
+    unsigned char quote = w->input[w->offset++];
+    if (quote != '"' && quote != '\'') {
+        return SCENE_INVALID_SYNTAX;
+    }
+    unsigned int length = 0;
+    for (;;) {
+        if (w->offset >= w->length) {
+            return SCENE_UNEXPECTED_EOF;
+        }
+        unsigned char c = w->input[w->offset++];
+        if (c == quote) break;
+        if (c == '<') {
+            return SCENE_INVALID_SYNTAX;
+        }
+        unsigned char encoded[4] = { c };
+        unsigned int encoded_length = 1;
+        if (c == '&') {
+            unsigned int end = w->offset;
+            while (end < w->length && end - w->offset < 12 && w->input[end] != ';') end++;
+            if (end >= w->length || w->input[end] != ';') {
+                return SCENE_INVALID_SYNTAX;
+            }
+            const char* entity = (const char*)w->input + w->offset;
+            unsigned int entity_length = end - w->offset;
+            unsigned long code = 0;
+            if (entity_length == 2 && !memcmp(entity, "lt", 2))        code = '<';
+            else if (entity_length == 2 && !memcmp(entity, "gt", 2))   code = '>';
+            else if (entity_length == 3 && !memcmp(entity, "amp", 3))  code = '&';
+            else if (entity_length == 4 && !memcmp(entity, "quot", 4)) code = '"';
+            else if (entity_length == 4 && !memcmp(entity, "apos", 4)) code = '\'';
+            else if (entity_length >= 2 && entity[0] == '#') {
+                char digits[16];
+                memcpy(digits, entity + 1, entity_length - 1);
+                digits[entity_length - 1] = '\0';
+                char* after;
+                code = digits[0] == 'x' ? strtoul(digits + 1, &after, 16) : strtoul(digits, &after, 10);
+                if (*after != '\0' || after == digits || code == 0 || code > 0x10FFFF) {
+                    return SCENE_INVALID_SYNTAX;
+                }
+            }
+            else {
+                return SCENE_INVALID_SYNTAX;
+            }
+            w->offset = end + 1;
+
+            // UTF-8
+            if (code < 0x80) {
+                encoded[0] = (unsigned char)code;
+            }
+            else if (code < 0x800) {
+                encoded[0] = (unsigned char)(0xC0 | (code >> 6));
+                encoded[1] = (unsigned char)(0x80 | (code & 0x3F));
+                encoded_length = 2;
+            }
+            else if (code < 0x10000) {
+                encoded[0] = (unsigned char)(0xE0 | (code >> 12));
+                encoded[1] = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+                encoded[2] = (unsigned char)(0x80 | (code & 0x3F));
+                encoded_length = 3;
+            }
+            else {
+                encoded[0] = (unsigned char)(0xF0 | (code >> 18));
+                encoded[1] = (unsigned char)(0x80 | ((code >> 12) & 0x3F));
+                encoded[2] = (unsigned char)(0x80 | ((code >> 6) & 0x3F));
+                encoded[3] = (unsigned char)(0x80 | (code & 0x3F));
+                encoded_length = 4;
+            }
+        }
+        if (length + encoded_length >= SCENE_VALUE_LIMIT) {
+            return SCENE_INVALID_SYNTAX;
+        }
+        memcpy(out + length, encoded, encoded_length);
+        length += encoded_length;
+    }
+    out[length] = '\0';
+    return SCENE_OK;
+}
+
+// Read 'name="value"' of the next attribute, 'name' is empty once the tag ends
+static inline scene_error_t scene_read_attribute(scene_writer_t* w, char* name, char* value, int* closed) {
+    scene_skip_space(w);
+    name[0] = '\0';
+    if (w->offset >= w->length) {
+        return SCENE_UNEXPECTED_EOF;
+    }
+    if (w->input[w->offset] == '>') {
+        w->offset++;
+        *closed = 0;
+        return SCENE_OK;
+    }
+    if (w->input[w->offset] == '/') {
+        if (w->offset + 1 >= w->length || w->input[w->offset + 1] != '>') {
+            return SCENE_INVALID_SYNTAX;
+        }
+        w->offset += 2;
+        *closed = 1;
+        return SCENE_OK;
+    }
+    scene_error_t result = scene_read_name(w, name);
+    if (result != SCENE_OK) {
+        return result;
+    }
+    scene_skip_space(w);
+    if (w->offset >= w->length || w->input[w->offset] != '=') {
+        return w->offset >= w->length ? SCENE_UNEXPECTED_EOF : SCENE_INVALID_SYNTAX;
+    }
+    w->offset++;
+    scene_skip_space(w);
+    return scene_read_value(w, value);
+}
+
+// Append a property to the component being read
+static inline scene_error_t scene_property(scene_writer_t* w, scene_component_t* component, const char* name, const char* value, const yuri_asset_t* asset_list, unsigned int asset_count) {
+    unsigned int name_offset = 0;
+    scene_error_t result = scene_intern(w, name, &name_offset);
+    if (result != SCENE_OK) {
+        return result;
+    }
+
+    // Each attribute only once
+    for (unsigned int offset = component->offset; offset < w->properties.size;) {
+        const unsigned char* p = w->properties.data + offset;
+        if (scene_read_u32(p) == name_offset) {
+            return SCENE_INVALID_ELEMENT;
+        }
+        offset += SCENE_PROPERTY_SIZE + p[5] * 4u;
+    }
+
+    unsigned char kind = SCENE_PROPERTY_STRING;
+    unsigned int values[4] = { 0 };
+    unsigned int count = 1;
+    for (unsigned int i = 0; i < sizeof(SCENE_REFERENCE_NAMES) / sizeof(SCENE_REFERENCE_NAMES[0]); i++) {
+        if (strcmp(name, SCENE_REFERENCE_NAMES[i].name) != 0) continue;
+
+        // Asset Reference, resolved to its Archive Index
+        unsigned char type = SCENE_REFERENCE_NAMES[i].type;
+        unsigned int index = 0;
+        while (index < asset_count && (asset_list[index].type != type || strcmp(asset_list[index].name, value) != 0)) index++;
+        if (index == asset_count) {
+            return SCENE_MISSING_ASSET;
+        }
+        unsigned int reference = 0;
+        unsigned int reference_count = w->references.size / SCENE_REFERENCE_SIZE;
+        while (reference < reference_count && scene_read_u32(w->references.data + reference * SCENE_REFERENCE_SIZE) != index) {
+            reference++;
+        }
+        if (reference == reference_count && (!scene_append_u32(&w->references, index) || !scene_append_u32(&w->references, type))) {
+            return SCENE_MEMORY_ERROR;
+        }
+        kind = SCENE_PROPERTY_REFERENCE;
+        values[0] = reference;
+        break;
+    }
+    if (kind == SCENE_PROPERTY_STRING && (!strcmp(value, "true") || !strcmp(value, "false"))) {
+        kind = SCENE_PROPERTY_BOOL;
+        values[0] = value[0] == 't';
+    }
+    if (kind == SCENE_PROPERTY_STRING) {
+        // Numbers, all of them or none
+        const char* cursor = value;
+        unsigned int numbers = 0;
+        for (;;) {
+            while (scene_space((unsigned char)*cursor)) cursor++;
+            if (*cursor == '\0') break;
+            char* after;
+            float number = strtof(cursor, &after);
+            if (after == cursor || !isfinite(number) || (*after != '\0' && !scene_space((unsigned char)*after))) {
+                numbers = 0;
+                break;
+            }
+            if (numbers == 4) {
+                return SCENE_INVALID_ELEMENT;
+            }
+            memcpy(&values[numbers++], &number, sizeof(number));
+            cursor = after;
+        }
+        if (numbers > 0) {
+            kind = SCENE_PROPERTY_FLOAT;
+            count = numbers;
+        }
+    }
+    if (kind == SCENE_PROPERTY_STRING && (result = scene_intern(w, value, &values[0])) != SCENE_OK) {
+        return result;
+    }
+
+    unsigned char record[SCENE_PROPERTY_SIZE + 16] = { 0 };
+    scene_write_u32(record, name_offset);
+    record[4] = kind;
+    record[5] = (unsigned char)count;
+    for (unsigned int i = 0; i < count; i++) {
+        scene_write_u32(record + SCENE_PROPERTY_SIZE + i * 4, values[i]);
+    }
+    if (!scene_append(&w->properties, record, SCENE_PROPERTY_SIZE + count * 4)) {
+        return SCENE_MEMORY_ERROR;
+    }
+    component->size += SCENE_PROPERTY_SIZE + count * 4;
+    component->count++;
+    return SCENE_OK;
+}
+
+// Read the elements of the document
+static inline scene_error_t scene_parse(scene_writer_t* w, const yuri_asset_t* asset_list, unsigned int asset_count) {
+    static char name[SCENE_NAME_LIMIT];
+    static char attribute[SCENE_NAME_LIMIT];
+    static char value[SCENE_VALUE_LIMIT];
+    static char component_name[SCENE_NAME_LIMIT];
+    unsigned int stack[SCENE_DEPTH_LIMIT + 2];   // Entity of every open Element (SCENE_NONE for the Scene)
+    unsigned int depth = 0;
+    int in_component = 0, root_done = 0;
+    scene_error_t result = SCENE_OK;
+
+    for (;;) {
+        // Text between Elements
+        while (w->offset < w->length && w->input[w->offset] != '<') {
+            if (!scene_space(w->input[w->offset])) {
+                return depth > 0 ? SCENE_INVALID_ELEMENT : SCENE_INVALID_SYNTAX;
+            }
+            w->offset++;
+        }
+        if (w->offset >= w->length) {
+            return root_done ? SCENE_OK : SCENE_UNEXPECTED_EOF;
+        }
+        const unsigned char* tag = w->input + w->offset;
+        unsigned int left = w->length - w->offset;
+
+        // Declarations & Comments
+        if (left >= 2 && tag[1] == '?') {
+            if ((result = scene_skip_past(w, "?>")) != SCENE_OK) return result;
+            continue;
+        }
+        if (left >= 4 && !memcmp(tag, "<!--", 4)) {
+            w->offset += 4;
+            if ((result = scene_skip_past(w, "-->")) != SCENE_OK) return result;
+            continue;
+        }
+        if (left >= 2 && tag[1] == '!') {
+            return SCENE_INVALID_SYNTAX;
+        }
+
+        // End Tag
+        if (left >= 2 && tag[1] == '/') {
+            w->offset += 2;
+            if ((result = scene_read_name(w, name)) != SCENE_OK) return result;
+            scene_skip_space(w);
+            if (w->offset >= w->length) return SCENE_UNEXPECTED_EOF;
+            if (w->input[w->offset++] != '>' || depth == 0) return SCENE_INVALID_SYNTAX;
+            const char* expect = in_component ? component_name : (depth == 1 ? "scene" : "entity");
+            if (strcmp(name, expect) != 0) return SCENE_INVALID_SYNTAX;
+            if (in_component) in_component = 0;
+            else depth--;
+            root_done = depth == 0;
+            continue;
+        }
+
+        // Start Tag
+        w->offset++;
+        if ((result = scene_read_name(w, name)) != SCENE_OK) return result;
+        int closed = 0;
+        if (in_component) {
+            return SCENE_INVALID_ELEMENT;
+        }
+        if (depth == 0) {
+            // Scene, there is only one and it has no Attributes
+            if (root_done || strcmp(name, "scene") != 0) return SCENE_INVALID_ELEMENT;
+            if ((result = scene_read_attribute(w, attribute, value, &closed)) != SCENE_OK) return result;
+            if (attribute[0] != '\0') return SCENE_INVALID_ELEMENT;
+            stack[depth++] = SCENE_NONE;
+            if (closed) {
+                depth--;
+                root_done = 1;
+            }
+        }
+        else if (strcmp(name, "entity") == 0) {
+            // Entity, a child of the Entity around it
+            if (depth > SCENE_DEPTH_LIMIT) return SCENE_INVALID_ELEMENT;
+            unsigned int entity = w->entities.size / SCENE_ENTITY_SIZE;
+            unsigned int entity_name = 0;
+            int named = 0;
+            for (;;) {
+                if ((result = scene_read_attribute(w, attribute, value, &closed)) != SCENE_OK) return result;
+                if (attribute[0] == '\0') break;
+                if (strcmp(attribute, "name") != 0 || named) return SCENE_INVALID_ELEMENT;
+                if ((result = scene_intern(w, value, &entity_name)) != SCENE_OK) return result;
+                named = 1;
+            }
+            unsigned char record[SCENE_ENTITY_SIZE] = { 0 };
+            scene_write_u32(record + 0, entity_name);
+            scene_write_u32(record + 4, stack[depth - 1]);
+            if (!scene_append(&w->entities, record, sizeof(record))) return SCENE_MEMORY_ERROR;
+            if (!closed) stack[depth++] = entity;
+        }
+        else {
+            // Component of the Entity around it
+            if (stack[depth - 1] == SCENE_NONE) return SCENE_INVALID_ELEMENT;
+            if (w->component_count == w->component_capacity) {
+                unsigned int capacity = w->component_capacity ? w->component_capacity * 2 : 64;
+                scene_component_t* grown = realloc(w->components, capacity * sizeof(scene_component_t));
+                if (grown == NULL) return SCENE_MEMORY_ERROR;
+                w->components = grown;
+                w->component_capacity = capacity;
+            }
+            scene_component_t* component = &w->components[w->component_count++];
+            *component = (scene_component_t) { .entity = stack[depth - 1], .offset = w->properties.size };
+            if ((result = scene_intern(w, name, &component->type)) != SCENE_OK) return result;
+            for (;;) {
+                if ((result = scene_read_attribute(w, attribute, value, &closed)) != SCENE_OK) return result;
+                if (attribute[0] == '\0') break;
+                if ((result = scene_property(w, component, attribute, value, asset_list, asset_count)) != SCENE_OK) return result;
+            }
+            if (!closed) {
+                in_component = 1;
+                strcpy(component_name, name);
+            }
+        }
+    }
+}
+
+static inline scene_error_t scene_encode(
+    const unsigned char* input_buffer,  // XML Source
+    const unsigned int input_length,    // XML Source Length
+    const yuri_asset_t* asset_list,     // Archive Entries, References resolve to their Index
+    const unsigned int asset_count,     // Archive Entry Count
+    unsigned char** output_buffer,      // Encoded Buffer
+    unsigned int* output_length,        // Encoded Buffer Length
+    scene_stats_t* complete_stats       // Counts (optional)
+) {
+    if (!input_buffer || !asset_list || !output_buffer || !output_length) {
+        return SCENE_INVALID_ARGUMENTS;
+    }
+    scene_writer_t w = { .input = input_buffer, .length = input_length };
+    scene_error_t result = scene_append(&w.strings, "", 1) ? scene_parse(&w, asset_list, asset_count) : SCENE_MEMORY_ERROR;
+
+    unsigned int entity_count = w.entities.size / SCENE_ENTITY_SIZE;
+    unsigned int reference_count = w.references.size / SCENE_REFERENCE_SIZE;
+    unsigned int string_bytes = (w.strings.size + 3) & ~3u;
+    unsigned char* output = NULL;
+    unsigned int* firsts = NULL;
+    size_t length = SCENE_HEADER_SIZE + (size_t)reference_count * SCENE_REFERENCE_SIZE + (size_t)entity_count * SCENE_ENTITY_SIZE +
+        (size_t)w.component_count * SCENE_COMPONENT_SIZE + w.properties.size + string_bytes;
+    if (result == SCENE_OK && length > 0xFFFFFFFF) {
+        result = SCENE_MEMORY_ERROR;
+    }
+    if (result == SCENE_OK && ((output = calloc(length, 1)) == NULL || (firsts = calloc(entity_count + 1, sizeof(unsigned int))) == NULL)) {
+        result = SCENE_MEMORY_ERROR;
+    }
+    if (result == SCENE_OK) {
+        scene_write_u32(output + 0, MAGIC_SCNE);
+        scene_write_u32(output + 4, entity_count);
+        scene_write_u32(output + 8, w.component_count);
+        scene_write_u32(output + 12, reference_count);
+        scene_write_u32(output + 16, w.properties.size);
+        scene_write_u32(output + 20, string_bytes);
+        unsigned char* references = output + SCENE_HEADER_SIZE;
+        unsigned char* entities = references + (size_t)reference_count * SCENE_REFERENCE_SIZE;
+        unsigned char* components = entities + (size_t)entity_count * SCENE_ENTITY_SIZE;
+        unsigned char* properties = components + (size_t)w.component_count * SCENE_COMPONENT_SIZE;
+        if (w.references.size) memcpy(references, w.references.data, w.references.size);
+        if (w.entities.size) memcpy(entities, w.entities.data, w.entities.size);
+        if (w.properties.size) memcpy(properties, w.properties.data, w.properties.size);
+        memcpy(properties + w.properties.size, w.strings.data, w.strings.size);
+
+        // Components are grouped by Entity, in the Order they were written
+        for (unsigned int c = 0; c < w.component_count; c++) {
+            firsts[w.components[c].entity + 1]++;
+        }
+        for (unsigned int e = 0; e < entity_count; e++) {
+            scene_write_u32(entities + (size_t)e * SCENE_ENTITY_SIZE + 8, firsts[e]);
+            scene_write_u32(entities + (size_t)e * SCENE_ENTITY_SIZE + 12, firsts[e + 1]);
+            firsts[e + 1] += firsts[e];
+        }
+        for (unsigned int c = 0; c < w.component_count; c++) {
+            const scene_component_t* component = &w.components[c];
+            unsigned char* record = components + (size_t)firsts[component->entity]++ * SCENE_COMPONENT_SIZE;
+            scene_write_u32(record + 0, component->type);
+            scene_write_u32(record + 4, component->offset);
+            scene_write_u32(record + 8, component->size);
+            scene_write_u32(record + 12, component->count);
+        }
+    }
+    free(firsts);
+
+    if (complete_stats) {
+        complete_stats->entities = entity_count;
+        complete_stats->components = w.component_count;
+        complete_stats->references = reference_count;
+        complete_stats->line = 1;
+        for (unsigned int i = 0; i < w.offset && i < input_length; i++) {
+            complete_stats->line += input_buffer[i] == '\n';
+        }
+    }
+    free(w.strings.data);
+    free(w.string_table);
+    free(w.entities.data);
+    free(w.properties.data);
+    free(w.references.data);
+    free(w.components);
+    if (result != SCENE_OK) {
+        free(output);
+        return result;
+    }
+    *output_buffer = output;
+    *output_length = (unsigned int)length;
+    return SCENE_OK;
+}
\ No newline at end of file
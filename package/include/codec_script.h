@@ -0,0 +1,96 @@
+#include <lua.h>
+#include <lauxlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#pragma once
+
+// Compiles Lua scripts to bytecode ahead of time, so the engine loads each one with a
+// single undump instead of lexing and parsing it on boot. Stripped bytecode also
+// drops line numbers and local names, which makes it smaller but leaves errors
+// without a location. Bytecode only loads into the Lua version it was made with.
+
+#define SCRIPT_MODE_SOURCE   0       // Copy the Source
+#define SCRIPT_MODE_BYTECODE 1       // Compile, keeping Debug Information
+#define SCRIPT_MODE_STRIPPED 2       // Compile without Debug Information
+#define SCRIPT_MESSAGE_LIMIT 512
+
+typedef enum {
+    SCRIPT_OK = 0,
+    SCRIPT_MEMORY_ERROR = 1,
+    SCRIPT_INVALID_ARGUMENTS = 2,
+    SCRIPT_SYNTAX_ERROR = 901,
+} script_error_t;
+
+typedef struct {
+    unsigned char* data;            // Bytecode
+    size_t size;                    // Bytes used
+    size_t capacity;                // Bytes allocated
+} script_buffer_t;
+
+// Apply a packager option ("--scripts=stripped"), returns 0 if it isn't one
+static inline int script_option(const char* option, unsigned int* mode) {
+    if (!strcmp(option, "--scripts=source"))            *mode = SCRIPT_MODE_SOURCE;
+    else if (!strcmp(option, "--scripts=bytecode"))     *mode = SCRIPT_MODE_BYTECODE;
+    else if (!strcmp(option, "--scripts=stripped"))     *mode = SCRIPT_MODE_STRIPPED;
+    else return 0;
+    return 1;
+}
+
+static inline int script_write(lua_State* L, const void* p, size_t size, void* ud) {
+    (void)L;
+    script_buffer_t* b = ud;
+    if (b->size + size > b->capacity) {
+        size_t capacity = b->capacity ? b->capacity : 4096;
+        while (b->size + size > capacity) capacity *= 2;
+        unsigned char* grown = realloc(b->data, capacity);
+        if (grown == NULL) {
+            return 1;
+        }
+        b->data = grown;
+        b->capacity = capacity;
+    }
+    memcpy(b->data + b->size, p, size);
+    b->size += size;
+    return 0;
+}
+
+static inline script_error_t script_encode(
+    const unsigned char* input_buffer,  // Lua Source
+    const unsigned int input_length,    // Lua Source Length
+    const char* input_name,             // Asset Name, shown in Error Messages and Tracebacks
+    const unsigned int input_mode,      // SCRIPT_MODE_BYTECODE or SCRIPT_MODE_STRIPPED
+    unsigned char** output_buffer,      // Bytecode
+    unsigned int* output_length,        // Bytecode Length
+    char* error_message                 // Compiler Message on Failure (SCRIPT_MESSAGE_LIMIT Bytes)
+) {
+    if (!input_buffer || !input_name || !output_buffer || !output_length || !error_message) {
+        return SCRIPT_INVALID_ARGUMENTS;
+    }
+    error_message[0] = '\0';
+    lua_State* L = luaL_newstate();
+    if (L == NULL) {
+        return SCRIPT_MEMORY_ERROR;
+    }
+
+    // Compile only, the chunk is never run
+    char chunk_name[SCRIPT_MESSAGE_LIMIT];
+    snprintf(chunk_name, sizeof(chunk_name), "@%s", input_name);
+    int status = luaL_loadbufferx(L, (const char*)input_buffer, input_length, chunk_name, "t");
+    if (status != LUA_OK) {
+        const char* message = lua_tostring(L, -1);
+        snprintf(error_message, SCRIPT_MESSAGE_LIMIT, "%s", message ? message : "Unknown Error");
+        lua_close(L);
+        return status == LUA_ERRMEM ? SCRIPT_MEMORY_ERROR : SCRIPT_SYNTAX_ERROR;
+    }
+    script_buffer_t bytecode = { 0 };
+    status = lua_dump(L, script_write, &bytecode, input_mode == SCRIPT_MODE_STRIPPED);
+    lua_close(L);
+    if (status != 0 || bytecode.size > 0xFFFFFFFF) {
+        free(bytecode.data);
+        return SCRIPT_MEMORY_ERROR;
+    }
+    *output_buffer = bytecode.data;
+    *output_length = (unsigned int)bytecode.size;
+    return SCRIPT_OK;
+}
\ No newline at end of file
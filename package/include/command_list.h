@@ -77,7 +77,7 @@ int command_list(const char* source_file) {
         unsigned short len = read_u16(f);
 
 
-        if (a->type == 0 || a->type > YURI_TYPE_SCRIPT) {
+        if (a->type == 0 || a->type > YURI_TYPE_SPRITE) {
             printf("%03d : Unknown Asset Type (%d)\n", i, a->type);
             return 1;
         }
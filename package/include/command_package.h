@@ -3,6 +3,12 @@
 #include <codec_bmp.h>
 #include <codec_wav.h>
 #include <codec_qoi.h>
+#include <codec_mip.h>
+#include <codec_obj.h>
+#include <codec_scene.h>
+#include <codec_script.h>
+#include <util_pixel.h>
+#include <util_atlas.h>
 
 #include <codec_qoa.h>
 #include <sys/stat.h>
@@ -17,7 +23,160 @@ static inline int str_suffix(const char* string, const char* suffix) {
     return strcmp(string + string_length - suffix_length, suffix) == 0;
 }
 
-int command_package(const char* source_dir, const char* write_path) {
+// Asset Name from its Directory and Filename (Remove Extension)
+static inline char* package_name(const char* directory, const char* file) {
+    static char filename[YURI_NAME_LIMIT];
+    static char path[YURI_NAME_LIMIT];
+    strncpy(filename, file, sizeof(filename));
+    filename[sizeof(filename) - 1] = '\0';
+    char* dot = strchr(filename, '.');
+    if (dot) {
+        *dot = '\0';
+    }
+    int length = snprintf(path, sizeof(path), "/%s/%s", directory, filename);
+    if (length < 0 || (size_t)length >= sizeof(path)) {
+        printf("Asset Name too long: /%s/%s\n", directory, filename);
+        return NULL;
+    }
+    char* name = strdup(path);
+    if (name == NULL) {
+        printf("Cannot Copy String: %s\n", strerror(errno));
+    }
+    return name;
+}
+
+static inline void package_print(const yuri_asset_t* a, int number) {
+    printf(
+        "%03d : '%-30s' %8s . 0x%08X . 0x%02X . %8.2fKB\n",
+        number, a->name, str_type(a->type), a->hash, a->flag, a->size / 1024.00
+    );
+}
+
+// Checksum a processed asset and add it to the list
+static inline void package_append(yuri_asset_t* a, int* asset_count) {
+    a->hash = crc32(a->data, a->size);
+    (*asset_count)++;
+    package_print(a, *asset_count);
+}
+
+// Compile the scenes of the list once every other asset is in it, so references to
+// assets in any directory resolve to their index in the archive.
+static inline int package_scenes(yuri_asset_t* asset_list, int asset_count) {
+    for (int i = 0; i < asset_count; i++) {
+        yuri_asset_t* a = &asset_list[i];
+        if (a->type != YURI_TYPE_SCENE) continue;
+        scene_stats_t stats = { 0 };
+        unsigned char* data = NULL;
+        unsigned int size = 0;
+        unsigned int result = scene_encode(a->data, a->size, asset_list, asset_count, &data, &size, &stats);
+        if (result != SCENE_OK) {
+            printf("Unable to encode Scene '%s' (%d) on Line %u\n", a->name, result, stats.line);
+            return 1;
+        }
+        free(a->data);
+        a->data = data;
+        a->size = size;
+        a->hash = crc32(a->data, a->size);
+        package_print(a, i + 1);
+        printf("      > %u Entities, %u Components, %u References\n", stats.entities, stats.components, stats.references);
+    }
+    return 0;
+}
+
+// Pack the sprites of a directory into pages, adding an image for every page followed
+// by an entry for each of its sprites that records the page and its rectangle on it.
+static inline int package_atlas(const char* directory, atlas_sprite_t* sprites, unsigned int sprite_count, unsigned int format, yuri_asset_t* asset_list, int* asset_count) {
+    atlas_page_t* pages = NULL;
+    unsigned int page_count = 0;
+    unsigned int result = atlas_pack(sprites, sprite_count, &pages, &page_count);
+    if (result != ATLAS_OK) {
+        printf("Unable to pack Atlas '%s' (%d)\n", directory, result);
+        return 1;
+    }
+    for (unsigned int p = 0; p < page_count; p++) {
+        unsigned int page_width = pages[p].width;
+        unsigned int page_height = pages[p].height;
+        unsigned int members = 0;
+        for (unsigned int i = 0; i < sprite_count; i++) {
+            members += sprites[i].page == p;
+        }
+        if (*asset_count + 1 + (int)members > YURI_LIST_LIMIT) {
+            printf("Cannot package more than %d Assets\n", YURI_LIST_LIMIT);
+            free(pages);
+            return 1;
+        }
+
+        // Draw Page, space between sprites stays transparent
+        unsigned int* rgba = calloc((size_t)page_width * page_height, sizeof(unsigned int));
+        if (rgba == NULL) {
+            printf("Malloc Error: %s", strerror(errno));
+            free(pages);
+            return 1;
+        }
+        for (unsigned int i = 0; i < sprite_count; i++) {
+            atlas_sprite_t* sprite = &sprites[i];
+            if (sprite->page != p) continue;
+            for (unsigned int y = 0; y < sprite->height; y++) {
+                memcpy(rgba + (size_t)(sprite->y + y) * page_width + sprite->x,
+                    sprite->rgba + (size_t)y * sprite->width, sprite->width * sizeof(unsigned int));
+            }
+        }
+
+        // Page Image
+        static char page_file[32];
+        snprintf(page_file, sizeof(page_file), "atlas_%02d", p);
+        yuri_asset_t* page = &asset_list[*asset_count];
+        page->type = YURI_TYPE_IMAGE;
+        // Pages stay uncompressed, sprites are read from their pixels
+        page->flag = pixel_flags(format & ~PIXEL_FORMAT_BLOCKS);
+        result = pixel_encode(rgba, page_width, page_height, format & ~PIXEL_FORMAT_BLOCKS, &page->data, &page->size, NULL);
+        free(rgba);
+        if (result != QOI_OK) {
+            printf("Unable to encode QOI Image (%d)\n", result);
+            free(pages);
+            return 1;
+        }
+        if ((page->name = package_name(directory, page_file)) == NULL) {
+            free(pages);
+            return 1;
+        }
+        package_append(page, asset_count);
+
+        // Sprite Entries, placed right after their page so they're read along with it
+        unsigned int page_name_length = (unsigned int)strlen(page->name);
+        for (unsigned int i = 0; i < sprite_count; i++) {
+            atlas_sprite_t* sprite = &sprites[i];
+            if (sprite->page != p) continue;
+            yuri_asset_t* a = &asset_list[*asset_count];
+            a->type = YURI_TYPE_SPRITE;
+            a->flag = 0;
+            a->name = sprite->name;
+            a->size = ATLAS_ENTRY_SIZE + page_name_length;
+            a->data = malloc(a->size);
+            if (a->data == NULL) {
+                printf("Malloc Error: %s", strerror(errno));
+                free(pages);
+                return 1;
+            }
+            const unsigned int fields[6] = { sprite->x, sprite->y, sprite->width, sprite->height, page_width, page_height };
+            for (unsigned int f = 0; f < 6; f++) {
+                a->data[f * 4 + 0] = (fields[f]) & 0xFF;
+                a->data[f * 4 + 1] = (fields[f] >> 8) & 0xFF;
+                a->data[f * 4 + 2] = (fields[f] >> 16) & 0xFF;
+                a->data[f * 4 + 3] = (fields[f] >> 24) & 0xFF;
+            }
+            a->data[24] = (page_name_length) & 0xFF;
+            a->data[25] = (page_name_length >> 8) & 0xFF;
+            memcpy(a->data + ATLAS_ENTRY_SIZE, page->name, page_name_length);
+            sprite->name = NULL;
+            package_append(a, asset_count);
+        }
+    }
+    free(pages);
+    return 0;
+}
+
+int command_package(const char* source_dir, const char* write_path, unsigned int format, unsigned int lods, unsigned int scripts) {
     static yuri_asset_t asset_list[YURI_LIST_LIMIT];
     static int asset_count = 0;
     static char path_base[YURI_NAME_LIMIT];  // Base Directory
@@ -49,6 +208,17 @@ int command_package(const char* source_dir, const char* write_path) {
         }
         if (!S_ISDIR(top_info.st_mode)) continue;
 
+        // Small images of an atlas directory ("name.atlas") are packed into shared pages
+        static char directory[YURI_NAME_LIMIT];
+        int atlas = str_suffix(top_entry->d_name, ".atlas");
+        strncpy(directory, top_entry->d_name, sizeof(directory));
+        directory[sizeof(directory) - 1] = '\0';
+        if (atlas) {
+            directory[strlen(directory) - strlen(".atlas")] = '\0';
+        }
+        atlas_sprite_t* sprites = NULL;
+        unsigned int sprite_count = 0;
+
         // Scan Source Subdirectory
         DIR* sub_dir = opendir(path_base);
         struct dirent* sub_entry;
@@ -60,7 +230,11 @@ int command_package(const char* source_dir, const char* write_path) {
         while ((sub_entry = readdir(sub_dir)) != NULL) {
 
             // Sanity Checks
-            snprintf(path_file, sizeof(path_file), "%s/%s", path_base, sub_entry->d_name);
+            int length = snprintf(path_file, sizeof(path_file), "%s/%s", path_base, sub_entry->d_name);
+            if (length < 0 || (size_t)length >= sizeof(path_file)) {
+                printf("Path too long: %s/%s\n", path_base, sub_entry->d_name);
+                return 1;
+            }
             if (stat(path_file, &sub_info) != 0) {
                 printf("Cannot Stat Entry: %s\n", strerror(errno));
                 return 1;
@@ -96,14 +270,47 @@ int command_package(const char* source_dir, const char* write_path) {
             fread(file_data, file_length, 1, file_input);
             fclose(file_input);
 
+            // Collect Sprite
+            if (atlas && a->type == YURI_TYPE_IMAGE) {
+                unsigned int result = 0, height = 0, width = 0;
+                unsigned int* rgba = NULL;
+                result = bmp_decode(file_data, file_length, &rgba, &width, &height);
+                if (result != BMP_OK) {
+                    printf("Unable to decode BMP File (%d)\n", result);
+                    return 1;
+                }
+                if (width <= ATLAS_SPRITE_LIMIT && height <= ATLAS_SPRITE_LIMIT) {
+                    atlas_sprite_t* grown = realloc(sprites, (sprite_count + 1) * sizeof(atlas_sprite_t));
+                    if (grown == NULL) {
+                        printf("Malloc Error: %s", strerror(errno));
+                        return 1;
+                    }
+                    sprites = grown;
+                    sprites[sprite_count] = (atlas_sprite_t) { .rgba = rgba, .width = width, .height = height };
+                    if ((sprites[sprite_count++].name = package_name(directory, sub_entry->d_name)) == NULL) {
+                        return 1;
+                    }
+                    free(file_data);
+                    a->type = 0;
+                    continue;
+                }
+                // Too large to share a page, stored on its own
+                free(rgba);
+            }
+
+            // Copy Filename
+            if ((a->name = package_name(directory, sub_entry->d_name)) == NULL) {
+                return 1;
+            }
+
             // Process Asset
+            double psnr = -1.0;
+            mesh_stats_t mesh = { 0 };
             switch (a->type) {
             case YURI_TYPE_EMBEDDED:
             case YURI_TYPE_SHADER_VERTEX:
             case YURI_TYPE_SHADER_FRAGMENT:
-            case YURI_TYPE_SCENE:
-            case YURI_TYPE_SCRIPT:
-            case YURI_TYPE_MODEL:
+            case YURI_TYPE_SCENE:       // Compiled once all Assets are known
             case YURI_TYPE_AUDIO_ENCODED:
             case YURI_TYPE_IMAGE_ENCODED: {
                 // No Encoding
@@ -111,6 +318,22 @@ int command_package(const char* source_dir, const char* write_path) {
                 a->data = file_data;
                 break;
             }
+            case YURI_TYPE_SCRIPT: {
+                if (scripts == SCRIPT_MODE_SOURCE) {
+                    a->size = file_length;
+                    a->data = file_data;
+                    break;
+                }
+                static char message[SCRIPT_MESSAGE_LIMIT];
+                unsigned int result = script_encode(file_data, file_length, a->name, scripts, &a->data, &a->size, message);
+                if (result != SCRIPT_OK) {
+                    printf("Unable to compile Lua Script (%d) %s\n", result, message);
+                    return 1;
+                }
+                free(file_data);
+                a->flag |= YURI_FLAG_BYTECODE;
+                break;
+            }
             case YURI_TYPE_IMAGE: {
                 unsigned int result = 0, height = 0, width = 0;
                 unsigned int* rgba = NULL;
@@ -122,15 +345,50 @@ int command_package(const char* source_dir, const char* write_path) {
                 }
                 free(file_data);
 
-                result = qoi_encode(rgba, width, height, &a->data, &a->size);
-                if (result != QOA_OK) {
-                    printf("Unable to encode QOI Audio (%d)\n", result);
-                    return 1;
+                // Large images get a mip chain, so distant ones can be loaded at a fraction of the cost
+                if (width >= MIP_MINIMUM_SIZE && height >= MIP_MINIMUM_SIZE) {
+                    unsigned int levels = 0;
+                    result = mip_encode(rgba, width, height, format, &a->data, &a->size, &levels, &psnr);
+                    if (result != MIP_OK) {
+                        printf("Unable to encode Mipmapped Image (%d)\n", result);
+                        return 1;
+                    }
+                    a->flag |= YURI_FLAG_MIPMAPPED;
                 }
+                else {
+                    result = pixel_encode(rgba, width, height, format, &a->data, &a->size, &psnr);
+                    if (result != QOI_OK) {
+                        printf("Unable to encode QOI Image (%d)\n", result);
+                        return 1;
+                    }
+                }
+                a->flag |= pixel_flags(format);
                 free(rgba);
 
                 break;
             }
+            case YURI_TYPE_MODEL: {
+                unsigned int result = 0, vertex_count = 0, index_count = 0;
+                unsigned char attributes = 0;
+                mesh_vertex_t* vertices = NULL;
+                unsigned int* indices = NULL;
+
+                result = obj_decode(file_data, file_length, &vertices, &vertex_count, &indices, &index_count, &attributes);
+                if (result != OBJ_OK) {
+                    printf("Unable to decode OBJ File (%d)\n", result);
+                    return 1;
+                }
+                free(file_data);
+
+                result = mesh_encode(vertices, vertex_count, indices, index_count, attributes, lods, &a->data, &a->size, &mesh);
+                if (result != MESH_OK) {
+                    printf("Unable to encode Mesh (%d)\n", result);
+                    return 1;
+                }
+                free(vertices);
+                free(indices);
+                break;
+            }
             case YURI_TYPE_AUDIO: {
                 unsigned int result = 0, channels = 0, rate = 0, samples = 0;
                 signed short* pcm = NULL;
@@ -154,29 +412,34 @@ int command_package(const char* source_dir, const char* write_path) {
             if (a->type == YURI_TYPE_AUDIO_ENCODED) a->type = YURI_TYPE_AUDIO;
             if (a->type == YURI_TYPE_IMAGE_ENCODED) a->type = YURI_TYPE_IMAGE;
 
-            // Copy Filename (Remove Extension)
-            static char filename[YURI_NAME_LIMIT];
-            strncpy(filename, sub_entry->d_name, sizeof(filename));
-            filename[sizeof(filename) - 1] = '\0';
-            char* dot = strchr(filename, '.');
-            if (dot) {
-                *dot = '\0';
-            }
-            snprintf(path_file, sizeof(path_file), "/%s/%s", top_entry->d_name, filename);
-            a->name = strdup(path_file);
-            if (a->name == NULL) {
-                printf("Cannot Copy String: %s\n", strerror(errno));
-                return 1;
+            if (a->type == YURI_TYPE_SCENE) {
+                asset_count++;
+                continue;
+            }
+            package_append(a, &asset_count);
+            if (psnr >= 0.0) {
+                printf("      > Block Compressed, %.2fdB PSNR\n", psnr);
+            }
+            if (mesh.triangles > 0) {
+                printf("      > %u Vertices, %u Triangles, ACMR %.3f -> %.3f\n",
+                    mesh.vertices, mesh.triangles, mesh.acmr_before, mesh.acmr_after);
+                for (unsigned int l = 1; l < mesh.lod_count; l++) {
+                    printf("      > LOD %u, %u Triangles, Error %g\n", l, mesh.lod_triangles[l], mesh.lod_errors[l]);
+                }
             }
+        }
 
-            // Process Checksum
-            a->hash = crc32(a->data, a->size);
-            asset_count++;
-            printf(
-                "%03d : '%-30s' %8s . 0x%08X . 0x%02X . %8.2fKB\n",
-                asset_count, a->name, str_type(a->type), a->hash, a->flag, a->size / 1024.00
-            );
+        // Pack Sprites
+        if (sprite_count > 0 && package_atlas(directory, sprites, sprite_count, format, asset_list, &asset_count) != 0) {
+            return 1;
+        }
+        for (unsigned int i = 0; i < sprite_count; i++) {
+            free(sprites[i].rgba);
         }
+        free(sprites);
+    }
+    if (package_scenes(asset_list, asset_count) != 0) {
+        return 1;
     }
 
     // Write Header
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <string.h>
+#pragma once
+
+// Packs small images into shared pages using a skyline bottom-left packer. Images are
+// placed tallest first, each at the lowest free spot along the top edge of what was
+// placed so far, opening a new page once none of the open ones has room left.
+
+#define ATLAS_PAGE_SIZE      1024    // Largest Page Width & Height (Pixels)
+#define ATLAS_SPRITE_LIMIT   256     // Images larger than X Pixels on either Side are stored on their own
+#define ATLAS_PADDING        1       // Empty Pixels between Sprites
+#define ATLAS_ENTRY_SIZE     26      // Sprite Entry Size without the Page Name
+
+typedef enum {
+    ATLAS_OK = 0,
+    ATLAS_MEMORY_ERROR = 1,
+    ATLAS_INVALID_ARGUMENTS = 2,
+    ATLAS_SPRITE_TOO_LARGE = 401,
+} atlas_error_t;
+
+typedef struct {
+    char* name;                     // Sprite Name
+    unsigned int* rgba;             // Sprite Pixels (0xRRGGBBAA)
+    unsigned int width;             // Sprite Width
+    unsigned int height;            // Sprite Height
+    unsigned int page;              // (Packed) Page Index
+    unsigned int x;                 // (Packed) Page Position X
+    unsigned int y;                 // (Packed) Page Position Y
+} atlas_sprite_t;
+
+typedef struct {
+    unsigned int x;                 // Segment Start
+    unsigned int width;             // Segment Width
+    unsigned int y;                 // Height of the Skyline along the Segment
+} atlas_segment_t;
+
+typedef struct {
+    atlas_segment_t segments[ATLAS_PAGE_SIZE + ATLAS_PADDING];
+    unsigned int count;             // Skyline Segments
+    unsigned int width;             // Used Width (Pixels)
+    unsigned int height;            // Used Height (Pixels)
+} atlas_page_t;
+
+static inline int atlas_compare(const void* a, const void* b) {
+    const atlas_sprite_t* x = (const atlas_sprite_t*)a;
+    const atlas_sprite_t* y = (const atlas_sprite_t*)b;
+    if (x->height != y->height) {
+        return x->height < y->height ? 1 : -1;
+    }
+    if (x->width != y->width) {
+        return x->width < y->width ? 1 : -1;
+    }
+    return strcmp(x->name, y->name);
+}
+
+// Lowest position a rectangle fits at when its left edge starts at the given segment,
+// returns -1 if it would stick out of the page.
+static inline int atlas_fit(const atlas_page_t* p, unsigned int index, unsigned int w, unsigned int h) {
+    const unsigned int limit = ATLAS_PAGE_SIZE + ATLAS_PADDING;
+    if (p->segments[index].x + w > limit) {
+        return -1;
+    }
+    unsigned int y = 0;
+    unsigned int remaining = w;
+    for (unsigned int i = index; remaining > 0; i++) {
+        if (i == p->count) {
+            return -1;
+        }
+        if (p->segments[i].y > y) {
+            y = p->segments[i].y;
+        }
+        if (y + h > limit) {
+            return -1;
+        }
+        remaining -= p->segments[i].width < remaining ? p->segments[i].width : remaining;
+    }
+    return (int)y;
+}
+
+// Raise the skyline over a placed rectangle
+static inline void atlas_place(atlas_page_t* p, unsigned int index, unsigned int y, unsigned int w, unsigned int h) {
+    atlas_segment_t placed = { .x = p->segments[index].x, .width = w, .y = y + h };
+    memmove(&p->segments[index + 1], &p->segments[index], (p->count - index) * sizeof(atlas_segment_t));
+    p->segments[index] = placed;
+    p->count++;
+
+    // Trim Segments now underneath it
+    unsigned int end = placed.x + placed.width;
+    unsigned int i = index + 1;
+    while (i < p->count && p->segments[i].x < end) {
+        atlas_segment_t* s = &p->segments[i];
+        unsigned int overlap = end - s->x;
+        if (s->width > overlap) {
+            s->x += overlap;
+            s->width -= overlap;
+            break;
+        }
+        memmove(&p->segments[i], &p->segments[i + 1], (p->count - i - 1) * sizeof(atlas_segment_t));
+        p->count--;
+    }
+
+    // Merge Segments of equal Height
+    for (i = 0; i + 1 < p->count;) {
+        if (p->segments[i].y == p->segments[i + 1].y) {
+            p->segments[i].width += p->segments[i + 1].width;
+            memmove(&p->segments[i + 1], &p->segments[i + 2], (p->count - i - 2) * sizeof(atlas_segment_t));
+            p->count--;
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+// Assign every sprite a page and position, sprites are reordered (tallest first).
+// The used size of every page is returned in 'page_list', free it once done.
+static inline atlas_error_t atlas_pack(
+    atlas_sprite_t* sprites,        // Sprites to Pack
+    const unsigned int count,       // Sprite Count
+    atlas_page_t** page_list,       // Output Pages
+    unsigned int* page_count        // Output Page Count
+) {
+    if (!sprites || !page_list || !page_count) {
+        return ATLAS_INVALID_ARGUMENTS;
+    }
+    qsort(sprites, count, sizeof(atlas_sprite_t), atlas_compare);
+    atlas_page_t* pages = NULL;
+    unsigned int pages_used = 0;
+
+    for (unsigned int s = 0; s < count; s++) {
+        atlas_sprite_t* sprite = &sprites[s];
+        unsigned int w = sprite->width + ATLAS_PADDING;
+        unsigned int h = sprite->height + ATLAS_PADDING;
+        if (sprite->width == 0 || sprite->height == 0 || w > ATLAS_PAGE_SIZE + ATLAS_PADDING || h > ATLAS_PAGE_SIZE + ATLAS_PADDING) {
+            free(pages);
+            return ATLAS_SPRITE_TOO_LARGE;
+        }
+
+        // Find the lowest (then leftmost) Spot across open Pages
+        int best_y = -1;
+        unsigned int best_page = 0, best_index = 0;
+        for (unsigned int p = 0; p < pages_used && best_y < 0; p++) {
+            for (unsigned int i = 0; i < pages[p].count; i++) {
+                int y = atlas_fit(&pages[p], i, w, h);
+                if (y >= 0 && (best_y < 0 || y < best_y)) {
+                    best_y = y;
+                    best_page = p;
+                    best_index = i;
+                }
+            }
+        }
+
+        // Open Page
+        if (best_y < 0) {
+            atlas_page_t* grown = realloc(pages, (pages_used + 1) * sizeof(atlas_page_t));
+            if (!grown) {
+                free(pages);
+                return ATLAS_MEMORY_ERROR;
+            }
+            pages = grown;
+            atlas_page_t* page = &pages[pages_used];
+            memset(page, 0, sizeof(atlas_page_t));
+            page->segments[0] = (atlas_segment_t) { .x = 0, .width = ATLAS_PAGE_SIZE + ATLAS_PADDING, .y = 0 };
+            page->count = 1;
+            best_page = pages_used++;
+            best_index = 0;
+            best_y = 0;
+        }
+
+        atlas_page_t* page = &pages[best_page];
+        sprite->page = best_page;
+        sprite->x = page->segments[best_index].x;
+        sprite->y = (unsigned int)best_y;
+        atlas_place(page, best_index, sprite->y, w, h);
+        if (sprite->x + sprite->width > page->width) page->width = sprite->x + sprite->width;
+        if (sprite->y + sprite->height > page->height) page->height = sprite->y + sprite->height;
+    }
+
+    *page_list = pages;
+    *page_count = pages_used;
+    return ATLAS_OK;
+}
\ No newline at end of file
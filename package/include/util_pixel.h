@@ -0,0 +1,130 @@
+#include <codec_qoi.h>
+#include <codec_bc.h>
+#include <util_yuri.h>
+#include <stdlib.h>
+#include <string.h>
+#pragma once
+
+// Images are stored in the layout the engine presents them in, so it can copy pixels
+// without touching each one at load time. Decoded images arrive as 0xRRGGBBAA with
+// straight alpha, channels are reordered and premultiplied right before encoding.
+// Block compressed images are always premultiplied, their channel order is fixed.
+
+typedef enum {
+    PIXEL_FORMAT_BGRA = 0x01,           // Channels stored as Blue, Green, Red, Alpha
+    PIXEL_FORMAT_PREMULTIPLIED = 0x02,  // Color Channels multiplied by Alpha
+    PIXEL_FORMAT_LINEAR = 0x04,         // Channels hold Linear Values (Normal Maps, Masks)
+    PIXEL_FORMAT_BC1 = 0x10,            // Block Compressed (BC1) instead of QOI
+    PIXEL_FORMAT_BC3 = 0x20,            // Block Compressed (BC3) instead of QOI
+    PIXEL_FORMAT_BC7 = 0x40,            // Block Compressed (BC7) instead of QOI
+    PIXEL_QUALITY_FAST = 0x100,         // Block Encoder favours Speed
+    PIXEL_QUALITY_HIGH = 0x200,         // Block Encoder favours Quality
+} pixel_format_t;
+
+#define PIXEL_FORMAT_DEFAULT (PIXEL_FORMAT_BGRA | PIXEL_FORMAT_PREMULTIPLIED)
+#define PIXEL_FORMAT_BLOCKS  (PIXEL_FORMAT_BC1 | PIXEL_FORMAT_BC3 | PIXEL_FORMAT_BC7)
+#define PIXEL_QUALITY        (PIXEL_QUALITY_FAST | PIXEL_QUALITY_HIGH)
+#define PIXEL_QOI_COLORSPACE 13         // Offset of the Colorspace within a QOI Header
+
+// Apply a packager option ("--format=bgra8"), returns 0 if it isn't one
+static inline int pixel_option(const char* option, unsigned int* format) {
+    if (!strcmp(option, "--format=bgra8"))              *format |= PIXEL_FORMAT_BGRA;
+    else if (!strcmp(option, "--format=rgba8"))         *format &= ~PIXEL_FORMAT_BGRA;
+    else if (!strcmp(option, "--alpha=premultiplied"))  *format |= PIXEL_FORMAT_PREMULTIPLIED;
+    else if (!strcmp(option, "--alpha=straight"))       *format &= ~PIXEL_FORMAT_PREMULTIPLIED;
+    else if (!strcmp(option, "--colorspace=linear"))    *format |= PIXEL_FORMAT_LINEAR;
+    else if (!strcmp(option, "--colorspace=srgb"))      *format &= ~PIXEL_FORMAT_LINEAR;
+    else if (!strcmp(option, "--compress=none"))        *format &= ~PIXEL_FORMAT_BLOCKS;
+    else if (!strcmp(option, "--compress=bc1"))         *format = (*format & ~PIXEL_FORMAT_BLOCKS) | PIXEL_FORMAT_BC1;
+    else if (!strcmp(option, "--compress=bc3"))         *format = (*format & ~PIXEL_FORMAT_BLOCKS) | PIXEL_FORMAT_BC3;
+    else if (!strcmp(option, "--compress=bc7"))         *format = (*format & ~PIXEL_FORMAT_BLOCKS) | PIXEL_FORMAT_BC7;
+    else if (!strcmp(option, "--quality=fast"))         *format = (*format & ~PIXEL_QUALITY) | PIXEL_QUALITY_FAST;
+    else if (!strcmp(option, "--quality=normal"))       *format &= ~PIXEL_QUALITY;
+    else if (!strcmp(option, "--quality=high"))         *format = (*format & ~PIXEL_QUALITY) | PIXEL_QUALITY_HIGH;
+    else return 0;
+    return 1;
+}
+
+// Entry flags announcing the layout of an encoded image
+static inline unsigned char pixel_flags(unsigned int format) {
+    unsigned char flag = 0;
+    if (format & PIXEL_FORMAT_BLOCKS) {
+        return YURI_FLAG_PREMULTIPLIED;
+    }
+    if (format & PIXEL_FORMAT_BGRA)          flag |= YURI_FLAG_BGRA;
+    if (format & PIXEL_FORMAT_PREMULTIPLIED) flag |= YURI_FLAG_PREMULTIPLIED;
+    return flag;
+}
+
+// Reorder and premultiply a single pixel (0xRRGGBBAA)
+static inline unsigned int pixel_convert(unsigned int rgba, unsigned int format) {
+    unsigned int r = (rgba >> 24) & 0xFF;
+    unsigned int g = (rgba >> 16) & 0xFF;
+    unsigned int b = (rgba >> 8) & 0xFF;
+    unsigned int a = rgba & 0xFF;
+    if (format & PIXEL_FORMAT_PREMULTIPLIED) {
+        r = (r * a + 127) / 255;
+        g = (g * a + 127) / 255;
+        b = (b * a + 127) / 255;
+    }
+    if (format & PIXEL_FORMAT_BGRA) {
+        unsigned int t = r;
+        r = b;
+        b = t;
+    }
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+// Encode an image (0xRRGGBBAA, Straight Alpha) in the given layout, as QOI or as blocks.
+// The quality of blocks is measured against the pixels they were encoded from.
+static inline qoi_error_t pixel_encode(
+    const unsigned int* input_rgba,     // Pixel Data
+    const unsigned int input_width,     // Array Width
+    const unsigned int input_height,    // Array Height
+    const unsigned int input_format,    // Layout to Store (pixel_format_t)
+    unsigned char** complete_buffer,    // Output Pointer
+    unsigned int* complete_length,      // Output Size
+    double* complete_psnr               // Output Block PSNR (Decibels, Optional)
+) {
+    if (!input_rgba || !complete_buffer || !complete_length) {
+        return QOI_INVALID_ARGUMENTS;
+    }
+    unsigned int blocks = input_format & PIXEL_FORMAT_BLOCKS;
+    unsigned int layout = blocks ? PIXEL_FORMAT_PREMULTIPLIED : input_format;
+    size_t count = (size_t)input_width * input_height;
+    unsigned int* converted = malloc((count ? count : 1) * sizeof(unsigned int));
+    if (!converted) {
+        return QOI_MEMORY_ERROR;
+    }
+    for (size_t i = 0; i < count; i++) {
+        converted[i] = pixel_convert(input_rgba[i], layout);
+    }
+    if (!blocks) {
+        qoi_error_t result = qoi_encode(converted, input_width, input_height, complete_buffer, complete_length);
+        free(converted);
+        if (result == QOI_OK) {
+            (*complete_buffer)[PIXEL_QOI_COLORSPACE] = (input_format & PIXEL_FORMAT_LINEAR) ? 0x01 : 0x00;
+        }
+        return result;
+    }
+
+    // Block Compression
+    unsigned int block_format = blocks == PIXEL_FORMAT_BC1 ? BC_FORMAT_BC1 : (blocks == PIXEL_FORMAT_BC3 ? BC_FORMAT_BC3 : BC_FORMAT_BC7);
+    bc_quality_t quality = (input_format & PIXEL_QUALITY_FAST) ? BC_QUALITY_FAST : ((input_format & PIXEL_QUALITY_HIGH) ? BC_QUALITY_HIGH : BC_QUALITY_NORMAL);
+    bc_error_t result = bc_encode(converted, input_width, input_height, block_format, quality,
+        (input_format & PIXEL_FORMAT_LINEAR) != 0, complete_buffer, complete_length);
+    if (result == BC_OK && complete_psnr) {
+        unsigned int* decoded = NULL;
+        unsigned int width = 0, height = 0;
+        result = bc_decode(*complete_buffer, *complete_length, &decoded, &width, &height);
+        if (result == BC_OK) {
+            *complete_psnr = bc_psnr(converted, decoded, width, height);
+        }
+        else {
+            free(*complete_buffer);
+        }
+        free(decoded);
+    }
+    free(converted);
+    return result == BC_OK ? QOI_OK : (result == BC_MEMORY_ERROR ? QOI_MEMORY_ERROR : QOI_INVALID_ARGUMENTS);
+}
\ No newline at end of file
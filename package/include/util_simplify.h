@@ -0,0 +1,281 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#pragma once
+
+// Reduces a triangle list with quadric error metrics (Garland & Heckbert). Edges are
+// collapsed onto one of their vertices rather than a new position, so a simplified
+// list only uses vertices of the list it was made from. Every vertex accumulates the
+// planes of the triangles around it, a collapse costs the mean squared distance of the
+// kept vertex to the planes of both. Vertices on open borders and on attribute seams
+// (several vertices sharing a position) never move, so outlines and texture borders
+// stay where they are.
+
+#define SIMPLIFY_FLIP_LIMIT  0.0f    // Triangle Normals may not turn by more than 90 Degrees
+
+typedef struct {
+    double q[10];                   // Symmetric 4x4 Matrix (Upper Triangle)
+    double weight;                  // Summed Triangle Area
+} simplify_quadric_t;
+
+typedef struct {
+    unsigned int from;              // Vertex removed
+    unsigned int to;                // Vertex kept
+    double cost;                    // Mean squared Distance
+} simplify_collapse_t;
+
+static inline void simplify_plane(simplify_quadric_t* q, const float* a, const float* b, const float* c) {
+    double e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    double e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+    double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length <= 0.0) {
+        return;
+    }
+    double area = length * 0.5;
+    n[0] /= length; n[1] /= length; n[2] /= length;
+    double d = -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]);
+    double p[4] = { n[0], n[1], n[2], d };
+    for (int i = 0, k = 0; i < 4; i++) {
+        for (int j = i; j < 4; j++) {
+            q->q[k++] += area * p[i] * p[j];
+        }
+    }
+    q->weight += area;
+}
+
+static inline double simplify_error(const simplify_quadric_t* a, const simplify_quadric_t* b, const float* v) {
+    double p[4] = { v[0], v[1], v[2], 1.0 };
+    double e = 0.0;
+    for (int i = 0, k = 0; i < 4; i++) {
+        for (int j = i; j < 4; j++, k++) {
+            double m = (a->q[k] + b->q[k]) * p[i] * p[j];
+            e += i == j ? m : 2.0 * m;
+        }
+    }
+    double weight = a->weight + b->weight;
+    return weight > 0.0 ? fabs(e) / weight : 0.0;
+}
+
+static inline int simplify_compare(const void* a, const void* b) {
+    double x = ((const simplify_collapse_t*)a)->cost;
+    double y = ((const simplify_collapse_t*)b)->cost;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static inline unsigned int simplify_hash(const float* p) {
+    unsigned int bits[3];
+    memcpy(bits, p, sizeof(bits));
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+// Would moving 'from' onto 'to' turn any remaining triangle around 'from' over?
+static inline int simplify_flips(const float* positions, const unsigned int* indices, const unsigned int* corners, unsigned int corner_count, const unsigned int* weld, unsigned int from, unsigned int to) {
+    const float* target = positions + (size_t)to * 3;
+    for (unsigned int c = 0; c < corner_count; c++) {
+        const unsigned int* t = indices + corners[c] / 3 * 3;
+        unsigned int k = corners[c] % 3;
+        unsigned int b = t[(k + 1) % 3], d = t[(k + 2) % 3];
+        if (weld[b] == weld[to] || weld[d] == weld[to]) {
+            continue; // Removed by the Collapse
+        }
+        const float* p0 = positions + (size_t)from * 3;
+        const float* p1 = positions + (size_t)b * 3;
+        const float* p2 = positions + (size_t)d * 3;
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        float f1[3] = { p1[0] - target[0], p1[1] - target[1], p1[2] - target[2] };
+        float f2[3] = { p2[0] - target[0], p2[1] - target[1], p2[2] - target[2] };
+        float n0[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        float n1[3] = { f1[1] * f2[2] - f1[2] * f2[1], f1[2] * f2[0] - f1[0] * f2[2], f1[0] * f2[1] - f1[1] * f2[0] };
+        if (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2] <= SIMPLIFY_FLIP_LIMIT) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Simplify a triangle list down to 'target_count' indices or until the next collapse
+// would move the surface by more than 'error_limit'. Returns the index count written
+// to 'destination' (room for 'index_count' indices), the distance reached goes to 'error'.
+static inline unsigned int simplify(
+    const float* positions,         // Vertex Positions (XYZ)
+    unsigned int vertex_count,      // Vertex Count
+    const unsigned int* indices,    // Triangle Indices
+    unsigned int index_count,       // Index Count
+    unsigned int target_count,      // Index Count to reach
+    float error_limit,              // Largest Distance a Collapse may cause
+    unsigned int* destination,      // Output Indices
+    float* error                    // Output Distance reached
+) {
+    memcpy(destination, indices, index_count * sizeof(unsigned int));
+    *error = 0.0f;
+    if (index_count <= target_count || vertex_count == 0) {
+        return index_count;
+    }
+
+    // Weld Vertices sharing a Position, more than one per Position marks a Seam
+    size_t slots = 1;
+    while (slots < (size_t)vertex_count * 2) slots <<= 1;
+    unsigned int* table = malloc(slots * sizeof(unsigned int));
+    unsigned int* weld = malloc(vertex_count * sizeof(unsigned int));
+    unsigned char* locked = calloc(vertex_count, sizeof(unsigned char));
+    simplify_quadric_t* quadrics = calloc(vertex_count, sizeof(simplify_quadric_t));
+    unsigned int* remap = malloc(vertex_count * sizeof(unsigned int));
+    unsigned int* offsets = malloc((vertex_count + 1) * sizeof(unsigned int));
+    unsigned int* corners = malloc(index_count * sizeof(unsigned int));
+    simplify_collapse_t* collapses = malloc(vertex_count * sizeof(simplify_collapse_t));
+    unsigned char* touched = malloc(vertex_count * sizeof(unsigned char));
+    size_t edge_slots = 1;
+    while (edge_slots < (size_t)index_count * 2) edge_slots <<= 1;
+    unsigned int* edges = malloc(edge_slots * 2 * sizeof(unsigned int));
+    if (!table || !weld || !locked || !quadrics || !remap || !offsets || !corners || !collapses || !touched || !edges) {
+        free(table); free(weld); free(locked); free(quadrics); free(remap);
+        free(offsets); free(corners); free(collapses); free(touched); free(edges);
+        return index_count;
+    }
+    memset(table, 0xFF, slots * sizeof(unsigned int));
+    for (unsigned int v = 0; v < vertex_count; v++) {
+        const float* p = positions + (size_t)v * 3;
+        size_t slot = simplify_hash(p) & (slots - 1);
+        while (table[slot] != 0xFFFFFFFF && memcmp(positions + (size_t)table[slot] * 3, p, 3 * sizeof(float)) != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        if (table[slot] == 0xFFFFFFFF) {
+            table[slot] = v;
+        }
+        else {
+            locked[v] = 1;
+            locked[table[slot]] = 1;
+        }
+        weld[v] = table[slot];
+    }
+
+    // Open Borders, Edges (between welded Vertices) without an opposite Edge
+    memset(edges, 0xFF, edge_slots * 2 * sizeof(unsigned int));
+    for (unsigned int i = 0; i < index_count; i++) {
+        unsigned int a = weld[indices[i]], b = weld[indices[i - i % 3 + (i + 1) % 3]];
+        size_t slot = ((a * 73856093u) ^ (b * 19349663u)) & (edge_slots - 1);
+        while (edges[slot * 2] != 0xFFFFFFFF && (edges[slot * 2] != a || edges[slot * 2 + 1] != b)) {
+            slot = (slot + 1) & (edge_slots - 1);
+        }
+        edges[slot * 2] = a;
+        edges[slot * 2 + 1] = b;
+    }
+    for (unsigned int i = 0; i < index_count; i++) {
+        unsigned int a = weld[indices[i]], b = weld[indices[i - i % 3 + (i + 1) % 3]];
+        size_t slot = ((b * 73856093u) ^ (a * 19349663u)) & (edge_slots - 1);
+        while (edges[slot * 2] != 0xFFFFFFFF && (edges[slot * 2] != b || edges[slot * 2 + 1] != a)) {
+            slot = (slot + 1) & (edge_slots - 1);
+        }
+        if (edges[slot * 2] == 0xFFFFFFFF) {
+            locked[a] = 1;
+            locked[b] = 1;
+        }
+    }
+    free(edges);
+    free(table);
+    for (unsigned int v = 0; v < vertex_count; v++) {
+        locked[v] |= locked[weld[v]];
+    }
+
+    // Quadrics live on the welded Vertex
+    for (unsigned int i = 0; i < index_count; i += 3) {
+        const float* a = positions + (size_t)indices[i] * 3;
+        const float* b = positions + (size_t)indices[i + 1] * 3;
+        const float* c = positions + (size_t)indices[i + 2] * 3;
+        simplify_quadric_t plane = { 0 };
+        simplify_plane(&plane, a, b, c);
+        for (unsigned int k = 0; k < 3; k++) {
+            simplify_quadric_t* q = &quadrics[weld[indices[i + k]]];
+            for (int j = 0; j < 10; j++) q->q[j] += plane.q[j];
+            q->weight += plane.weight;
+        }
+    }
+
+    // Collapse the cheapest Edges in Passes, each Vertex takes part in one Collapse per Pass
+    double limit = (double)error_limit * error_limit;
+    double reached = 0.0;
+    unsigned int count = index_count;
+    while (count > target_count) {
+        // Corners around each Vertex
+        memset(offsets, 0, (vertex_count + 1) * sizeof(unsigned int));
+        for (unsigned int i = 0; i < count; i++) offsets[destination[i] + 1]++;
+        for (unsigned int v = 0; v < vertex_count; v++) offsets[v + 1] += offsets[v];
+        for (unsigned int i = 0; i < count; i++) corners[offsets[destination[i]]++] = i;
+        for (unsigned int v = vertex_count; v > 0; v--) offsets[v] = offsets[v - 1];
+        offsets[0] = 0;
+
+        // Rank the cheapest Collapse of every Vertex, Vertices that can move are surrounded
+        // by Triangles so following each Triangle's Edges reaches all their Neighbours.
+        for (unsigned int v = 0; v < vertex_count; v++) {
+            collapses[v].cost = INFINITY;
+        }
+        for (unsigned int i = 0; i < count; i++) {
+            unsigned int from = destination[i], to = destination[i - i % 3 + (i + 1) % 3];
+            if (!locked[from] && weld[from] != weld[to]) {
+                double cost = simplify_error(&quadrics[weld[from]], &quadrics[weld[to]], positions + (size_t)to * 3);
+                if (cost <= limit && cost < collapses[from].cost) {
+                    collapses[from] = (simplify_collapse_t) { .from = from, .to = to, .cost = cost };
+                }
+            }
+        }
+        unsigned int collapse_count = 0;
+        for (unsigned int v = 0; v < vertex_count; v++) {
+            if (collapses[v].cost != INFINITY) {
+                collapses[collapse_count++] = collapses[v];
+            }
+        }
+        if (collapse_count == 0) {
+            break;
+        }
+        qsort(collapses, collapse_count, sizeof(simplify_collapse_t), simplify_compare);
+
+        // Perform the cheapest ones which don't overlap, enough to reach the Target
+        for (unsigned int v = 0; v < vertex_count; v++) remap[v] = v;
+        memset(touched, 0, vertex_count);
+        unsigned int removed = 0, performed = 0;
+        for (unsigned int c = 0; c < collapse_count && count - removed > target_count; c++) {
+            simplify_collapse_t* e = &collapses[c];
+            if (touched[e->from] || touched[e->to] || remap[e->from] != e->from) {
+                continue;
+            }
+            unsigned int around = offsets[e->from + 1] - offsets[e->from];
+            if (simplify_flips(positions, destination, corners + offsets[e->from], around, weld, e->from, e->to)) {
+                continue;
+            }
+            // Neighbours keep their Triangles unchanged until the next Pass
+            for (unsigned int k = offsets[e->from]; k < offsets[e->from + 1]; k++) {
+                const unsigned int* t = destination + corners[k] / 3 * 3;
+                for (unsigned int j = 0; j < 3; j++) touched[t[j]] = 1;
+            }
+            remap[e->from] = e->to;
+            simplify_quadric_t* q = &quadrics[weld[e->to]];
+            for (int j = 0; j < 10; j++) q->q[j] += quadrics[weld[e->from]].q[j];
+            q->weight += quadrics[weld[e->from]].weight;
+            if (e->cost > reached) reached = e->cost;
+            removed += 6; // Two Triangles on a closed Surface
+            performed++;
+        }
+        if (performed == 0) {
+            break;
+        }
+
+        // Drop Triangles that collapsed
+        unsigned int written = 0;
+        for (unsigned int i = 0; i < count; i += 3) {
+            unsigned int a = remap[destination[i]], b = remap[destination[i + 1]], c = remap[destination[i + 2]];
+            if (weld[a] == weld[b] || weld[b] == weld[c] || weld[a] == weld[c]) {
+                continue;
+            }
+            destination[written++] = a;
+            destination[written++] = b;
+            destination[written++] = c;
+        }
+        count = written;
+    }
+    free(weld); free(locked); free(quadrics); free(remap);
+    free(offsets); free(corners); free(collapses); free(touched);
+    *error = (float)sqrt(reached);
+    return count;
+}
\ No newline at end of file
@@ -4,10 +4,10 @@
 #define YURI_LIST_LIMIT 256
 
 #define YURI_FLAG_COMPRESSED    0x80
-#define YURI_FLAG_UNASSIGNED_2  0x40
-#define YURI_FLAG_UNASSIGNED_3  0x20
-#define YURI_FLAG_UNASSIGNED_4  0x10
-#define YURI_FLAG_UNASSIGNED_5  0x08
+#define YURI_FLAG_MIPMAPPED     0x40
+#define YURI_FLAG_BGRA          0x20
+#define YURI_FLAG_PREMULTIPLIED 0x10
+#define YURI_FLAG_BYTECODE      0x08
 #define YURI_FLAG_UNASSIGNED_6  0x04
 #define YURI_FLAG_UNASSIGNED_7  0x02
 #define YURI_FLAG_UNASSIGNED_8  0x01
@@ -21,6 +21,7 @@ typedef enum {
     YURI_TYPE_MODEL = 6u,
     YURI_TYPE_SCENE = 7u,
     YURI_TYPE_SCRIPT = 8u,
+    YURI_TYPE_SPRITE = 9u,
     YURI_TYPE_IMAGE_ENCODED = 200u,
     YURI_TYPE_AUDIO_ENCODED = 201u,
 } yuri_type_t;
@@ -47,6 +48,7 @@ static inline const char* str_type(unsigned char type) {
     case YURI_TYPE_MODEL:           return "MODEL";
     case YURI_TYPE_SCENE:           return "SCENE";
     case YURI_TYPE_SCRIPT:          return "SCRIPT";
+    case YURI_TYPE_SPRITE:          return "SPRITE";
     default: return "N/A";
     }
 }
\ No newline at end of file
@@ -25,7 +25,16 @@ int main(int argc, char** argv) {
 
     // Convert a directory into a YURI Archive
     if (argc >= 4 && !strcmp(argv[1], "package")) {
-        return command_package(argv[2], argv[3]);
+        unsigned int format = PIXEL_FORMAT_DEFAULT;
+        unsigned int lods = MESH_LOD_DEFAULT;
+        unsigned int scripts = SCRIPT_MODE_BYTECODE;
+        for (int i = 4; i < argc; i++) {
+            if (!pixel_option(argv[i], &format) && !mesh_option(argv[i], &lods) && !script_option(argv[i], &scripts)) {
+                printf("Unknown Option: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        return command_package(argv[2], argv[3], format, lods, scripts);
     }
 
     // Convert a YURI Archive into a directory